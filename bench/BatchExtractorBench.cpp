@@ -0,0 +1,64 @@
+// HtmlExtractor throughput on a batch of synthetic article pages: one extractor on the
+// calling thread against BatchExtractor on the shared pool, with ordered and unordered
+// delivery. Prints BatchExtractor::formatStats for each run.
+//   NovaBrowseExtractBench [pages]   (default 2000 pages, about 20 KB each)
+#include "core/extract/BatchExtractor.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static std::string page(std::size_t n) {
+  std::string s = "<html><head><title>Article " + std::to_string(n) + "</title>"
+                  "<meta name=description content=\"Synthetic page for the batch bench\"></head><body>"
+                  "<nav><a href=/>Home</a> <a href=/news>News</a> <a href=/about>About</a></nav><article>"
+                  "<h1>Article " + std::to_string(n) + "</h1>";
+  for (int section = 0; section < 6; ++section) {
+    s += "<h2>Section " + std::to_string(section) + "</h2>";
+    for (int p = 0; p < 5; ++p) {
+      s += "<p>Officials from Example GmbH met with representatives of the Berlin City Council on Tuesday. "
+           "According to the <a href=/people/analyst>chief analyst</a>, the agreement covers three districts "
+           "and a follow-up meeting is planned in Paris next spring.</p>";
+    }
+  }
+  s += "<table><tr><th>City</th><th>Population</th></tr><tr><td>Berlin</td><td>3,645,000</td></tr>"
+       "<tr><td>Hamburg</td><td>1,841,000</td></tr></table></article><footer>Footer text</footer></body></html>";
+  return s;
+}
+
+int main(int argc, char** argv) {
+  const int n = argc > 1 ? std::atoi(argv[1]) : 2000;
+  std::vector<core::extract::BatchDocument> docs;
+  for (int i = 0; i < (n > 0 ? n : 1); ++i) docs.push_back({page(std::size_t(i)), "https://example.com/a/" + std::to_string(i)});
+
+  std::size_t sink = 0;
+  core::extract::BatchStats serial;
+  serial.pages = docs.size();
+  serial.workers = 1;
+  for (const auto& d : docs) serial.bytes += d.html.size();
+  core::extract::HtmlExtractor one;
+  const auto t0 = Clock::now();
+  for (const auto& d : docs) sink += one.extract(d.html, d.baseUrl).blocks.size();
+  serial.wallMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+  const double secs = serial.wallMs / 1000.0;
+  serial.pagesPerSec = serial.pages / secs;
+  serial.pagesPerSecPerCore = serial.pagesPerSec;
+  serial.mbPerSec = serial.bytes / (1024.0 * 1024.0) / secs;
+  std::printf("serial:    %s\n", core::extract::BatchExtractor::formatStats(serial).c_str());
+
+  core::extract::BatchExtractor batch;
+  // First batch warms every worker's extractor and parse arena.
+  batch.extractBatch(docs, core::extract::BatchDelivery::Unordered, [&](std::size_t, core::extract::ExtractedPage&&) {});
+  const auto ordered = batch.extractBatch(docs, core::extract::BatchDelivery::Ordered,
+                                          [&](std::size_t, core::extract::ExtractedPage&& ep) { sink += ep.blocks.size(); });
+  std::printf("ordered:   %s\n", core::extract::BatchExtractor::formatStats(ordered).c_str());
+  const auto unordered = batch.extractBatch(docs, core::extract::BatchDelivery::Unordered,
+                                            [&](std::size_t, core::extract::ExtractedPage&& ep) { sink += ep.blocks.size(); });
+  std::printf("unordered: %s\n", core::extract::BatchExtractor::formatStats(unordered).c_str());
+  std::printf("speedup %.2fx ordered, %.2fx unordered (%zu)\n", serial.wallMs / ordered.wallMs,
+              serial.wallMs / unordered.wallMs, sink);
+  return 0;
+}
@@ -0,0 +1,117 @@
+// Capitalized-run scanning: the former per-call std::regex search against
+// EntityDetector::candidates on a synthetic news-like corpus, then single-threaded
+// against pooled detection for one long text and for a batch of pages. Finally the
+// scanner's throughput on English text against German/Polish/French/Greek/Russian
+// text, where every non-ASCII character goes through UTF-8 decoding.
+//   NovaBrowseBench [copies]   (default 200 copies, about 170 KB)
+#include "core/entities/EntityDetector.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <regex>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static std::string corpus(int copies) {
+  static const char* paragraph =
+    "Officials from Example GmbH met with representatives of the Berlin City Council on Tuesday. "
+    "According to Jean-Pierre O'Neil, chief analyst at Northwind Bank Group, the agreement covers "
+    "three districts. \"We expect New York and London to follow,\" said Maria Gonzalez Ruiz. "
+    "The University of Hamburg published its own estimate, which differs by about 12 percent; "
+    "critics in Munich called it optimistic. However, most observers agree the talks went well, "
+    "and a follow-up meeting is planned in Paris next spring. ";
+  std::string s;
+  s.reserve(std::size_t(copies) * 700);
+  for (int i = 0; i < copies; ++i) {
+    s += paragraph;
+    s += "Item ";
+    s += std::to_string(i);
+    s += " was filed by Acme Corp Ltd.\n";
+  }
+  return s;
+}
+
+// Same shape as corpus(), in several languages.
+static std::string mixedCorpus(int copies) {
+  static const char* paragraphs[] = {
+    "Die Stadtwerke München GmbH und Jürgen Müller vom Landratsamt Düsseldorf einigten sich am Dienstag. "
+    "Laut Änne Schäfer, Analystin der Nordwind Bank, umfasst die Vereinbarung drei Bezirke. ",
+    "Przedstawiciele miasta Łódź spotkali się z Małgorzatą Żurawską w Krakowie. Według Łukasza Wójcika "
+    "porozumienie obejmuje trzy dzielnice, a kolejne spotkanie odbędzie się w Gdańsku. ",
+    "Selon Émile Zoë Lefèvre, analyste chez Société Générale, l'accord couvre trois arrondissements; "
+    "la prochaine réunion aura lieu à Besançon au printemps. ",
+    "Ο Γιώργος Παπαδόπουλος συναντήθηκε με εκπροσώπους του Δήμου Αθηναίων την Τρίτη. ",
+    "Представители компании Газпром и Сергей Иванов встретились в Санкт-Петербурге во вторник. ",
+  };
+  std::string s;
+  for (int i = 0; i < copies; ++i) {
+    for (const char* p : paragraphs) s += p;
+    s += "Item " + std::to_string(i) + "\n";
+  }
+  return s;
+}
+
+static std::vector<std::string> regexCandidates(const std::string& text) {
+  // Built per call, as detect() used to.
+  std::regex re(R"(\b([A-Z][a-zA-Z\-']+)(\s+[A-Z][a-zA-Z\-']+){0,3}\b)");
+  std::vector<std::string> out;
+  for (std::sregex_iterator it(text.begin(), text.end(), re), end; it != end; ++it) out.push_back(it->str());
+  return out;
+}
+
+template <class F>
+static double timeMs(F&& f, int reps) {
+  const auto t0 = Clock::now();
+  for (int i = 0; i < reps; ++i) f();
+  return std::chrono::duration<double, std::milli>(Clock::now() - t0).count() / reps;
+}
+
+int main(int argc, char** argv) {
+  const int copies = argc > 1 ? std::atoi(argv[1]) : 200;
+  const std::string text = corpus(copies > 0 ? copies : 1);
+
+  std::vector<std::string> expected = regexCandidates(text);
+  std::vector<std::string> got;
+  for (auto v : core::entities::EntityDetector::candidates(text)) got.emplace_back(v);
+  if (got != expected) {
+    std::fprintf(stderr, "mismatch: regex found %zu candidates, scanner %zu\n", expected.size(), got.size());
+    return 1;
+  }
+
+  std::size_t sink = 0;
+  const double regexMs = timeMs([&] { sink += regexCandidates(text).size(); }, 3);
+  const double scanMs = timeMs([&] { sink += core::entities::EntityDetector::candidates(text).size(); }, 20);
+  core::entities::EntityDetector detector;
+  const double detectMs = timeMs([&] { sink += detector.detect(text).size(); }, 20);
+  const double parallelMs = timeMs([&] { sink += detector.detectParallel(text).size(); }, 20);
+
+  // A batch of small pages, as when importing history.
+  std::vector<core::extract::ExtractedPage> pages(2000);
+  std::vector<const core::extract::ExtractedPage*> pagePtrs;
+  for (std::size_t i = 0; i < pages.size(); ++i) {
+    for (int b = 0; b < 8; ++b) pages[i].blocks.push_back({"", corpus(1), 0, -1, 0, 0});
+    pagePtrs.push_back(&pages[i]);
+  }
+  const double serialPagesMs = timeMs([&] {
+    core::exec::WorkStealingPool one(1);
+    for (const auto* p : pagePtrs) sink += detector.detectPage(*p, one).size();
+  }, 1);
+  const double batchMs = timeMs([&] { sink += detector.detectPages(pagePtrs).size(); }, 1);
+
+  std::printf("corpus        %zu bytes, %zu candidates\n", text.size(), expected.size());
+  std::printf("std::regex    %9.3f ms\n", regexMs);
+  std::printf("scanner       %9.3f ms  (%.1fx)\n", scanMs, regexMs / scanMs);
+  std::printf("detect()      %9.3f ms\n", detectMs);
+  std::printf("parallel      %9.3f ms  (%zu workers)\n", parallelMs, core::exec::WorkStealingPool::shared().size());
+  std::printf("%zu pages     %9.3f ms serial, %.3f ms detectPages()\n", pages.size(), serialPagesMs, batchMs);
+
+  const std::string mixed = mixedCorpus(copies > 0 ? copies : 1);
+  const double mixedMs = timeMs([&] { sink += core::entities::EntityDetector::candidates(mixed).size(); }, 20);
+  auto mbPerSec = [](std::size_t bytes, double ms) { return bytes / (ms * 1000.0); };
+  std::printf("scanner ASCII %9.1f MB/s\n", mbPerSec(text.size(), scanMs));
+  std::printf("scanner mixed %9.1f MB/s  (%zu bytes, %zu candidates)\n", mbPerSec(mixed.size(), mixedMs), mixed.size(),
+              core::entities::EntityDetector::candidates(mixed).size());
+  return sink == 0;
+}
@@ -0,0 +1,61 @@
+// EntityGraph on a synthetic graph with skewed degrees: CSR build time, then the
+// queries nova://deepsearch runs per profile (2-hop neighbourhood, personalized
+// PageRank, shortest path) from random sources.
+//   NovaBrowseGraphBench [nodes] [edges]   (default 1M nodes, 4M edges)
+#include "core/entities/EntityGraph.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point t0) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+int main(int argc, char** argv) {
+  const std::size_t nodes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  const std::size_t edgeCount = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4000000;
+
+  core::entities::EntityGraph g;
+  const auto rel = g.internRelation("related");
+  for (std::size_t i = 0; i < nodes; ++i) g.intern("e" + std::to_string(i));
+
+  // Squaring a uniform draw skews endpoints towards low ids, giving a few large hubs.
+  std::mt19937_64 rng(7);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  auto pick = [&] { const double x = u(rng); return std::uint32_t(x * x * double(nodes - 1)); };
+  std::vector<core::entities::EntityGraph::Edge> edges;
+  edges.reserve(edgeCount);
+  for (std::size_t i = 0; i < edgeCount; ++i) edges.push_back({pick(), std::uint32_t(rng() % nodes), 1.0f, rel});
+
+  auto t0 = Clock::now();
+  g.build(edges);
+  const double buildMs = msSince(t0);
+
+  const int queries = 50;
+  double hopMs = 0, pprMs = 0, pathMs = 0;
+  std::size_t sink = 0;
+  for (int q = 0; q < queries; ++q) {
+    const auto src = std::uint32_t(rng() % nodes), dst = std::uint32_t(rng() % nodes);
+    t0 = Clock::now();
+    sink += g.kHop(src, 2, 5000).size();
+    hopMs += msSince(t0);
+    t0 = Clock::now();
+    sink += g.personalizedPageRank({src}, 15, 0.15, 1e-4).size();
+    pprMs += msSince(t0);
+    t0 = Clock::now();
+    sink += g.shortestPath(src, dst).size();
+    pathMs += msSince(t0);
+  }
+
+  std::printf("graph          %zu nodes, %zu edge directions\n", g.nodeCount(), g.edgeCount());
+  std::printf("build          %9.1f ms\n", buildMs);
+  std::printf("2-hop (5000)   %9.3f ms/query\n", hopMs / queries);
+  std::printf("ppr top-15     %9.3f ms/query\n", pprMs / queries);
+  std::printf("shortest path  %9.3f ms/query\n", pathMs / queries);
+  return sink == 0;
+}
@@ -0,0 +1,119 @@
+// SqliteDb throughput on a history-like table in a temp file:
+//  - insert and point-select through execParams/query, statement cache off and on;
+//  - bulk inserts committed per row, in one Transaction, and through BatchWriter.
+//   NovaBrowseSqliteBench [rows] [bulkRows]   (default 100k, 1M)
+#include "core/storage/BatchWriter.h"
+#include "core/storage/SqliteDb.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <string>
+
+using Clock = std::chrono::steady_clock;
+
+static double secondsSince(Clock::time_point t0) {
+  return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+static const std::filesystem::path kPath = std::filesystem::temp_directory_path() / "novabrowse-sqlite-bench.db";
+static const std::string kInsert = "INSERT INTO history(url,title,ts) VALUES(?,?,?);";
+
+static void removeDb() {
+  std::filesystem::remove(kPath);
+  std::filesystem::remove(kPath.string() + "-wal");
+  std::filesystem::remove(kPath.string() + "-shm");
+}
+
+static void openDb(core::storage::SqliteDb& db) {
+  removeDb();
+  if (!db.open(kPath.string()) ||
+      !db.exec("CREATE TABLE history(id INTEGER PRIMARY KEY, url TEXT UNIQUE, title TEXT, ts INTEGER);")) {
+    std::fprintf(stderr, "setup failed\n");
+    std::exit(1);
+  }
+}
+
+static void insertRow(core::storage::SqliteDb& db, std::size_t i) {
+  db.execParams(kInsert, {"https://example.org/page/" + std::to_string(i), "Page " + std::to_string(i), i});
+}
+
+static void run(const char* label, std::size_t cacheSize, std::size_t rows) {
+  core::storage::SqliteDb db(cacheSize);
+  openDb(db);
+
+  // One transaction around the inserts so the numbers measure statement overhead,
+  // not one WAL commit per row.
+  auto t0 = Clock::now();
+  {
+    core::storage::Transaction tx(db);
+    for (std::size_t i = 0; i < rows; ++i) insertRow(db, i);
+    tx.commit();
+  }
+  const double insertS = secondsSince(t0);
+
+  std::mt19937_64 rng(7);
+  std::size_t found = 0;
+  t0 = Clock::now();
+  for (std::size_t i = 0; i < rows; ++i) {
+    for (const auto& row : db.query("SELECT title, ts FROM history WHERE url = ?;",
+                                    {"https://example.org/page/" + std::to_string(rng() % rows)})) {
+      found += row.text(0).size() > 0 && row.int64(1) >= 0;
+    }
+  }
+  const double selectS = secondsSince(t0);
+
+  std::printf("%-10s insert %9.0f rows/s   select %9.0f rows/s   (%zu found)\n", label, double(rows) / insertS,
+              double(rows) / selectS, found);
+  db.close();
+  removeDb();
+}
+
+static void report(const char* label, std::size_t rows, double seconds) {
+  std::printf("%-22s %9zu rows %8.2f s %10.0f rows/s\n", label, rows, seconds, double(rows) / seconds);
+}
+
+static void bulk(std::size_t rows) {
+  {
+    // One WAL commit per row is slow enough that a tenth of the rows makes the point.
+    core::storage::SqliteDb db;
+    openDb(db);
+    const std::size_t n = std::max<std::size_t>(rows / 10, 1);
+    const auto t0 = Clock::now();
+    for (std::size_t i = 0; i < n; ++i) insertRow(db, i);
+    report("commit per row", n, secondsSince(t0));
+  }
+  {
+    core::storage::SqliteDb db;
+    openDb(db);
+    const auto t0 = Clock::now();
+    core::storage::Transaction tx(db);
+    for (std::size_t i = 0; i < rows; ++i) insertRow(db, i);
+    tx.commit();
+    report("one transaction", rows, secondsSince(t0));
+  }
+  for (std::size_t batch : {100, 1000, 10000}) {
+    core::storage::SqliteDb db;
+    openDb(db);
+    const auto t0 = Clock::now();
+    {
+      core::storage::BatchWriter w(db, {batch, std::chrono::milliseconds(250)});
+      for (std::size_t i = 0; i < rows; ++i)
+        w.add(kInsert, {"https://example.org/page/" + std::to_string(i), "Page " + std::to_string(i), i});
+    }
+    const std::string label = "BatchWriter " + std::to_string(batch);
+    report(label.c_str(), rows, secondsSince(t0));
+  }
+  removeDb();
+}
+
+int main(int argc, char** argv) {
+  const std::size_t rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+  const std::size_t bulkRows = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+  run("uncached", 0, rows);
+  run("cached", 64, rows);
+  bulk(bulkRows);
+  return 0;
+}
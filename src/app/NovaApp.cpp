@@ -3,10 +3,13 @@
 #include "app/NovaApp.h"
 #include "ui/MainWindow.h"
 #include "core/storage/Migrations.h"
+#include "core/entities/Gazetteer.h"
+#include "core/extract/ExtractionCache.h"
 #include "util/Log.h"
 #include <QStandardPaths>
 #include <QDir>
 #include <QtWebEngineCore/QtWebEngineCore>
+#include <algorithm>
 
 NovaApp::NovaApp(int& argc, char** argv)
   : app_(argc, argv) {
@@ -47,6 +50,7 @@ bool NovaApp::initStorage() {
   QString dbPath = dir + "/novabrowse.sqlite3";
   if (!db_.open(dbPath.toStdString())) return false;
   if (!core::storage::runMigrations(db_)) return false;
+  writer_ = std::make_unique<core::storage::BatchWriter>(db_);
   util::Log::info("DB opened: " + dbPath.toStdString());
   return true;
 }
@@ -57,10 +61,22 @@ void NovaApp::initServices() {
   fetcher_.setStripTracking(config_.stripTrackingParams());
   fetcher_.setRate(config_.rateLimitPerSec());
 
+  core::extract::ExtractionCache::shared().setBudgetBytes(
+    static_cast<std::size_t>(std::max(0, config_.extractCacheMb())) * 1024 * 1024);
+
+  // Dictionaries next to the exe (or bundled in the working dir), compiled into AppData.
+  QString dictDir = QCoreApplication::applicationDirPath() + "/data/gazetteer";
+  if (!QFileInfo::exists(dictDir)) dictDir = QDir::currentPath() + "/config/gazetteer";
+  if (!core::entities::Gazetteer::loadShared(dictDir.toStdString(), (dataDir() + "/gazetteer.bin").toStdString())) {
+    util::Log::warn("Gazetteer: using built-in lists");
+  }
+
   search_ = std::make_unique<services::search::DdgHtmlSearch>(&fetcher_);
   ollama_ = std::make_unique<services::ai::OllamaClient>(&fetcher_);
   ollama_->setHost(QString::fromStdString(config_.ollamaHost()));
   deepsearch_ = std::make_unique<services::deepsearch::DeepSearchService>(&db_);
+  deepsearch_->loadGraph();
+  analysis_ = std::make_unique<services::analysis::PageAnalysisService>();
 }
 
 int NovaApp::run() {
@@ -6,10 +6,12 @@
 
 #include "util/Config.h"
 #include "core/storage/SqliteDb.h"
+#include "core/storage/BatchWriter.h"
 #include "core/net/FetchService.h"
 #include "services/search/DdgHtmlSearch.h"
 #include "services/ai/OllamaClient.h"
 #include "services/deepsearch/DeepSearchService.h"
+#include "services/analysis/PageAnalysisService.h"
 
 namespace ui { class MainWindow; }
 
@@ -20,20 +22,25 @@ public:
 
   util::Config& config() { return config_; }
   core::storage::SqliteDb& db() { return db_; }
+  // Grouped commits for frequent small writes (history).
+  core::storage::BatchWriter& writer() { return *writer_; }
   core::net::FetchService& fetcher() { return fetcher_; }
   services::search::DdgHtmlSearch& search() { return *search_; }
   services::ai::OllamaClient& ollama() { return *ollama_; }
   services::deepsearch::DeepSearchService& deepsearch() { return *deepsearch_; }
+  services::analysis::PageAnalysisService& analysis() { return *analysis_; }
 
 private:
   QApplication app_;
   util::Config config_;
   core::storage::SqliteDb db_;
+  std::unique_ptr<core::storage::BatchWriter> writer_;
   core::net::FetchService fetcher_;
 
   std::unique_ptr<services::search::DdgHtmlSearch> search_;
   std::unique_ptr<services::ai::OllamaClient> ollama_;
   std::unique_ptr<services::deepsearch::DeepSearchService> deepsearch_;
+  std::unique_ptr<services::analysis::PageAnalysisService> analysis_;
   std::unique_ptr<ui::MainWindow> mainWindow_;
 
   QString dataDir() const;
@@ -0,0 +1,259 @@
+#include "core/entities/AliasResolver.h"
+#include "util/Hash.h"
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <unordered_set>
+
+namespace core::entities {
+
+namespace {
+
+constexpr int kBands = 8;
+constexpr int kRows = 4;
+using Signature = std::array<std::uint64_t, kBands * kRows>;
+
+bool isAlnum(unsigned char c) {
+  return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c >= 0x80;
+}
+
+const std::unordered_set<std::string_view>& leadingWords() {
+  static const std::unordered_set<std::string_view> words = {
+    "the", "dr", "mr", "mrs", "ms", "mx", "miss", "prof", "sir", "dame", "rev", "hon"};
+  return words;
+}
+
+const std::unordered_set<std::string_view>& legalForms() {
+  static const std::unordered_set<std::string_view> words = {
+    "inc", "ltd", "llc", "llp", "plc", "gmbh", "ag", "sa", "se", "nv", "bv",
+    "co", "corp", "corporation", "limited"};
+  return words;
+}
+
+std::vector<std::string_view> splitTokens(std::string_view key) {
+  std::vector<std::string_view> out;
+  std::size_t i = 0;
+  while (i < key.size()) {
+    const std::size_t sp = key.find(' ', i);
+    const std::size_t end = sp == std::string_view::npos ? key.size() : sp;
+    if (end > i) out.push_back(key.substr(i, end - i));
+    i = end + 1;
+  }
+  return out;
+}
+
+std::vector<std::string> tokenSet(std::string_view key) {
+  std::vector<std::string> out;
+  for (auto t : splitTokens(key)) out.emplace_back(t);
+  std::sort(out.begin(), out.end());
+  out.erase(std::unique(out.begin(), out.end()), out.end());
+  return out;
+}
+
+std::size_t intersectionSize(const std::vector<std::string>& a, const std::vector<std::string>& b) {
+  std::size_t n = 0;
+  for (auto i = a.begin(), j = b.begin(); i != a.end() && j != b.end();) {
+    if (*i < *j) ++i;
+    else if (*j < *i) ++j;
+    else { ++n; ++i; ++j; }
+  }
+  return n;
+}
+
+double jaccard(const std::vector<std::string>& a, const std::vector<std::string>& b) {
+  if (a.empty() || b.empty()) return 0.0;
+  const std::size_t common = intersectionSize(a, b);
+  return double(common) / double(a.size() + b.size() - common);
+}
+
+// a is a proper subset of b that includes b's last token.
+bool namesPart(const std::vector<std::string>& a, const std::vector<std::string>& b, const std::string& bLast) {
+  return a.size() < b.size() && intersectionSize(a, b) == a.size() &&
+         std::binary_search(a.begin(), a.end(), bLast);
+}
+
+bool typesAgree(std::string_view a, std::string_view b) {
+  return a == b || a == "unknown" || b == "unknown";
+}
+
+std::uint64_t mix(std::uint64_t x) {
+  x ^= x >> 30; x *= 0xBF58476D1CE4E5B9ull;
+  x ^= x >> 27; x *= 0x94D049BB133111EBull;
+  return x ^ (x >> 31);
+}
+
+// MinHash over the trigrams of each space-padded token, so token order does not matter.
+Signature minhash(std::string_view key) {
+  Signature sig;
+  sig.fill(~std::uint64_t(0));
+  std::string padded;
+  for (auto t : splitTokens(key)) {
+    padded.assign(1, ' ');
+    padded.append(t);
+    padded.push_back(' ');
+    for (std::size_t i = 0; i + 3 <= padded.size(); ++i) {
+      const std::uint64_t h = util::xxh64(std::string_view(padded).substr(i, 3));
+      for (std::size_t k = 0; k < sig.size(); ++k) sig[k] = std::min(sig[k], mix(h + k * 0x9E3779B97F4A7C15ull));
+    }
+  }
+  return sig;
+}
+
+std::array<std::uint64_t, kBands> bandKeys(std::string_view key) {
+  const Signature sig = minhash(key);
+  std::array<std::uint64_t, kBands> out;
+  for (int b = 0; b < kBands; ++b) out[b] = util::xxh64(&sig[b * kRows], kRows * sizeof(std::uint64_t), b);
+  return out;
+}
+
+std::string_view lastToken(std::string_view key) {
+  const std::size_t sp = key.rfind(' ');
+  return sp == std::string_view::npos ? key : key.substr(sp + 1);
+}
+
+} // namespace
+
+std::string AliasResolver::normalizeKey(std::string_view name) {
+  std::string flat;
+  flat.reserve(name.size());
+  for (std::size_t i = 0; i < name.size(); ++i) {
+    const unsigned char c = static_cast<unsigned char>(name[i]);
+    if (c == '\'' || c == '.') {
+      // Possessive "'s" goes; otherwise the mark joins its neighbours (O'Brien, U.N.).
+      if (c == '\'' && i + 1 < name.size() && (name[i + 1] == 's' || name[i + 1] == 'S') &&
+          (i + 2 == name.size() || !isAlnum(static_cast<unsigned char>(name[i + 2])))) ++i;
+      else if (c == '.' && (i + 1 == name.size() || !isAlnum(static_cast<unsigned char>(name[i + 1])))) flat.push_back(' ');
+      continue;
+    }
+    if (!isAlnum(c)) { flat.push_back(' '); continue; }
+    flat.push_back((c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : char(c));
+  }
+
+  auto tokens = splitTokens(flat);
+  std::size_t first = 0, last = tokens.size();
+  while (last - first > 1 && leadingWords().count(tokens[first])) ++first;
+  while (last - first > 1 && legalForms().count(tokens[last - 1])) --last;
+
+  std::string out;
+  for (std::size_t i = first; i < last; ++i) {
+    if (!out.empty()) out.push_back(' ');
+    out.append(tokens[i]);
+  }
+  return out;
+}
+
+double AliasResolver::tokenSetSimilarity(std::string_view a, std::string_view b) {
+  return jaccard(tokenSet(a), tokenSet(b));
+}
+
+std::ptrdiff_t AliasResolver::find(std::string_view name, std::string_view type) const {
+  const std::string norm = normalizeKey(name);
+  if (norm.empty()) return -1;
+
+  if (auto it = exact_.find(norm); it != exact_.end()) {
+    for (auto k : it->second) {
+      if (typesAgree(entities_[keys_[k].entity].type, type)) return keys_[k].entity;
+    }
+  }
+
+  std::vector<std::uint32_t> cands;
+  auto gather = [&](const std::vector<std::uint32_t>& block) {
+    if (block.size() <= kMaxBlock) cands.insert(cands.end(), block.begin(), block.end());
+  };
+  for (auto band : bandKeys(norm)) {
+    if (auto it = bands_.find(band); it != bands_.end()) gather(it->second);
+  }
+  const std::string last(lastToken(norm));
+  if (auto it = surnames_.find(last); it != surnames_.end()) gather(it->second);
+  std::sort(cands.begin(), cands.end());
+  cands.erase(std::unique(cands.begin(), cands.end()), cands.end());
+
+  const auto tokens = tokenSet(norm);
+  std::ptrdiff_t best = -1;
+  double bestScore = 0.0;
+  std::ptrdiff_t part = -1;
+  bool ambiguous = false;
+  for (auto k : cands) {
+    const Key& key = keys_[k];
+    const Entity& e = entities_[key.entity];
+    if (!typesAgree(e.type, type)) continue;
+
+    const double score = jaccard(tokens, key.tokens);
+    if (score >= threshold_ && score > bestScore) {
+      best = key.entity;
+      bestScore = score;
+    }
+    const bool isPart = (e.type == "person" && namesPart(tokens, key.tokens, key.last)) ||
+                        (type == "person" && namesPart(key.tokens, tokens, last));
+    if (isPart) {
+      if (part >= 0 && part != std::ptrdiff_t(key.entity)) ambiguous = true;
+      part = key.entity;
+    }
+  }
+  if (best >= 0) return best;
+  return ambiguous ? -1 : part;
+}
+
+std::size_t AliasResolver::add(Entity entity) {
+  const auto i = static_cast<std::uint32_t>(entities_.size());
+  entities_.push_back(std::move(entity));
+  const Entity& e = entities_.back();
+  indexKey(i, e.name);
+  for (const auto& a : e.aliases) indexKey(i, a);
+  return i;
+}
+
+bool AliasResolver::addAlias(std::size_t i, std::string_view name) {
+  Entity& e = entities_[i];
+  if (e.name == name || std::find(e.aliases.begin(), e.aliases.end(), name) != e.aliases.end()) return false;
+  if (e.aliases.size() >= kMaxAliases) return false;
+  e.aliases.emplace_back(name);
+  indexKey(static_cast<std::uint32_t>(i), name);
+  return true;
+}
+
+void AliasResolver::indexKey(std::uint32_t entity, std::string_view name) {
+  std::string norm = normalizeKey(name);
+  if (norm.empty()) return;
+  auto& same = exact_[norm];
+  for (auto k : same) {
+    if (keys_[k].entity == entity) return;
+  }
+
+  const auto k = static_cast<std::uint32_t>(keys_.size());
+  same.push_back(k);
+  for (auto band : bandKeys(norm)) bands_[band].push_back(k);
+  Key key{entity, std::move(norm), {}, {}};
+  key.last = std::string(lastToken(key.norm));
+  key.tokens = tokenSet(key.norm);
+  if (entities_[entity].type == "person" && key.tokens.size() > 1) surnames_[key.last].push_back(k);
+  keys_.push_back(std::move(key));
+}
+
+std::vector<std::size_t> AliasResolver::cluster(const std::vector<std::pair<std::string, std::string>>& names,
+                                                double threshold) {
+  std::vector<std::size_t> order(names.size());
+  std::iota(order.begin(), order.end(), std::size_t(0));
+  std::vector<std::size_t> width(names.size());
+  for (std::size_t i = 0; i < names.size(); ++i) width[i] = tokenSet(normalizeKey(names[i].first)).size();
+  std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return width[a] > width[b]; });
+
+  AliasResolver r(threshold);
+  std::vector<std::size_t> canonical; // entity -> input index
+  std::vector<std::size_t> out(names.size());
+  for (auto i : order) {
+    const auto& [name, type] = names[i];
+    const std::ptrdiff_t f = r.find(name, type);
+    if (f < 0) {
+      r.add({std::to_string(i), name, type, {}});
+      canonical.push_back(i);
+      out[i] = i;
+    } else {
+      r.addAlias(std::size_t(f), name);
+      out[i] = canonical[std::size_t(f)];
+    }
+  }
+  return out;
+}
+
+} // namespace core::entities
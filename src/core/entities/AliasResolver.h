@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace core::entities {
+
+// Maps surface forms ("Dr. Angela Merkel", "Merkel", "ANGELA MERKEL") onto canonical
+// entities. A name joins an entity when
+//   - its normalized key equals one of the entity's keys, or
+//   - the token sets of the two keys have Jaccard similarity >= threshold, or
+//   - one token set contains the other, including the longer one's last token, and the
+//     longer one is a person: "Merkel" / "Angela Dorothea Merkel". Only taken when a
+//     single entity qualifies, so a bare surname shared by two people stays separate.
+// Types must agree unless one of them is "unknown".
+//
+// Candidates come from blocking, never from a scan over all entities: exact keys,
+// MinHash/LSH bands over the keys' character trigrams, and the last token of person
+// names. Blocks larger than kMaxBlock are too unspecific and are skipped.
+class AliasResolver {
+public:
+  static constexpr std::size_t kMaxBlock = 256;
+  static constexpr std::size_t kMaxAliases = 32;
+
+  struct Entity {
+    std::string id;
+    std::string name;
+    std::string type;
+    std::vector<std::string> aliases; // other surface forms, first seen first
+  };
+
+  explicit AliasResolver(double threshold = 0.75) : threshold_(threshold) {}
+
+  // Lower-case, punctuation dropped, leading titles ("dr", "mr", ...) and trailing
+  // legal forms ("inc", "gmbh", ...) removed, single spaces. Non-ASCII bytes are kept.
+  static std::string normalizeKey(std::string_view name);
+  // Jaccard similarity of the token sets of two normalized keys.
+  static double tokenSetSimilarity(std::string_view a, std::string_view b);
+
+  // Index of the entity name resolves to, or -1.
+  std::ptrdiff_t find(std::string_view name, std::string_view type) const;
+  // Adds an entity and indexes its name and aliases; returns its index.
+  std::size_t add(Entity entity);
+  // Records name as a surface form of entity i. False if it was already known (or the
+  // alias list is full).
+  bool addAlias(std::size_t i, std::string_view name);
+
+  std::size_t size() const { return entities_.size(); }
+  const Entity& entity(std::size_t i) const { return entities_[i]; }
+
+  // Groups (name, type) pairs offline: longer names first, so full names exist before
+  // the bare surnames that refer to them. Returns, per input, the index in names of
+  // its group's canonical (longest, then earliest) member.
+  static std::vector<std::size_t> cluster(const std::vector<std::pair<std::string, std::string>>& names,
+                                          double threshold = 0.75);
+
+private:
+  struct Key {
+    std::uint32_t entity;
+    std::string norm;
+    std::string last;                // last token, in name order
+    std::vector<std::string> tokens; // sorted, unique
+  };
+
+  double threshold_;
+  std::vector<Entity> entities_;
+  std::vector<Key> keys_;
+  std::unordered_map<std::string, std::vector<std::uint32_t>> exact_;
+  std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> bands_;
+  std::unordered_map<std::string, std::vector<std::uint32_t>> surnames_;
+
+  void indexKey(std::uint32_t entity, std::string_view name);
+};
+
+} // namespace core::entities
@@ -0,0 +1,50 @@
+#include "core/entities/Cooccurrence.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace core::entities {
+
+void CooccurrenceDelta::add(DocumentOccurrences doc, int sign) {
+  if (doc.empty()) return;
+  docs_ += sign;
+
+  std::vector<std::string> allBlocks;
+  for (auto& [id, blocks] : doc) {
+    std::sort(blocks.begin(), blocks.end());
+    blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+    auto& c = entities_[id];
+    c.docs += sign;
+    c.blocks += sign * std::int64_t(blocks.size());
+    allBlocks.insert(allBlocks.end(), blocks.begin(), blocks.end());
+  }
+  std::sort(allBlocks.begin(), allBlocks.end());
+  blocks_ += sign * std::int64_t(std::unique(allBlocks.begin(), allBlocks.end()) - allBlocks.begin());
+
+  std::vector<std::string> shared;
+  for (auto a = doc.begin(); a != doc.end(); ++a) {
+    for (auto b = std::next(a); b != doc.end(); ++b) {
+      shared.clear();
+      std::set_intersection(a->second.begin(), a->second.end(), b->second.begin(), b->second.end(),
+                            std::back_inserter(shared));
+      auto& c = pairs_[{a->first, b->first}];
+      c.docs += sign;
+      c.blocks += sign * std::int64_t(shared.size());
+    }
+  }
+}
+
+void CooccurrenceDelta::prune() {
+  std::erase_if(entities_, [](const auto& kv) { return kv.second.zero(); });
+  std::erase_if(pairs_, [](const auto& kv) { return kv.second.zero(); });
+}
+
+double npmi(std::int64_t nab, std::int64_t na, std::int64_t nb, std::int64_t n) {
+  if (nab <= 0 || na <= 0 || nb <= 0 || n <= 0) return -1.0;
+  if (nab >= n) return 1.0;
+  const double pab = double(nab) / double(n);
+  const double pmi = std::log(pab / ((double(na) / double(n)) * (double(nb) / double(n))));
+  return std::clamp(pmi / -std::log(pab), -1.0, 1.0);
+}
+
+} // namespace core::entities
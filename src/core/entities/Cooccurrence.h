@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace core::entities {
+
+// One document's entities: entity id -> ids of the blocks it was seen in (may be empty
+// for entities known only from structured data).
+using DocumentOccurrences = std::map<std::string, std::vector<std::string>>;
+
+// Change to the corpus-wide co-occurrence counts caused by adding or removing
+// documents, in two windows: the document, and the block. Counts are sparse: only
+// entities and pairs that occur are present, pairs keyed with first < second.
+// Re-indexing a document is add(old, -1) followed by add(new, +1); entries that cancel
+// out are dropped by prune().
+class CooccurrenceDelta {
+public:
+  struct Counts {
+    std::int64_t docs = 0;
+    std::int64_t blocks = 0;
+    bool zero() const { return docs == 0 && blocks == 0; }
+  };
+
+  void add(DocumentOccurrences doc, int sign = 1);
+  void prune();
+
+  bool empty() const { return docs_ == 0 && blocks_ == 0 && entities_.empty() && pairs_.empty(); }
+  // Documents / blocks with at least one entity.
+  std::int64_t docs() const { return docs_; }
+  std::int64_t blocks() const { return blocks_; }
+  const std::map<std::string, Counts>& entities() const { return entities_; }
+  const std::map<std::pair<std::string, std::string>, Counts>& pairs() const { return pairs_; }
+
+private:
+  std::int64_t docs_ = 0;
+  std::int64_t blocks_ = 0;
+  std::map<std::string, Counts> entities_;
+  std::map<std::pair<std::string, std::string>, Counts> pairs_;
+};
+
+// Normalized pointwise mutual information of two events seen together nab times, on
+// their own na and nb times, out of n windows: log(p(a,b) / p(a)p(b)) / -log p(a,b).
+// 1 when they only occur together, 0 when independent, -1 when never together.
+double npmi(std::int64_t nab, std::int64_t na, std::int64_t nb, std::int64_t n);
+
+} // namespace core::entities
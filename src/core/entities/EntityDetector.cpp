@@ -1,10 +1,16 @@
 \
 /* src/core/entities/EntityDetector.cpp */
 #include "core/entities/EntityDetector.h"
+#include "core/entities/Gazetteer.h"
+#include "util/Log.h"
+#include "util/Utf8.h"
 #include <algorithm>
 #include <cctype>
-#include <regex>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace core::entities {
 
@@ -16,77 +22,399 @@ static std::string trim(const std::string& s) {
   return std::string(b, e);
 }
 
-static bool isStopword(const std::string& w) {
-  static const std::unordered_map<std::string, bool> stop = {
-    {"The",true},{"A",true},{"An",true},{"And",true},{"Or",true},{"But",true},
-    {"This",true},{"That",true},{"These",true},{"Those",true},{"In",true},{"On",true},
-    {"At",true},{"For",true},{"With",true},{"From",true},{"By",true},{"As",true},
-    {"It",true},{"Its",true},{"He",true},{"She",true},{"They",true},{"We",true},{"I",true}
+static bool isStopword(std::string_view w) {
+  static const std::unordered_set<std::string_view> stop = {
+    "The","A","An","And","Or","But","This","That","These","Those","In","On",
+    "At","For","With","From","By","As","It","Its","He","She","They","We","I"
   };
-  return stop.find(w) != stop.end();
+  return stop.count(w) != 0;
+}
+
+// Character classes of the original ECMAScript pattern [A-Z][a-zA-Z\-']+, widened to
+// Unicode: an uppercase letter (Lu/Lt), then letters, combining marks, '-', '\'' or
+// U+2019. ASCII bytes are classified inline; only non-ASCII input decodes UTF-8.
+static bool isUpper(char c) { return c >= 'A' && c <= 'Z'; }
+static bool isTokenChar(char c) { return (c >= 'a' && c <= 'z') || isUpper(c) || c == '-' || c == '\''; }
+static bool isWordChar(char c) { return isTokenChar(c) ? c != '-' && c != '\'' : (c >= '0' && c <= '9') || c == '_'; }
+static bool isSpaceChar(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+static bool isAscii(char c) { return static_cast<unsigned char>(c) < 0x80; }
+
+// Length of the uppercase letter at t[i], or 0.
+static std::size_t upperAt(std::string_view t, std::size_t i) {
+  if (isAscii(t[i])) return isUpper(t[i]) ? 1 : 0;
+  char32_t cp;
+  const std::size_t len = util::utf8::decode(t, i, cp);
+  return util::utf8::isUpper(cp) ? len : 0;
+}
+
+// Length of the token character at t[i], or 0.
+static std::size_t tokenCharAt(std::string_view t, std::size_t i) {
+  if (isAscii(t[i])) return isTokenChar(t[i]) ? 1 : 0;
+  char32_t cp;
+  const std::size_t len = util::utf8::decode(t, i, cp);
+  return util::utf8::isAlpha(cp) || cp == 0x2019 ? len : 0;
+}
+
+static bool wordCharAt(std::string_view t, std::size_t i) {
+  if (isAscii(t[i])) return isWordChar(t[i]);
+  char32_t cp;
+  util::utf8::decode(t, i, cp);
+  return util::utf8::isAlpha(cp);
+}
+
+static bool wordCharBefore(std::string_view t, std::size_t i) {
+  if (i == 0) return false;
+  return isAscii(t[i - 1]) ? isWordChar(t[i - 1]) : wordCharAt(t, util::utf8::prevStart(t, i));
+}
+
+// End of the maximal token at i, or i when there is none.
+static std::size_t tokenEnd(std::string_view t, std::size_t i) {
+  if (i >= t.size()) return i;
+  const std::size_t first = upperAt(t, i);
+  if (first == 0) return i;
+  std::size_t e = i + first;
+  while (e < t.size()) {
+    if (isAscii(t[e])) {
+      if (!isTokenChar(t[e])) break;
+      ++e;
+      continue;
+    }
+    const std::size_t len = tokenCharAt(t, e);
+    if (len == 0) break;
+    e += len;
+  }
+  return e > i + first ? e : i;
+}
+
+// \b at e: exactly one of the characters before and at e is a word character.
+static bool boundaryAt(std::string_view t, std::size_t e) {
+  const bool before = wordCharBefore(t, e);
+  const bool after = e < t.size() && wordCharAt(t, e);
+  return before != after;
 }
 
 bool EntityDetector::looksLikePerson(const std::string& name) {
-  // Two capitalized tokens
-  std::regex re(R"(^[A-Z][a-zA-Z\-']+\s+[A-Z][a-zA-Z\-']+(\s+[A-Z][a-zA-Z\-']+)?$)");
-  return std::regex_match(name, re);
+  // Two or three capitalized tokens separated by whitespace, nothing else.
+  std::size_t tokens = 0;
+  for (std::size_t i = 0; ; ) {
+    const std::size_t e = tokenEnd(name, i);
+    if (e == i) return false;
+    ++tokens;
+    if (e == name.size()) break;
+    i = e;
+    while (i < name.size() && isSpaceChar(name[i])) ++i;
+    if (i == e || tokens == 3) return false;
+  }
+  return tokens >= 2;
 }
 
-bool EntityDetector::looksLikeOrg(const std::string& name) {
-  static const std::vector<std::string> hints = {"Inc","Corp","LLC","Ltd","GmbH","AG","University","Institute","Company","Bank","Group"};
-  for (const auto& h : hints) {
-    if (name.find(h) != std::string::npos) return true;
+std::vector<std::string_view> EntityDetector::candidates(std::string_view text) {
+  std::vector<std::string_view> out;
+  const std::size_t n = text.size();
+  std::size_t i = 0;
+  while (i < n) {
+    std::size_t step = 1;
+    bool upper;
+    if (isAscii(text[i])) {
+      upper = isUpper(text[i]);
+    } else {
+      char32_t cp;
+      step = util::utf8::decode(text, i, cp);
+      upper = util::utf8::isUpper(cp);
+    }
+    if (!upper || wordCharBefore(text, i)) {
+      i += step;
+      continue;
+    }
+    // Greedy run of up to four maximal tokens joined by whitespace.
+    std::size_t starts[4];
+    std::size_t ends[4];
+    int k = 0;
+    for (std::size_t s = i; k < 4; ) {
+      const std::size_t e = tokenEnd(text, s);
+      if (e == s) break;
+      starts[k] = s;
+      ends[k++] = e;
+      s = e;
+      while (s < n && isSpaceChar(text[s])) ++s;
+      if (s == e) break;
+    }
+    // Backtrack the way the regex did: last token first, longest end first, until the
+    // closing \b holds. Shorter tokens cannot be followed by another token. Ends step
+    // back by whole characters and keep at least one after the capital.
+    std::size_t matchEnd = std::string_view::npos;
+    for (int j = k - 1; j >= 0 && matchEnd == std::string_view::npos; --j) {
+      const std::size_t minEnd = starts[j] + upperAt(text, starts[j]);
+      for (std::size_t e = ends[j]; e > minEnd; e = isAscii(text[e - 1]) ? e - 1 : util::utf8::prevStart(text, e)) {
+        if (boundaryAt(text, e)) {
+          matchEnd = e;
+          break;
+        }
+      }
+    }
+    if (matchEnd == std::string_view::npos) {
+      i += step;
+      continue;
+    }
+    out.push_back(text.substr(i, matchEnd - i));
+    i = matchEnd;
   }
-  return false;
+  return out;
 }
 
-bool EntityDetector::looksLikePlace(const std::string& name) {
-  static const std::vector<std::string> hints = {"City","State","Province","County","Berlin","London","Paris","New York","Munich","Hamburg"};
-  for (const auto& h : hints) {
-    if (name.find(h) != std::string::npos) return true;
+void EntityCounts::add(std::string_view name, int n) {
+  counts_[std::string(name)] += n;
+}
+
+void EntityCounts::addSpan(std::string_view name, MentionSpan span) {
+  if (!keepSpans_) return;
+  auto& spans = spans_[std::string(name)];
+  if (spans.size() < kMaxSpans) spans.push_back(std::move(span));
+}
+
+void EntityCounts::merge(const EntityCounts& other) {
+  for (const auto& [name, n] : other.counts_) counts_[name] += n;
+  if (!keepSpans_) return;
+  for (const auto& [name, theirs] : other.spans_) {
+    auto& ours = spans_[name];
+    for (std::size_t i = 0; i < theirs.size() && ours.size() < kMaxSpans; ++i) ours.push_back(theirs[i]);
   }
-  return false;
 }
 
-std::vector<EntityMention> EntityDetector::detect(const std::string& text) {
+const std::vector<MentionSpan>* EntityCounts::spans(const std::string& name) const {
+  auto it = spans_.find(name);
+  return it == spans_.end() ? nullptr : &it->second;
+}
+
+// A piece of detection input: block text (base 0) or a slice of a longer text.
+struct TextPiece {
+  std::string_view text;
+  std::string_view blockId;
+  std::size_t base = 0;
+};
+
+// Below this much text per task, splitting costs more than it saves.
+static constexpr std::size_t kChunkBytes = 32 * 1024;
+
+void EntityDetector::count(std::string_view text, EntityCounts& counts, std::string_view blockId, std::size_t base) {
   // Heuristic: sequences of capitalized words, limited length
-  std::regex re(R"(\b([A-Z][a-zA-Z\-']+)(\s+[A-Z][a-zA-Z\-']+){0,3}\b)");
-  std::sregex_iterator it(text.begin(), text.end(), re);
-  std::sregex_iterator end;
-
-  std::unordered_map<std::string, int> freq;
-  for (; it != end; ++it) {
-    std::string m = trim(it->str());
-    if (m.size() < 4) continue;
+  std::unordered_map<std::string_view, int> freq;
+  for (std::string_view m : candidates(text)) {
+    const std::size_t chars = util::utf8::length(m);
+    if (chars < 4) continue;
     if (isStopword(m)) continue;
     // skip sentence starts like "However"
-    if (m.find(' ') == std::string::npos && m.size() < 7) continue;
+    if (m.find(' ') == std::string_view::npos && chars < 7) continue;
     freq[m]++;
+    if (counts.keepsSpans()) {
+      const std::size_t begin = base + std::size_t(m.data() - text.data());
+      counts.addSpan(m, {std::string(blockId), (std::uint32_t)begin, (std::uint32_t)(begin + m.size())});
+    }
   }
+  for (const auto& [name, n] : freq) counts.add(name, n);
+}
 
+std::vector<EntityMention> EntityDetector::rank(const EntityCounts& counts) const {
+  // Org and place names come from the gazetteer; one automaton pass per name.
+  const auto gazetteer = Gazetteer::shared();
   std::vector<EntityMention> out;
-  out.reserve(freq.size());
-  for (const auto& kv : freq) {
+  out.reserve(counts.size());
+  for (const auto& kv : counts.counts()) {
     EntityMention em;
     em.name = kv.first;
     em.type = EntityType::Unknown;
+    if (const auto* spans = counts.spans(kv.first)) em.spans = *spans;
     em.confidence = std::min(0.95, 0.35 + kv.second * 0.08);
 
-    if (looksLikeOrg(em.name)) { em.type = EntityType::Org; em.confidence = std::min(0.98, em.confidence + 0.15); }
-    else if (looksLikePlace(em.name)) { em.type = EntityType::Place; em.confidence = std::min(0.98, em.confidence + 0.10); }
+    GazetteerCategory category = GazetteerCategory::Org;
+    const bool known = gazetteer->classify(em.name, category);
+    if (known && category == GazetteerCategory::Org) { em.type = EntityType::Org; em.confidence = std::min(0.98, em.confidence + 0.15); }
+    else if (known && category == GazetteerCategory::Place) { em.type = EntityType::Place; em.confidence = std::min(0.98, em.confidence + 0.10); }
     else if (looksLikePerson(em.name)) { em.type = EntityType::Person; em.confidence = std::min(0.98, em.confidence + 0.20); }
 
     out.push_back(em);
   }
 
   std::sort(out.begin(), out.end(), [](const EntityMention& a, const EntityMention& b) {
-    return a.confidence > b.confidence;
+    if (a.confidence != b.confidence) return a.confidence > b.confidence;
+    return a.name < b.name;
   });
 
   if (out.size() > 30) out.resize(30);
   return out;
 }
 
+std::vector<EntityMention> EntityDetector::detect(const std::string& text) {
+  EntityCounts counts(true);
+  count(text, counts);
+  return rank(counts);
+}
+
+// Pieces of about target bytes, cut after whitespace and before an ASCII character that
+// is neither whitespace nor A-Z. No candidate continues across such a cut, and its \b
+// tests see the same neighbours, so counting the pieces equals counting the whole.
+static std::vector<TextPiece> splitText(std::string_view text, std::size_t target) {
+  std::vector<TextPiece> pieces;
+  std::size_t start = 0;
+  while (text.size() - start > target) {
+    std::size_t p = start + target;
+    while (p < text.size() && !(isSpaceChar(text[p - 1]) && isAscii(text[p]) && !isSpaceChar(text[p]) && !isUpper(text[p]))) ++p;
+    if (p >= text.size()) break;
+    pieces.push_back({text.substr(start, p - start), {}, start});
+    start = p;
+  }
+  pieces.push_back({text.substr(start), {}, start});
+  return pieces;
+}
+
+// Counts independent pieces of text (blocks, or splitText output). Consecutive pieces
+// are grouped into tasks of about kChunkBytes, each fills its own table, and the
+// partial tables are merged once all tasks are done. Small inputs, and calls from a
+// pool worker (which must not block on its own pool), are counted inline.
+static EntityCounts countPieces(const std::vector<TextPiece>& pieces, core::exec::WorkStealingPool& pool) {
+  std::size_t total = 0;
+  for (const auto& p : pieces) total += p.text.size();
+  EntityCounts counts(true);
+  if (total < 2 * kChunkBytes || pool.size() < 2 || pool.isWorkerThread()) {
+    for (const auto& p : pieces) EntityDetector::count(p.text, counts, p.blockId, p.base);
+    return counts;
+  }
+
+  std::vector<std::pair<std::size_t, std::size_t>> groups;
+  for (std::size_t i = 0; i < pieces.size(); ) {
+    std::size_t j = i;
+    std::size_t bytes = 0;
+    while (j < pieces.size() && bytes < kChunkBytes) bytes += pieces[j++].text.size();
+    groups.push_back({i, j});
+    i = j;
+  }
+
+  struct State {
+    std::mutex mu;
+    std::condition_variable done;
+    std::size_t remaining = 0;
+    std::vector<EntityCounts> partial;
+  };
+  auto state = std::make_shared<State>();
+  state->remaining = groups.size();
+  state->partial.resize(groups.size());
+
+  std::vector<core::exec::WorkStealingPool::Task> tasks;
+  tasks.reserve(groups.size());
+  for (std::size_t g = 0; g < groups.size(); ++g) {
+    tasks.push_back([state, g, range = groups[g], &pieces](std::size_t) {
+      EntityCounts part(true);
+      for (std::size_t k = range.first; k < range.second; ++k) {
+        EntityDetector::count(pieces[k].text, part, pieces[k].blockId, pieces[k].base);
+      }
+      std::lock_guard<std::mutex> lk(state->mu);
+      state->partial[g] = std::move(part);
+      if (--state->remaining == 0) state->done.notify_all();
+    });
+  }
+  pool.submitBulk(std::move(tasks));
+
+  std::unique_lock<std::mutex> lk(state->mu);
+  state->done.wait(lk, [&]() { return state->remaining == 0; });
+  for (const auto& part : state->partial) counts.merge(part);
+  return counts;
+}
+
+std::vector<EntityMention> EntityDetector::detectParallel(std::string_view text, core::exec::WorkStealingPool& pool) {
+  return rank(countPieces(splitText(text, kChunkBytes), pool));
+}
+
+// The heuristic input of a page: its blocks, which fullText only decorates with ids.
+static std::vector<TextPiece> pagePieces(const core::extract::ExtractedPage& page) {
+  if (page.blocks.empty()) return splitText(page.fullText, kChunkBytes);
+  std::vector<TextPiece> pieces;
+  pieces.reserve(page.blocks.size());
+  for (const auto& b : page.blocks) pieces.push_back({b.text, b.id, 0});
+  return pieces;
+}
+
+std::vector<EntityMention> EntityDetector::pageMentions(const core::extract::ExtractedPage& page,
+                                                        const EntityCounts& counts) const {
+  using core::extract::StructuredKind;
+  std::vector<EntityMention> out;
+  std::unordered_set<std::string> seen;
+  for (const auto& s : page.structured) {
+    EntityType t;
+    switch (s.kind) {
+      case StructuredKind::Person: t = EntityType::Person; break;
+      case StructuredKind::Organization: t = EntityType::Org; break;
+      case StructuredKind::Place: t = EntityType::Place; break;
+      default: continue;
+    }
+    std::string name = trim(s.name);
+    if (name.empty() || !seen.insert(name).second) continue;
+    out.push_back({std::move(name), t, 0.99, {}});
+  }
+
+  for (auto& m : rank(counts)) {
+    if (seen.count(m.name)) continue;
+    out.push_back(std::move(m));
+  }
+  return out;
+}
+
+std::vector<EntityMention> EntityDetector::detectPage(const core::extract::ExtractedPage& page,
+                                                      core::exec::WorkStealingPool& pool) {
+  return pageMentions(page, countPieces(pagePieces(page), pool));
+}
+
+std::vector<std::vector<EntityMention>> EntityDetector::detectPages(
+    const std::vector<const core::extract::ExtractedPage*>& pages, EntityCounts* total,
+    core::exec::WorkStealingPool& pool) {
+  std::vector<std::vector<EntityMention>> results(pages.size());
+  if (pages.empty()) return results;
+  if (pool.isWorkerThread()) {
+    util::Log::error("EntityDetector::detectPages called from a pool worker; refusing to deadlock");
+    return results;
+  }
+
+  // A few dozen pages per task keeps scheduling overhead small on large imports.
+  const std::size_t perTask = std::clamp<std::size_t>(pages.size() / (pool.size() * 4 + 1), 1, 64);
+  const std::size_t taskCount = (pages.size() + perTask - 1) / perTask;
+
+  struct State {
+    std::mutex mu;
+    std::condition_variable done;
+    std::size_t remaining = 0;
+    std::vector<EntityCounts> partial;
+  };
+  auto state = std::make_shared<State>();
+  state->remaining = taskCount;
+  state->partial.resize(total ? taskCount : 0);
+
+  std::vector<core::exec::WorkStealingPool::Task> tasks;
+  tasks.reserve(taskCount);
+  for (std::size_t t = 0; t < taskCount; ++t) {
+    tasks.push_back([this, state, t, perTask, keepTotal = total != nullptr, totalSpans = total && total->keepsSpans(), &pages, &results](std::size_t) {
+      EntityCounts batch(totalSpans);
+      const std::size_t end = std::min(pages.size(), (t + 1) * perTask);
+      for (std::size_t i = t * perTask; i < end; ++i) {
+        if (!pages[i]) continue;
+        EntityCounts counts(true);
+        for (const auto& piece : pagePieces(*pages[i])) count(piece.text, counts, piece.blockId, piece.base);
+        results[i] = pageMentions(*pages[i], counts);
+        if (keepTotal) batch.merge(counts);
+      }
+      std::lock_guard<std::mutex> lk(state->mu);
+      if (keepTotal) state->partial[t] = std::move(batch);
+      if (--state->remaining == 0) state->done.notify_all();
+    });
+  }
+  pool.submitBulk(std::move(tasks));
+
+  std::unique_lock<std::mutex> lk(state->mu);
+  state->done.wait(lk, [&]() { return state->remaining == 0; });
+  if (total) {
+    for (const auto& part : state->partial) total->merge(part);
+  }
+  return results;
+}
+
 std::string toString(EntityType t) {
   switch (t) {
     case EntityType::Person: return "person";
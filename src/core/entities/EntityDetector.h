@@ -1,27 +1,96 @@
 \
 /* src/core/entities/EntityDetector.h */
 #pragma once
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
+#include "core/exec/WorkStealingPool.h"
+#include "core/extract/HtmlExtractor.h"
+
 namespace core::entities {
 
 enum class EntityType { Person, Org, Place, Unknown };
 
+// Where a heuristic mention occurs: byte offsets into the Block::text of blockId, or
+// into the detected text itself when blockId is empty.
+struct MentionSpan {
+  std::string blockId;
+  std::uint32_t begin = 0;
+  std::uint32_t end = 0;
+};
+
 struct EntityMention {
   std::string name;
   EntityType type;
   double confidence;
+  std::vector<MentionSpan> spans; // text order; empty for structured-data entities
+};
+
+// Candidate frequencies for a block, page or corpus. Tables counted separately (per
+// block, per thread) merge by adding counts, so detection can split its input freely.
+// A table built with keepSpans also records up to kMaxSpans positions per name.
+class EntityCounts {
+public:
+  static constexpr std::size_t kMaxSpans = 64;
+
+  explicit EntityCounts(bool keepSpans = false) : keepSpans_(keepSpans) {}
+
+  void add(std::string_view name, int n = 1);
+  void addSpan(std::string_view name, MentionSpan span);
+  // Spans are only taken over when this table keeps them.
+  void merge(const EntityCounts& other);
+
+  bool keepsSpans() const { return keepSpans_; }
+  bool empty() const { return counts_.empty(); }
+  std::size_t size() const { return counts_.size(); }
+  const std::unordered_map<std::string, int>& counts() const { return counts_; }
+  const std::vector<MentionSpan>* spans(const std::string& name) const;
+
+private:
+  bool keepSpans_;
+  std::unordered_map<std::string, int> counts_;
+  std::unordered_map<std::string, std::vector<MentionSpan>> spans_;
 };
 
 class EntityDetector {
 public:
   std::vector<EntityMention> detect(const std::string& text);
+  // Publisher-declared JSON-LD / microdata entities first (they are authoritative and
+  // replace same-named heuristic guesses), then heuristic mentions from the blocks.
+  // Large pages are counted block by block on the pool (inline on a pool worker).
+  std::vector<EntityMention> detectPage(const core::extract::ExtractedPage& page,
+                                        core::exec::WorkStealingPool& pool = core::exec::WorkStealingPool::shared());
+
+  // detect() for long text: cut where no candidate can span, count the pieces on the
+  // pool and merge. Same result as detect(); runs inline on a pool worker.
+  std::vector<EntityMention> detectParallel(std::string_view text,
+                                            core::exec::WorkStealingPool& pool = core::exec::WorkStealingPool::shared());
+
+  // detectPage() for every page, spread over the pool; results in input order. When
+  // total is set, it receives the heuristic counts of the whole batch. Blocks; must
+  // not be called from a worker of the same pool.
+  std::vector<std::vector<EntityMention>> detectPages(const std::vector<const core::extract::ExtractedPage*>& pages,
+                                                      EntityCounts* total = nullptr,
+                                                      core::exec::WorkStealingPool& pool = core::exec::WorkStealingPool::shared());
+
+  // Filtered candidate counts of one piece of text. Spans (if counts keeps them) are
+  // tagged with blockId and offset by base.
+  static void count(std::string_view text, EntityCounts& counts, std::string_view blockId = {}, std::size_t base = 0);
+  // Classifies and ranks a (possibly merged) table: the 30 most confident mentions.
+  std::vector<EntityMention> rank(const EntityCounts& counts) const;
+
+  // Runs of up to four capitalized tokens, in text order, as the former
+  // \b([A-Z][a-zA-Z\-']+)(\s+[A-Z][a-zA-Z\-']+){0,3}\b search found them, with the
+  // letter classes widened to Unicode for UTF-8 text ("Jürgen Müller", "Łódź"). On
+  // ASCII input the result is identical to the regex. Views into text.
+  static std::vector<std::string_view> candidates(std::string_view text);
 
 private:
   static bool looksLikePerson(const std::string& name);
-  static bool looksLikeOrg(const std::string& name);
-  static bool looksLikePlace(const std::string& name);
+  std::vector<EntityMention> pageMentions(const core::extract::ExtractedPage& page, const EntityCounts& counts) const;
 };
 
 std::string toString(EntityType t);
@@ -0,0 +1,251 @@
+#include "core/entities/EntityGraph.h"
+#include <algorithm>
+#include <deque>
+
+namespace core::entities {
+
+std::uint32_t EntityGraph::intern(std::string_view entityId) {
+  auto [it, fresh] = index_.try_emplace(std::string(entityId), std::uint32_t(ids_.size()));
+  if (fresh) ids_.emplace_back(entityId);
+  return it->second;
+}
+
+std::uint32_t EntityGraph::find(std::string_view entityId) const {
+  auto it = index_.find(std::string(entityId));
+  return it == index_.end() ? kNone : it->second;
+}
+
+std::uint16_t EntityGraph::internRelation(std::string_view relation) {
+  auto [it, fresh] = relationIndex_.try_emplace(std::string(relation), std::uint16_t(relations_.size()));
+  if (fresh) relations_.emplace_back(relation);
+  return it->second;
+}
+
+void EntityGraph::build(const std::vector<Edge>& edges) {
+  std::vector<Edge> directed;
+  directed.reserve(edges.size() * 2);
+  for (const auto& e : edges) {
+    if (e.a == e.b) continue;
+    directed.push_back(e);
+    directed.push_back({e.b, e.a, e.weight, e.relation});
+  }
+  delta_.clear();
+  deltaEdges_ = 0;
+  deadEdges_ = 0;
+  buildDirected(std::move(directed));
+}
+
+void EntityGraph::addEdge(std::uint32_t a, std::uint32_t b, float weight, std::uint16_t relation) {
+  if (a == b) return;
+  delta_[a].push_back({a, b, weight, relation});
+  delta_[b].push_back({b, a, weight, relation});
+  deltaEdges_ += 2;
+  if (deltaEdges_ > std::max<std::size_t>(4096, targets_.size() / 8)) compact();
+}
+
+void EntityGraph::removeEdge(std::uint32_t a, std::uint32_t b, float weight, std::uint16_t relation) {
+  if (a == b) return;
+  takeWeight(a, b, weight, relation);
+  takeWeight(b, a, weight, relation);
+  if (deadEdges_ > std::max<std::size_t>(4096, targets_.size() / 8)) compact();
+}
+
+void EntityGraph::takeWeight(std::uint32_t a, std::uint32_t b, float weight, std::uint16_t relation) {
+  const auto take = [&](float& w) {
+    if (weight <= 0 || w <= 0) return;
+    const float taken = std::min(w, weight);
+    w -= taken;
+    weight -= taken;
+    if (w <= 0) ++deadEdges_;
+  };
+  if (a + 1 < offsets_.size()) {
+    // A CSR row is sorted by target, then relation.
+    const auto first = targets_.begin() + std::ptrdiff_t(offsets_[a]);
+    const auto last = targets_.begin() + std::ptrdiff_t(offsets_[a + 1]);
+    for (auto it = std::lower_bound(first, last, b); it != last && *it == b; ++it) {
+      const std::size_t i = std::size_t(it - targets_.begin());
+      if (relationIds_[i] == relation) take(weights_[i]);
+    }
+  }
+  if (auto it = delta_.find(a); it != delta_.end()) {
+    for (auto& e : it->second) {
+      if (e.b == b && e.relation == relation) take(e.weight);
+    }
+  }
+}
+
+void EntityGraph::compact() {
+  if (deltaEdges_ == 0 && deadEdges_ == 0) return;
+  std::vector<Edge> directed;
+  directed.reserve(targets_.size() + deltaEdges_);
+  for (std::uint32_t n = 0; n + 1 < offsets_.size(); ++n) {
+    for (std::uint64_t i = offsets_[n]; i < offsets_[n + 1]; ++i) directed.push_back({n, targets_[i], weights_[i], relationIds_[i]});
+  }
+  for (const auto& [node, edges] : delta_) directed.insert(directed.end(), edges.begin(), edges.end());
+  delta_.clear();
+  deltaEdges_ = 0;
+  deadEdges_ = 0;
+  buildDirected(std::move(directed));
+}
+
+void EntityGraph::buildDirected(std::vector<Edge> directed) {
+  std::sort(directed.begin(), directed.end(), [](const Edge& x, const Edge& y) {
+    if (x.a != y.a) return x.a < y.a;
+    if (x.b != y.b) return x.b < y.b;
+    return x.relation < y.relation;
+  });
+
+  offsets_.assign(ids_.size() + 1, 0);
+  targets_.clear();
+  weights_.clear();
+  relationIds_.clear();
+  targets_.reserve(directed.size());
+  weights_.reserve(directed.size());
+  relationIds_.reserve(directed.size());
+  for (std::size_t i = 0; i < directed.size(); ) {
+    const Edge& e = directed[i];
+    float weight = 0;
+    std::size_t j = i;
+    for (; j < directed.size() && directed[j].a == e.a && directed[j].b == e.b && directed[j].relation == e.relation; ++j) {
+      weight += directed[j].weight;
+    }
+    if (weight <= 0) {
+      i = j;
+      continue;
+    }
+    ++offsets_[e.a + 1];
+    targets_.push_back(e.b);
+    weights_.push_back(weight);
+    relationIds_.push_back(e.relation);
+    i = j;
+  }
+  for (std::size_t n = 1; n < offsets_.size(); ++n) offsets_[n] += offsets_[n - 1];
+}
+
+double EntityGraph::weightedDegree(std::uint32_t node) const {
+  double sum = 0;
+  forEachNeighbor(node, [&](std::uint32_t, float w, std::uint16_t) { sum += w; });
+  return sum;
+}
+
+std::vector<std::pair<std::uint32_t, int>> EntityGraph::kHop(std::uint32_t source, int k, std::size_t maxNodes) const {
+  std::vector<std::pair<std::uint32_t, int>> out;
+  if (source >= ids_.size() || maxNodes == 0) return out;
+  std::unordered_map<std::uint32_t, int> seen{{source, 0}};
+  out.push_back({source, 0});
+  // out doubles as the BFS queue: entries are appended in distance order.
+  for (std::size_t head = 0; head < out.size() && out.size() < maxNodes; ++head) {
+    const auto [node, dist] = out[head];
+    if (dist >= k) break;
+    forEachNeighbor(node, [&](std::uint32_t v, float, std::uint16_t) {
+      if (out.size() >= maxNodes || !seen.try_emplace(v, dist + 1).second) return;
+      out.push_back({v, dist + 1});
+    });
+  }
+  return out;
+}
+
+std::vector<std::uint32_t> EntityGraph::shortestPath(std::uint32_t a, std::uint32_t b, int maxHops) const {
+  if (a >= ids_.size() || b >= ids_.size()) return {};
+  if (a == b) return {a};
+
+  // Bidirectional BFS, always widening the smaller frontier.
+  std::unordered_map<std::uint32_t, std::uint32_t> fromA{{a, a}}, fromB{{b, b}};
+  std::vector<std::uint32_t> frontA{a}, frontB{b}, next;
+  std::uint32_t meet = kNone;
+  for (int hops = 0; hops < maxHops && meet == kNone && !frontA.empty() && !frontB.empty(); ++hops) {
+    const bool sideA = frontA.size() <= frontB.size();
+    auto& front = sideA ? frontA : frontB;
+    auto& own = sideA ? fromA : fromB;
+    const auto& other = sideA ? fromB : fromA;
+    next.clear();
+    for (auto u : front) {
+      forEachNeighbor(u, [&](std::uint32_t v, float, std::uint16_t) {
+        if (meet != kNone || !own.try_emplace(v, u).second) return;
+        if (other.count(v)) meet = v;
+        next.push_back(v);
+      });
+      if (meet != kNone) break;
+    }
+    front.swap(next);
+  }
+  if (meet == kNone) return {};
+
+  std::vector<std::uint32_t> path;
+  for (auto n = meet; ; n = fromA.at(n)) {
+    path.push_back(n);
+    if (n == a) break;
+  }
+  std::reverse(path.begin(), path.end());
+  for (auto n = meet; n != b; ) {
+    n = fromB.at(n);
+    path.push_back(n);
+  }
+  return path;
+}
+
+std::vector<std::pair<std::uint32_t, double>> EntityGraph::personalizedPageRank(
+    const std::vector<std::uint32_t>& seeds, std::size_t topK, double alpha, double epsilon) const {
+  struct State {
+    double p = 0;
+    double r = 0;
+    double degree = -1;
+    bool queued = false;
+  };
+  std::unordered_map<std::uint32_t, State> state;
+  std::deque<std::uint32_t> queue;
+  auto degreeOf = [&](std::uint32_t n, State& s) {
+    if (s.degree < 0) s.degree = weightedDegree(n);
+    return s.degree;
+  };
+
+  std::size_t seedCount = 0;
+  for (auto s : seeds) seedCount += s < ids_.size();
+  if (seedCount == 0) return {};
+  for (auto s : seeds) {
+    if (s >= ids_.size()) continue;
+    State& st = state[s];
+    st.r += 1.0 / double(seedCount);
+    if (!st.queued) { st.queued = true; queue.push_back(s); }
+  }
+
+  // Bounded so a tiny epsilon on a huge component cannot stall the caller.
+  constexpr std::size_t kMaxPushes = std::size_t(1) << 20;
+  for (std::size_t pushes = 0; !queue.empty() && pushes < kMaxPushes; ++pushes) {
+    const std::uint32_t u = queue.front();
+    queue.pop_front();
+    State& su = state[u];
+    su.queued = false;
+    const double degree = degreeOf(u, su);
+    const double mass = su.r;
+    su.r = 0;
+    if (degree <= 0) {
+      su.p += mass; // dangling: the walk restarts, keep the mass here
+      continue;
+    }
+    su.p += alpha * mass;
+    const double share = (1 - alpha) * mass / degree;
+    forEachNeighbor(u, [&](std::uint32_t v, float w, std::uint16_t) {
+      State& sv = state[v];
+      sv.r += share * w;
+      if (!sv.queued && sv.r > epsilon * degreeOf(v, sv)) {
+        sv.queued = true;
+        queue.push_back(v);
+      }
+    });
+  }
+
+  std::vector<std::pair<std::uint32_t, double>> out;
+  out.reserve(state.size());
+  for (const auto& [n, s] : state) {
+    if (s.p > 0) out.push_back({n, s.p});
+  }
+  const std::size_t keep = std::min(topK, out.size());
+  std::partial_sort(out.begin(), out.begin() + keep, out.end(), [](const auto& x, const auto& y) {
+    return x.second != y.second ? x.second > y.second : x.first < y.first;
+  });
+  out.resize(keep);
+  return out;
+}
+
+} // namespace core::entities
@@ -0,0 +1,96 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace core::entities {
+
+// Undirected, weighted entity graph in compressed sparse row form: one offsets array
+// and parallel target/weight/relation arrays, about 10 bytes per edge direction.
+// Edges added after the last compact() sit in a small per-node delta that queries
+// read alongside the CSR rows; it is folded in once it grows past an eighth of the
+// base graph. Parallel edges (same ends and relation) merge by adding weights; an
+// edge whose weight drops to zero is gone. Removal subtracts in place, and queries
+// skip emptied entries until the next compact() drops them.
+//
+// Not thread-safe; queries are const and may run concurrently only while no edges
+// are being added.
+class EntityGraph {
+public:
+  static constexpr std::uint32_t kNone = ~std::uint32_t(0);
+
+  struct Edge {
+    std::uint32_t a;
+    std::uint32_t b;
+    float weight;
+    std::uint16_t relation;
+  };
+
+  std::uint32_t intern(std::string_view entityId);
+  std::uint32_t find(std::string_view entityId) const; // kNone if unknown
+  const std::string& entityId(std::uint32_t node) const { return ids_[node]; }
+  std::uint16_t internRelation(std::string_view relation);
+  const std::string& relationName(std::uint16_t relation) const { return relations_[relation]; }
+
+  // Replaces all edges; the bulk path used when loading.
+  void build(const std::vector<Edge>& edges);
+  void addEdge(std::uint32_t a, std::uint32_t b, float weight, std::uint16_t relation);
+  // Takes weight off an existing edge (CSR row first, then delta), never below zero.
+  void removeEdge(std::uint32_t a, std::uint32_t b, float weight, std::uint16_t relation);
+  void compact();
+
+  std::size_t nodeCount() const { return ids_.size(); }
+  // Edge directions stored, CSR plus delta.
+  std::size_t edgeCount() const { return targets_.size() + deltaEdges_ - deadEdges_; }
+
+  template <class F>
+  void forEachNeighbor(std::uint32_t node, F&& f) const {
+    if (node + 1 < offsets_.size()) {
+      for (std::uint64_t i = offsets_[node]; i < offsets_[node + 1]; ++i) {
+        if (weights_[i] > 0) f(targets_[i], weights_[i], relationIds_[i]);
+      }
+    }
+    if (auto it = delta_.find(node); it != delta_.end()) {
+      for (const auto& e : it->second) {
+        if (e.weight > 0) f(e.b, e.weight, e.relation);
+      }
+    }
+  }
+
+  // Nodes within k hops of source (source included at distance 0), nearest first, at
+  // most maxNodes of them.
+  std::vector<std::pair<std::uint32_t, int>> kHop(std::uint32_t source, int k, std::size_t maxNodes) const;
+  // Fewest-hop path from a to b (both ends included); empty if none within maxHops.
+  std::vector<std::uint32_t> shortestPath(std::uint32_t a, std::uint32_t b, int maxHops = 6) const;
+  // Personalized PageRank restarting at seeds, by local forward push: only nodes whose
+  // residual exceeds epsilon times their weighted degree are visited, so the cost
+  // depends on the neighbourhood, not the graph. Highest score first, at most topK.
+  std::vector<std::pair<std::uint32_t, double>> personalizedPageRank(const std::vector<std::uint32_t>& seeds,
+                                                                     std::size_t topK, double alpha = 0.15,
+                                                                     double epsilon = 1e-5) const;
+
+private:
+  std::vector<std::string> ids_;
+  std::unordered_map<std::string, std::uint32_t> index_;
+  std::vector<std::string> relations_;
+  std::unordered_map<std::string, std::uint16_t> relationIndex_;
+
+  std::vector<std::uint64_t> offsets_;
+  std::vector<std::uint32_t> targets_;
+  std::vector<float> weights_;
+  std::vector<std::uint16_t> relationIds_;
+
+  std::unordered_map<std::uint32_t, std::vector<Edge>> delta_;
+  std::size_t deltaEdges_ = 0;
+  std::size_t deadEdges_ = 0; // emptied by removeEdge, CSR or delta, not yet dropped
+
+  void buildDirected(std::vector<Edge> directed);
+  void takeWeight(std::uint32_t a, std::uint32_t b, float weight, std::uint16_t relation);
+  double weightedDegree(std::uint32_t node) const;
+};
+
+} // namespace core::entities
@@ -0,0 +1,436 @@
+#include "core/entities/Gazetteer.h"
+#include "util/Hash.h"
+#include "util/Log.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace core::entities {
+
+namespace {
+
+constexpr char kMagic[4] = {'N', 'V', 'G', 'Z'};
+constexpr std::uint32_t kVersion = 1;
+
+bool isTokenByte(unsigned char c) {
+  return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c >= 0x80;
+}
+
+std::size_t align4(std::size_t n) { return (n + 3) & ~std::size_t(3); }
+
+bool categoryForFile(const std::string& name, GazetteerCategory& out) {
+  if (name.size() < 4 || name.compare(name.size() - 4, 4, ".txt") != 0) return false;
+  if (name.rfind("org", 0) == 0) { out = GazetteerCategory::Org; return true; }
+  if (name.rfind("place", 0) == 0) { out = GazetteerCategory::Place; return true; }
+  return false;
+}
+
+// Dictionary files in dir, sorted by name.
+std::vector<fs::path> dictionaryFiles(const std::string& dir) {
+  std::vector<fs::path> files;
+  std::error_code ec;
+  for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+    GazetteerCategory c;
+    if (it->is_regular_file(ec) && categoryForFile(it->path().filename().string(), c)) files.push_back(it->path());
+  }
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+} // namespace
+
+struct Gazetteer::Header {
+  char magic[4];
+  std::uint32_t version;
+  std::uint32_t nodeCount;
+  std::uint32_t edgeCount;
+  std::uint32_t outputCount;
+  std::uint32_t reserved;
+  std::uint64_t stamp;
+};
+
+struct Gazetteer::Node {
+  std::uint32_t edgeFirst;
+  std::uint32_t edgeCount;
+  std::uint32_t fail;     // longest proper suffix that is also a trie path
+  std::uint32_t dict;     // nearest suffix node with outputs, 0 = none
+  std::uint32_t outFirst;
+  std::uint32_t outCount;
+};
+
+struct Gazetteer::Output {
+  std::uint32_t length;
+  std::uint32_t category;
+};
+
+// ---- builder ----
+
+void GazetteerBuilder::add(std::string_view term, GazetteerCategory category) {
+  if (term.empty()) return;
+  terms_.push_back({std::string(term), category});
+}
+
+void GazetteerBuilder::addLines(std::string_view text, GazetteerCategory category) {
+  while (!text.empty()) {
+    const std::size_t nl = text.find('\n');
+    std::string_view line = text.substr(0, nl);
+    text = nl == std::string_view::npos ? std::string_view() : text.substr(nl + 1);
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) line.remove_suffix(1);
+    while (!line.empty() && (line.front() == ' ' || line.front() == '\t')) line.remove_prefix(1);
+    if (line.empty() || line.front() == '#') continue;
+    add(line, category);
+  }
+}
+
+void GazetteerBuilder::addBuiltins() {
+  for (const char* t : {"Inc", "Corp", "LLC", "Ltd", "GmbH", "AG", "University", "Institute", "Company", "Bank", "Group"}) {
+    add(t, GazetteerCategory::Org);
+  }
+  for (const char* t : {"City", "State", "Province", "County", "Berlin", "London", "Paris", "New York", "Munich", "Hamburg"}) {
+    add(t, GazetteerCategory::Place);
+  }
+}
+
+std::string GazetteerBuilder::compile(std::uint64_t stamp) const {
+  struct BNode {
+    std::vector<std::pair<std::uint8_t, std::uint32_t>> edges; // sorted by byte
+    std::uint32_t fail = 0;
+    std::uint32_t dict = 0;
+    std::vector<Gazetteer::Output> outs;
+  };
+  std::vector<BNode> trie(1);
+  auto child = [&](std::uint32_t n, std::uint8_t c) -> std::uint32_t {
+    auto& e = trie[n].edges;
+    auto it = std::lower_bound(e.begin(), e.end(), std::make_pair(c, std::uint32_t(0)));
+    return (it != e.end() && it->first == c) ? it->second : 0;
+  };
+
+  std::set<std::pair<std::string, GazetteerCategory>> seen;
+  for (const auto& t : terms_) {
+    if (!seen.insert({t.text, t.category}).second) continue;
+    std::uint32_t n = 0;
+    for (unsigned char c : t.text) {
+      std::uint32_t next = child(n, c);
+      if (!next) {
+        next = (std::uint32_t)trie.size();
+        auto& e = trie[n].edges;
+        e.insert(std::lower_bound(e.begin(), e.end(), std::make_pair(c, std::uint32_t(0))), {c, next});
+        trie.emplace_back();
+      }
+      n = next;
+    }
+    trie[n].outs.push_back({(std::uint32_t)t.text.size(), (std::uint32_t)t.category});
+  }
+
+  // Breadth-first: fail links, then renumber so that fail and dict always point to
+  // lower ids (the loader relies on this to rule out cycles).
+  std::vector<std::uint32_t> order;
+  order.reserve(trie.size());
+  std::deque<std::uint32_t> queue{0};
+  while (!queue.empty()) {
+    const std::uint32_t u = queue.front();
+    queue.pop_front();
+    order.push_back(u);
+    for (auto [c, v] : trie[u].edges) {
+      if (u != 0) {
+        std::uint32_t f = trie[u].fail;
+        while (f != 0 && !child(f, c)) f = trie[f].fail;
+        trie[v].fail = child(f, c);
+      }
+      const std::uint32_t f = trie[v].fail;
+      trie[v].dict = trie[f].outs.empty() ? trie[f].dict : f;
+      queue.push_back(v);
+    }
+  }
+  std::vector<std::uint32_t> id(trie.size());
+  for (std::uint32_t i = 0; i < order.size(); ++i) id[order[i]] = i;
+
+  std::size_t edgeCount = 0;
+  std::size_t outputCount = 0;
+  for (const auto& n : trie) {
+    edgeCount += n.edges.size();
+    outputCount += n.outs.size();
+  }
+
+  Gazetteer::Header h{};
+  std::memcpy(h.magic, kMagic, 4);
+  h.version = kVersion;
+  h.nodeCount = (std::uint32_t)trie.size();
+  h.edgeCount = (std::uint32_t)edgeCount;
+  h.outputCount = (std::uint32_t)outputCount;
+  h.stamp = stamp;
+
+  std::uint32_t rootNext[256] = {};
+  for (auto [c, v] : trie[0].edges) rootNext[c] = id[v];
+  std::vector<Gazetteer::Node> nodes;
+  std::vector<std::uint32_t> targets;
+  std::vector<std::uint8_t> bytes;
+  std::vector<Gazetteer::Output> outputs;
+  nodes.reserve(trie.size());
+  targets.reserve(edgeCount);
+  bytes.reserve(align4(edgeCount));
+  outputs.reserve(outputCount);
+  for (std::uint32_t old : order) {
+    const BNode& b = trie[old];
+    nodes.push_back({(std::uint32_t)targets.size(), (std::uint32_t)b.edges.size(), id[b.fail],
+                     b.dict ? id[b.dict] : 0, (std::uint32_t)outputs.size(), (std::uint32_t)b.outs.size()});
+    for (auto [c, v] : b.edges) {
+      bytes.push_back(c);
+      targets.push_back(id[v]);
+    }
+    outputs.insert(outputs.end(), b.outs.begin(), b.outs.end());
+  }
+  bytes.resize(align4(bytes.size()), 0);
+
+  std::string image;
+  auto put = [&](const void* p, std::size_t n) { image.append(static_cast<const char*>(p), n); };
+  put(&h, sizeof h);
+  put(rootNext, sizeof rootNext);
+  put(nodes.data(), nodes.size() * sizeof(Gazetteer::Node));
+  put(targets.data(), targets.size() * sizeof(std::uint32_t));
+  put(bytes.data(), bytes.size());
+  put(outputs.data(), outputs.size() * sizeof(Gazetteer::Output));
+  return image;
+}
+
+// ---- automaton ----
+
+Gazetteer::Gazetteer() {
+  GazetteerBuilder b;
+  b.addBuiltins();
+  loadImage(b.compile());
+}
+
+bool Gazetteer::loadImage(std::string image) {
+  std::string previous = std::move(owned_);
+  owned_ = std::move(image);
+  if (bind(reinterpret_cast<const unsigned char*>(owned_.data()), owned_.size())) {
+    mapped_.close();
+    return true;
+  }
+  owned_ = std::move(previous);
+  return false;
+}
+
+bool Gazetteer::loadFile(const std::string& path) {
+  util::MappedFile file;
+  if (!file.open(path)) return false;
+  // bind() leaves the current image in place when the new one does not validate.
+  if (!bind(file.data(), file.size())) {
+    util::Log::warn("Gazetteer: invalid image " + path);
+    return false;
+  }
+  mapped_ = std::move(file);
+  owned_.clear();
+  owned_.shrink_to_fit();
+  return true;
+}
+
+bool Gazetteer::bind(const unsigned char* data, std::size_t size) {
+  if (size < sizeof(Header)) return false;
+  const auto* h = reinterpret_cast<const Header*>(data);
+  if (std::memcmp(h->magic, kMagic, 4) != 0 || h->version != kVersion || h->nodeCount == 0) return false;
+
+  const std::uint64_t rootOff = sizeof(Header);
+  const std::uint64_t nodesOff = rootOff + 256 * sizeof(std::uint32_t);
+  const std::uint64_t targetsOff = nodesOff + std::uint64_t(h->nodeCount) * sizeof(Node);
+  const std::uint64_t bytesOff = targetsOff + std::uint64_t(h->edgeCount) * sizeof(std::uint32_t);
+  const std::uint64_t outputsOff = bytesOff + align4(h->edgeCount);
+  const std::uint64_t total = outputsOff + std::uint64_t(h->outputCount) * sizeof(Output);
+  if (total != size) return false;
+
+  const auto* root = reinterpret_cast<const std::uint32_t*>(data + rootOff);
+  const auto* nodes = reinterpret_cast<const Node*>(data + nodesOff);
+  const auto* targets = reinterpret_cast<const std::uint32_t*>(data + targetsOff);
+  const auto* outputs = reinterpret_cast<const Output*>(data + outputsOff);
+
+  // One linear check so scan() never needs bounds tests. fail/dict pointing to lower
+  // ids (breadth-first order) guarantees the fail walk terminates. Every edge leads one
+  // level down to a higher id and depth never decreases with id, so the automaton is
+  // never deeper than the bytes it has read, and an output no longer than its node's
+  // depth cannot start before the text.
+  for (int c = 0; c < 256; ++c) {
+    if (root[c] >= h->nodeCount) return false;
+  }
+  for (std::uint32_t i = 0; i < h->edgeCount; ++i) {
+    if (targets[i] == 0 || targets[i] >= h->nodeCount) return false;
+  }
+  constexpr std::uint32_t kUnreached = ~std::uint32_t(0);
+  std::vector<std::uint32_t> depth(h->nodeCount, kUnreached);
+  depth[0] = 0;
+  for (std::uint32_t i = 0; i < h->nodeCount; ++i) {
+    const Node& n = nodes[i];
+    if (std::uint64_t(n.edgeFirst) + n.edgeCount > h->edgeCount) return false;
+    if (std::uint64_t(n.outFirst) + n.outCount > h->outputCount) return false;
+    if (i > 0 && (n.fail >= i || n.dict >= i)) return false;
+    if (i == 0 && n.outCount != 0) return false;
+    if (depth[i] == kUnreached || (i > 0 && depth[i] < depth[i - 1])) return false;
+    for (std::uint32_t k = 0; k < n.edgeCount; ++k) {
+      const std::uint32_t t = targets[n.edgeFirst + k];
+      if (t <= i || depth[t] != kUnreached) return false;
+      depth[t] = depth[i] + 1;
+    }
+    for (std::uint32_t k = 0; k < n.outCount; ++k) {
+      if (outputs[n.outFirst + k].length > depth[i]) return false;
+    }
+  }
+  for (int c = 0; c < 256; ++c) {
+    if (root[c] != 0 && depth[root[c]] != 1) return false;
+  }
+  for (std::uint32_t i = 0; i < h->outputCount; ++i) {
+    if (outputs[i].length == 0 || (outputs[i].category != (std::uint32_t)GazetteerCategory::Org
+                                   && outputs[i].category != (std::uint32_t)GazetteerCategory::Place)) {
+      return false;
+    }
+  }
+
+  header_ = h;
+  rootNext_ = root;
+  nodes_ = nodes;
+  edgeTarget_ = targets;
+  edgeByte_ = data + bytesOff;
+  outputs_ = outputs;
+  return true;
+}
+
+std::uint64_t Gazetteer::stamp() const { return header_ ? header_->stamp : 0; }
+std::size_t Gazetteer::nodeCount() const { return header_ ? header_->nodeCount : 0; }
+
+std::uint32_t Gazetteer::next(std::uint32_t state, std::uint8_t c) const {
+  for (;;) {
+    if (state == 0) return rootNext_[c];
+    const Node& n = nodes_[state];
+    const std::uint8_t* first = edgeByte_ + n.edgeFirst;
+    const std::uint8_t* last = first + n.edgeCount;
+    const std::uint8_t* it = std::lower_bound(first, last, c);
+    if (it != last && *it == c) return edgeTarget_[it - edgeByte_];
+    state = n.fail;
+  }
+}
+
+void Gazetteer::scan(std::string_view text, std::vector<GazetteerMatch>& out) const {
+  if (!header_) return;
+  const auto* p = reinterpret_cast<const unsigned char*>(text.data());
+  const std::size_t n = text.size();
+  std::uint32_t s = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    s = next(s, p[i]);
+    const std::size_t end = i + 1;
+    if (end < n && isTokenByte(p[end])) continue; // no match can end inside a token
+    for (std::uint32_t o = nodes_[s].outCount ? s : nodes_[s].dict; o != 0; o = nodes_[o].dict) {
+      const Node& node = nodes_[o];
+      for (std::uint32_t k = 0; k < node.outCount; ++k) {
+        const Output& hit = outputs_[node.outFirst + k];
+        const std::size_t begin = end - hit.length;
+        if (begin > 0 && isTokenByte(p[begin - 1])) continue;
+        out.push_back({begin, end, (GazetteerCategory)hit.category});
+      }
+    }
+  }
+}
+
+bool Gazetteer::classify(std::string_view name, GazetteerCategory& out) const {
+  std::vector<GazetteerMatch> matches;
+  scan(name, matches);
+  bool place = false;
+  for (const auto& m : matches) {
+    if (m.end != name.size()) continue;
+    if (m.category == GazetteerCategory::Org) {
+      out = GazetteerCategory::Org;
+      return true;
+    }
+    place = place || m.begin == 0;
+  }
+  if (place) out = GazetteerCategory::Place;
+  return place;
+}
+
+// ---- dictionaries ----
+
+std::uint64_t Gazetteer::dictionaryStamp(const std::string& dir) {
+  const auto files = dictionaryFiles(dir);
+  if (files.empty()) return 0;
+  std::string key = "v" + std::to_string(kVersion);
+  for (const auto& f : files) {
+    std::error_code ec;
+    const auto size = fs::file_size(f, ec);
+    const auto mtime = fs::last_write_time(f, ec).time_since_epoch().count();
+    key += "|" + f.filename().string() + ":" + std::to_string(size) + ":" + std::to_string(mtime);
+  }
+  const std::uint64_t h = util::xxh64(key);
+  return h ? h : 1;
+}
+
+bool Gazetteer::compileIfStale(const std::string& dir, const std::string& imagePath) {
+  const std::uint64_t stamp = dictionaryStamp(dir);
+  {
+    // With no text dictionaries, any valid image (e.g. one shipped precompiled) is current.
+    Gazetteer current;
+    if (current.loadFile(imagePath) && (stamp == 0 || current.stamp() == stamp)) return true;
+  }
+
+  GazetteerBuilder b;
+  b.addBuiltins();
+  for (const auto& f : dictionaryFiles(dir)) {
+    GazetteerCategory c;
+    categoryForFile(f.filename().string(), c);
+    std::ifstream in(f, std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    b.addLines(ss.str(), c);
+  }
+  const std::string image = b.compile(stamp);
+
+  const std::string tmp = imagePath + ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    out.write(image.data(), (std::streamsize)image.size());
+    if (!out) {
+      util::Log::warn("Gazetteer: cannot write " + tmp);
+      return false;
+    }
+  }
+  std::error_code ec;
+  fs::rename(tmp, imagePath, ec);
+  if (ec) {
+    util::Log::warn("Gazetteer: cannot replace " + imagePath + ": " + ec.message());
+    fs::remove(tmp, ec);
+    return false;
+  }
+  util::Log::info("Gazetteer: compiled " + std::to_string(b.termCount()) + " terms into " + imagePath);
+  return true;
+}
+
+static std::mutex& sharedMu() {
+  static std::mutex mu;
+  return mu;
+}
+
+static std::shared_ptr<const Gazetteer>& sharedSlot() {
+  static std::shared_ptr<const Gazetteer> g = std::make_shared<Gazetteer>();
+  return g;
+}
+
+std::shared_ptr<const Gazetteer> Gazetteer::shared() {
+  std::lock_guard<std::mutex> lk(sharedMu());
+  return sharedSlot();
+}
+
+bool Gazetteer::loadShared(const std::string& dictDir, const std::string& imagePath) {
+  if (!compileIfStale(dictDir, imagePath)) return false;
+  auto g = std::make_shared<Gazetteer>();
+  if (!g->loadFile(imagePath)) return false;
+  util::Log::info("Gazetteer: " + std::to_string(g->nodeCount()) + " states mapped from " + imagePath);
+  std::lock_guard<std::mutex> lk(sharedMu());
+  sharedSlot() = std::move(g);
+  return true;
+}
+
+} // namespace core::entities
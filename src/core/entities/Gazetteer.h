@@ -0,0 +1,107 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "util/MappedFile.h"
+
+namespace core::entities {
+
+enum class GazetteerCategory : std::uint8_t { Org = 1, Place = 2 };
+
+struct GazetteerMatch {
+  std::size_t begin = 0;
+  std::size_t end = 0;
+  GazetteerCategory category = GazetteerCategory::Org;
+};
+
+// Collects dictionary terms and compiles them into an Aho-Corasick automaton image
+// (see Gazetteer for the layout).
+class GazetteerBuilder {
+public:
+  void add(std::string_view term, GazetteerCategory category);
+  // One term per line; blank lines and lines starting with '#' are skipped.
+  void addLines(std::string_view text, GazetteerCategory category);
+  // The lists EntityDetector used to hard-code.
+  void addBuiltins();
+
+  std::size_t termCount() const { return terms_.size(); }
+  std::string compile(std::uint64_t stamp = 0) const;
+
+private:
+  struct Term {
+    std::string text;
+    GazetteerCategory category;
+  };
+  std::vector<Term> terms_;
+};
+
+// Dictionary matcher for organisation and place names over a precompiled, read-only
+// Aho-Corasick automaton. Every term is found in one pass over the text, so lookup
+// cost depends on the text length, not the dictionary size. Matching is byte-wise and
+// case-sensitive; a match only counts when it starts and ends on token boundaries
+// (ASCII letters, digits and UTF-8 bytes are token characters).
+//
+// Image layout (host byte order, 4-byte aligned sections):
+//   Header | u32 rootNext[256] | Node nodes[nodeCount] | u32 edgeTarget[edgeCount]
+//   | u8 edgeByte[edgeCount] (padded) | Output outputs[outputCount]
+// Node edges are sorted by byte; node 0 is the root and uses the direct table.
+//
+// Dictionaries are plain text files named org*.txt or place*.txt in a directory;
+// compileIfStale() turns them into an image that is then memory-mapped, so updated
+// dictionaries ship without a rebuild.
+class Gazetteer {
+public:
+  // Built-in lists only.
+  Gazetteer();
+
+  // Adopts an image held in memory / maps an image file. False if it does not validate.
+  bool loadImage(std::string image);
+  bool loadFile(const std::string& path);
+
+  // Stamp the image was compiled with (see dictionaryStamp).
+  std::uint64_t stamp() const;
+  std::size_t nodeCount() const;
+
+  // All token-bounded matches in text order of their end offset.
+  void scan(std::string_view text, std::vector<GazetteerMatch>& out) const;
+  // Org when an org term ends the name ("Acme GmbH", "Deutsche Bank"); Place only when
+  // a place term is the whole name, so "Paris Hilton" and "Chad Smith" stay unknown
+  // here. Org wins over Place. False when neither applies.
+  bool classify(std::string_view name, GazetteerCategory& out) const;
+
+  // Hash of the names, sizes and modification times of the dictionary files in dir;
+  // 0 when there are none.
+  static std::uint64_t dictionaryStamp(const std::string& dir);
+  // Recompiles dir's dictionaries (plus the built-ins) into imagePath unless the image
+  // there already carries the current stamp.
+  static bool compileIfStale(const std::string& dir, const std::string& imagePath);
+
+  // Process-wide instance used by EntityDetector. Starts with the built-ins;
+  // loadShared() replaces it once the data directory is known.
+  static std::shared_ptr<const Gazetteer> shared();
+  static bool loadShared(const std::string& dictDir, const std::string& imagePath);
+
+  struct Header;
+  struct Node;
+  struct Output;
+
+private:
+  std::string owned_;
+  util::MappedFile mapped_;
+
+  const Header* header_ = nullptr;
+  const std::uint32_t* rootNext_ = nullptr;
+  const Node* nodes_ = nullptr;
+  const std::uint32_t* edgeTarget_ = nullptr;
+  const std::uint8_t* edgeByte_ = nullptr;
+  const Output* outputs_ = nullptr;
+
+  bool bind(const unsigned char* data, std::size_t size);
+  std::uint32_t next(std::uint32_t state, std::uint8_t c) const;
+};
+
+} // namespace core::entities
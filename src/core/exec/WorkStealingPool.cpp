@@ -0,0 +1,111 @@
+#include "core/exec/WorkStealingPool.h"
+#include <algorithm>
+
+namespace core::exec {
+
+namespace {
+thread_local const WorkStealingPool* t_pool = nullptr;
+thread_local std::size_t t_index = 0;
+}
+
+WorkStealingPool::WorkStealingPool(std::size_t workers)
+  : pending_(0), nextQueue_(0), stop_(false) {
+  if (workers == 0) workers = std::max(1u, std::thread::hardware_concurrency());
+  queues_.reserve(workers);
+  for (std::size_t i = 0; i < workers; ++i) queues_.push_back(std::make_unique<Queue>());
+  workers_.reserve(workers);
+  for (std::size_t i = 0; i < workers; ++i) {
+    workers_.emplace_back([this, i]() { workerLoop(i); });
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lk(sleepMu_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& t : workers_) {
+    if (t.joinable()) t.join();
+  }
+}
+
+WorkStealingPool& WorkStealingPool::shared() {
+  static WorkStealingPool pool;
+  return pool;
+}
+
+bool WorkStealingPool::isWorkerThread() const {
+  return t_pool == this;
+}
+
+void WorkStealingPool::push(std::size_t queue, Task task) {
+  // Count first so a worker that grabs the task right away never sees pending_ underflow.
+  pending_.fetch_add(1, std::memory_order_release);
+  std::lock_guard<std::mutex> lk(queues_[queue]->mu);
+  queues_[queue]->tasks.push_back(std::move(task));
+}
+
+void WorkStealingPool::submit(Task task) {
+  // Work spawned by a worker stays on its own deque; external work is spread round-robin.
+  std::size_t q = isWorkerThread() ? t_index : nextQueue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+  push(q, std::move(task));
+  {
+    std::lock_guard<std::mutex> lk(sleepMu_);
+  }
+  wake_.notify_one();
+}
+
+void WorkStealingPool::submitBulk(std::vector<Task> tasks) {
+  if (tasks.empty()) return;
+  std::size_t start = nextQueue_.fetch_add(tasks.size(), std::memory_order_relaxed);
+  for (std::size_t i = 0; i < tasks.size(); ++i) {
+    push((start + i) % queues_.size(), std::move(tasks[i]));
+  }
+  {
+    std::lock_guard<std::mutex> lk(sleepMu_);
+  }
+  wake_.notify_all();
+}
+
+bool WorkStealingPool::popLocal(std::size_t index, Task& out) {
+  Queue& q = *queues_[index];
+  std::lock_guard<std::mutex> lk(q.mu);
+  if (q.tasks.empty()) return false;
+  out = std::move(q.tasks.back());
+  q.tasks.pop_back();
+  return true;
+}
+
+bool WorkStealingPool::steal(std::size_t thief, Task& out) {
+  const std::size_t n = queues_.size();
+  for (std::size_t k = 1; k < n; ++k) {
+    Queue& q = *queues_[(thief + k) % n];
+    std::lock_guard<std::mutex> lk(q.mu);
+    if (q.tasks.empty()) continue;
+    out = std::move(q.tasks.front());
+    q.tasks.pop_front();
+    return true;
+  }
+  return false;
+}
+
+void WorkStealingPool::workerLoop(std::size_t index) {
+  t_pool = this;
+  t_index = index;
+
+  for (;;) {
+    Task task;
+    if (popLocal(index, task) || steal(index, task)) {
+      pending_.fetch_sub(1, std::memory_order_acq_rel);
+      task(index);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lk(sleepMu_);
+    wake_.wait(lk, [this]() { return stop_ || pending_.load(std::memory_order_acquire) > 0; });
+    if (stop_ && pending_.load(std::memory_order_acquire) == 0) return;
+  }
+}
+
+} // namespace core::exec
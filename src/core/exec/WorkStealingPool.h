@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace core::exec {
+
+// Fixed-size worker pool with one task deque per worker. A worker pops its own
+// queue from the back (LIFO, cache-warm) and steals from the front of the other
+// queues when it runs dry. Tasks receive the index of the worker running them so
+// callers can keep per-worker state without locking.
+class WorkStealingPool {
+public:
+  using Task = std::function<void(std::size_t workerIndex)>;
+
+  explicit WorkStealingPool(std::size_t workers = 0); // 0 = hardware concurrency
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+  std::size_t size() const { return workers_.size(); }
+
+  void submit(Task task);
+  void submitBulk(std::vector<Task> tasks);
+
+  // True when called from one of this pool's worker threads.
+  bool isWorkerThread() const;
+
+  // Process-wide pool sized to the machine.
+  static WorkStealingPool& shared();
+
+private:
+  struct Queue {
+    std::mutex mu;
+    std::deque<Task> tasks;
+  };
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+
+  std::mutex sleepMu_;
+  std::condition_variable wake_;
+  std::atomic<std::size_t> pending_;
+  std::atomic<std::size_t> nextQueue_;
+  bool stop_;
+
+  void workerLoop(std::size_t index);
+  bool popLocal(std::size_t index, Task& out);
+  bool steal(std::size_t thief, Task& out);
+  void push(std::size_t queue, Task task);
+};
+
+} // namespace core::exec
@@ -0,0 +1,107 @@
+#include "core/extract/BatchExtractor.h"
+#include "util/Log.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+namespace core::extract {
+
+namespace {
+
+struct BatchState {
+  std::mutex mu;
+  std::condition_variable done;
+  std::size_t remaining = 0;
+
+  // Ordered delivery: finished items wait here until all earlier ones went out.
+  std::vector<char> finished;
+  std::size_t nextOut = 0;
+};
+
+} // namespace
+
+BatchExtractor::BatchExtractor(core::exec::WorkStealingPool& pool)
+  : pool_(pool) {
+  workers_.resize(pool_.size());
+}
+
+BatchStats BatchExtractor::extractBatch(const std::vector<BatchDocument>& docs,
+                                        BatchDelivery delivery,
+                                        const BatchResultFn& onResult) {
+  std::size_t bytes = 0;
+  for (const auto& d : docs) bytes += d.html.size();
+
+  // Each page is written by one worker and handed over (under the batch lock) once.
+  std::vector<ExtractedPage> pages(docs.size());
+  return fanOut(pool_, docs.size(), bytes, delivery,
+                [this, &docs, &pages](std::size_t i, std::size_t worker) {
+                  pages[i] = workers_[worker].extract(docs[i].html, docs[i].baseUrl);
+                },
+                [&pages, &onResult](std::size_t i) { onResult(i, std::move(pages[i])); });
+}
+
+BatchStats BatchExtractor::fanOut(core::exec::WorkStealingPool& pool, std::size_t count, std::size_t bytes,
+                                  BatchDelivery delivery, const BatchWorkFn& work, const BatchDeliverFn& deliver) {
+  BatchStats stats;
+  stats.pages = count;
+  stats.bytes = bytes;
+  stats.workers = std::min(pool.size(), count);
+  if (count == 0) return stats;
+
+  if (pool.isWorkerThread()) {
+    util::Log::error("BatchExtractor: batch started from a pool worker; refusing to deadlock");
+    return stats;
+  }
+
+  const auto t0 = std::chrono::steady_clock::now();
+
+  auto state = std::make_shared<BatchState>();
+  state->remaining = count;
+  if (delivery == BatchDelivery::Ordered) state->finished.resize(count);
+
+  std::vector<core::exec::WorkStealingPool::Task> tasks;
+  tasks.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    tasks.push_back([state, i, &work, &deliver, delivery](std::size_t worker) {
+      work(i, worker);
+
+      std::lock_guard<std::mutex> lk(state->mu);
+      if (delivery == BatchDelivery::Unordered) {
+        deliver(i);
+      } else {
+        state->finished[i] = 1;
+        while (state->nextOut < state->finished.size() && state->finished[state->nextOut]) deliver(state->nextOut++);
+      }
+      if (--state->remaining == 0) state->done.notify_all();
+    });
+  }
+  pool.submitBulk(std::move(tasks));
+
+  {
+    std::unique_lock<std::mutex> lk(state->mu);
+    state->done.wait(lk, [&]() { return state->remaining == 0; });
+  }
+
+  const auto t1 = std::chrono::steady_clock::now();
+  stats.wallMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+  const double secs = std::max(stats.wallMs / 1000.0, 1e-9);
+  stats.pagesPerSec = stats.pages / secs;
+  stats.pagesPerSecPerCore = stats.pagesPerSec / std::max<std::size_t>(stats.workers, 1);
+  stats.mbPerSec = (stats.bytes / (1024.0 * 1024.0)) / secs;
+  return stats;
+}
+
+std::string BatchExtractor::formatStats(const BatchStats& s) {
+  std::ostringstream oss;
+  oss.setf(std::ios::fixed);
+  oss.precision(1);
+  oss << s.pages << " pages, " << (s.bytes / 1024) << " KiB in " << s.wallMs << " ms on "
+      << s.workers << " workers: " << s.pagesPerSec << " pages/s ("
+      << s.pagesPerSecPerCore << " pages/s/core, " << s.mbPerSec << " MiB/s)";
+  return oss.str();
+}
+
+} // namespace core::extract
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "core/exec/WorkStealingPool.h"
+#include "core/extract/HtmlExtractor.h"
+
+namespace core::extract {
+
+struct BatchDocument {
+  std::string html;
+  std::string baseUrl;
+};
+
+enum class BatchDelivery { Ordered, Unordered };
+
+struct BatchStats {
+  std::size_t pages = 0;
+  std::size_t bytes = 0;
+  std::size_t workers = 0;
+  double wallMs = 0.0;
+  double pagesPerSec = 0.0;
+  double pagesPerSecPerCore = 0.0;
+  double mbPerSec = 0.0;
+};
+
+// Receives one extracted page per input document. Calls are serialized (no locking
+// needed inside), but they run on pool threads, not on the caller's thread.
+using BatchResultFn = std::function<void(std::size_t index, ExtractedPage&& page)>;
+// Per-item work for fanOut(), given the pool worker's index, and its serialized handover.
+using BatchWorkFn = std::function<void(std::size_t index, std::size_t worker)>;
+using BatchDeliverFn = std::function<void(std::size_t index)>;
+
+// Runs HtmlExtractor over many documents on a work-stealing pool. Every pool worker
+// owns one HtmlExtractor (and, per thread, a Gumbo parse arena) that is reused across
+// documents and batches.
+class BatchExtractor {
+public:
+  explicit BatchExtractor(core::exec::WorkStealingPool& pool = core::exec::WorkStealingPool::shared());
+
+  // Blocks until every result has been delivered. Ordered hands results over in input
+  // order; Unordered hands each one over as soon as it finishes. Must not be called
+  // from a worker of the same pool.
+  BatchStats extractBatch(const std::vector<BatchDocument>& docs,
+                          BatchDelivery delivery,
+                          const BatchResultFn& onResult);
+
+  // The fan-out under extractBatch, for other per-document work on the pool (e.g.
+  // CompiledRecipe::applyBulk): work runs for every index, then deliver is called for
+  // it under the batch lock, in input order or as finished. bytes only feeds the stats.
+  static BatchStats fanOut(core::exec::WorkStealingPool& pool, std::size_t count, std::size_t bytes,
+                           BatchDelivery delivery, const BatchWorkFn& work, const BatchDeliverFn& deliver);
+
+  static std::string formatStats(const BatchStats& s);
+
+private:
+  core::exec::WorkStealingPool& pool_;
+  std::vector<HtmlExtractor> workers_;
+};
+
+} // namespace core::extract
@@ -0,0 +1,188 @@
+#include "core/extract/DocumentModel.h"
+#include "util/Log.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <sstream>
+
+namespace core::extract {
+
+// Ids and "before" references: positive integers, anything else reads as 0.
+static std::uint32_t readId(const nlohmann::json& j, const char* key) {
+  auto it = j.find(key);
+  if (it == j.end() || !it->is_number_unsigned()) return 0;
+  return it->get<std::uint32_t>();
+}
+
+static std::string readString(const nlohmann::json& j, const char* key) {
+  auto it = j.find(key);
+  return it != j.end() && it->is_string() ? it->get<std::string>() : std::string();
+}
+
+static bool readBlock(const nlohmann::json& j, LiveBlock& b) {
+  if (!j.is_object()) return false;
+  b.id = readId(j, "id");
+  if (b.id == 0) return false;
+  b.level = (int)std::min<std::uint32_t>(readId(j, "level"), 6);
+  b.tag = readString(j, "tag");
+  b.text = readString(j, "text");
+  return true;
+}
+
+void DocumentModel::clear() {
+  nodes_.clear();
+  head_ = tail_ = 0;
+  url_.clear();
+  title_.clear();
+  ++version_;
+}
+
+bool DocumentModel::applySnapshot(std::string_view json) {
+  auto j = nlohmann::json::parse(json, nullptr, false);
+  if (j.is_discarded() || !j.is_object()) {
+    util::Log::warn("DocumentModel: malformed snapshot");
+    return false;
+  }
+  clear();
+  url_ = readString(j, "url");
+  title_ = readString(j, "title");
+  auto blocks = j.find("blocks");
+  if (blocks != j.end() && blocks->is_array()) {
+    nodes_.reserve(blocks->size());
+    for (const auto& jb : *blocks) {
+      LiveBlock b;
+      if (readBlock(jb, b)) upsert(std::move(b), 0, true);
+    }
+  }
+  return true;
+}
+
+bool DocumentModel::applyDelta(std::string_view json) {
+  auto j = nlohmann::json::parse(json, nullptr, false);
+  if (j.is_discarded() || !j.is_object()) {
+    util::Log::warn("DocumentModel: malformed delta");
+    return false;
+  }
+  if (auto t = j.find("title"); t != j.end() && t->is_string()) title_ = t->get<std::string>();
+  if (auto u = j.find("url"); u != j.end() && u->is_string()) url_ = u->get<std::string>();
+  if (auto rm = j.find("remove"); rm != j.end() && rm->is_array()) {
+    for (const auto& id : *rm) {
+      if (id.is_number_unsigned()) remove(id.get<std::uint32_t>());
+    }
+  }
+  if (auto up = j.find("upsert"); up != j.end() && up->is_array()) {
+    for (const auto& jb : *up) {
+      LiveBlock b;
+      if (!readBlock(jb, b)) continue;
+      upsert(std::move(b), readId(jb, "before"), jb.contains("before"));
+    }
+  }
+  ++version_;
+  return true;
+}
+
+const LiveBlock* DocumentModel::find(std::uint32_t id) const {
+  auto it = nodes_.find(id);
+  return it == nodes_.end() ? nullptr : &it->second.block;
+}
+
+void DocumentModel::unlink(Node& n) {
+  if (n.prev) nodes_[n.prev].next = n.next; else head_ = n.next;
+  if (n.next) nodes_[n.next].prev = n.prev; else tail_ = n.prev;
+  n.prev = n.next = 0;
+}
+
+void DocumentModel::upsert(LiveBlock block, std::uint32_t before, bool positioned) {
+  const std::uint32_t id = block.id;
+  if (before == id || (before && !nodes_.count(before))) before = 0;
+
+  auto [it, inserted] = nodes_.try_emplace(id);
+  Node& n = it->second;
+  if (!inserted) {
+    // Text-only change in place is the common case; only relink when the block moved.
+    n.block = std::move(block);
+    if (!positioned || before == n.next) return;
+    unlink(n);
+  } else {
+    n.block = std::move(block);
+  }
+
+  if (before) {
+    Node& next = nodes_[before];
+    n.prev = next.prev;
+    n.next = before;
+    if (next.prev) nodes_[next.prev].next = id; else head_ = id;
+    next.prev = id;
+  } else {
+    n.prev = tail_;
+    n.next = 0;
+    if (tail_) nodes_[tail_].next = id; else head_ = id;
+    tail_ = id;
+  }
+}
+
+void DocumentModel::remove(std::uint32_t id) {
+  auto it = nodes_.find(id);
+  if (it == nodes_.end()) return;
+  unlink(it->second);
+  nodes_.erase(it);
+}
+
+ExtractedPage DocumentModel::toPage() const {
+  ExtractedPage ep;
+  ep.title = title_;
+  ep.canonicalUrl = url_;
+
+  struct Candidate {
+    const LiveBlock* block;
+    int section;
+    std::size_t ordinal;
+  };
+  std::vector<Candidate> paras;
+  std::vector<int> open;
+  std::size_t ordinal = 0;
+
+  forEach([&](const LiveBlock& b) {
+    ++ordinal;
+    if (b.level >= 1 && b.level <= 6) {
+      std::string text = HtmlExtractor::stripWhitespace(b.text);
+      if (text.empty()) return;
+      while (!open.empty() && ep.headings[open.back()].level >= b.level) open.pop_back();
+      Heading h;
+      h.level = b.level;
+      h.text = std::move(text);
+      h.parent = open.empty() ? -1 : open.back();
+      ep.headings.push_back(std::move(h));
+      open.push_back((int)ep.headings.size() - 1);
+      return;
+    }
+    if (b.text.size() > 40) paras.push_back({&b, open.empty() ? -1 : open.back(), ordinal});
+  });
+
+  // Same selection as HtmlExtractor: longest first, ties in document order.
+  std::stable_sort(paras.begin(), paras.end(), [](const Candidate& a, const Candidate& b) {
+    return a.block->text.size() > b.block->text.size();
+  });
+  const std::size_t take = std::min<std::size_t>(paras.size(), 24);
+  ep.blocks.reserve(take);
+  for (std::size_t i = 0; i < take; ++i) {
+    Block b;
+    b.text = HtmlExtractor::stripWhitespace(paras[i].block->text);
+    b.hash = HtmlExtractor::blockHash(b.text);
+    b.section = paras[i].section;
+    ep.blocks.push_back(std::move(b));
+  }
+
+  std::vector<std::size_t> order(take);
+  for (std::size_t i = 0; i < take; ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+    return paras[a].ordinal < paras[b].ordinal;
+  });
+  HtmlExtractor::assignBlockIds(ep.blocks, order);
+
+  std::ostringstream full;
+  for (const auto& b : ep.blocks) full << "[" << b.id << "] " << b.text << "\n\n";
+  ep.fullText = full.str();
+  return ep;
+}
+
+} // namespace core::extract
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "core/extract/HtmlExtractor.h"
+
+namespace core::extract {
+
+// One text block as reported by the in-page capture script. id is assigned by the
+// script and stays with the DOM element for the element's lifetime.
+struct LiveBlock {
+  std::uint32_t id = 0;
+  int level = 0;   // 1-6 for headings, 0 otherwise
+  std::string tag; // lowercase tag name
+  std::string text;
+};
+
+// Per-tab text model of a live page, fed by DomBridge: one full snapshot after load,
+// then MutationObserver deltas applied in place. Blocks are a doubly linked list in
+// document order keyed by id, so an insert, update or removal is O(1) and nothing is
+// rebuilt. Not thread-safe; owned by the GUI thread.
+//
+// Messages are JSON:
+//   snapshot: {"url":..., "title":..., "blocks":[{"id","tag","level","text"}, ...]}
+//   delta:    {"title":..., "url":..., "upsert":[{"id","tag","level","text","before"}], "remove":[id, ...]}
+// where "before" is the id of the block that follows in document order (0 = append).
+// An upsert without "before" keeps an existing block where it is; title and url are
+// only present when they changed (history.pushState navigations).
+class DocumentModel {
+public:
+  bool applySnapshot(std::string_view json);
+  bool applyDelta(std::string_view json);
+  void clear();
+
+  // Bumped by every change; an analysis built at version v is current while it matches.
+  std::uint64_t version() const { return version_; }
+  bool empty() const { return nodes_.empty(); }
+  std::size_t size() const { return nodes_.size(); }
+  const std::string& url() const { return url_; }
+  const std::string& title() const { return title_; }
+
+  const LiveBlock* find(std::uint32_t id) const;
+  template <class Fn> void forEach(Fn&& fn) const {
+    for (std::uint32_t id = head_; id; ) {
+      const Node& n = nodes_.at(id);
+      fn(n.block);
+      id = n.next;
+    }
+  }
+
+  // Same shape HtmlExtractor produces (outline, top blocks by length with content-hash
+  // ids, fullText). There is no source HTML, so byte ranges are left at 0.
+  ExtractedPage toPage() const;
+
+private:
+  struct Node {
+    LiveBlock block;
+    std::uint32_t prev = 0;
+    std::uint32_t next = 0;
+  };
+
+  std::unordered_map<std::uint32_t, Node> nodes_;
+  std::uint32_t head_ = 0;
+  std::uint32_t tail_ = 0;
+  std::string url_;
+  std::string title_;
+  std::uint64_t version_ = 0;
+
+  void upsert(LiveBlock block, std::uint32_t before, bool positioned);
+  void remove(std::uint32_t id);
+  void unlink(Node& n);
+};
+
+} // namespace core::extract
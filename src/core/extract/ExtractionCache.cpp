@@ -0,0 +1,111 @@
+#include "core/extract/ExtractionCache.h"
+#include "util/Hash.h"
+
+namespace core::extract {
+
+ExtractionCache::ExtractionCache(std::size_t budgetBytes)
+  : budget_(budgetBytes), bytes_(0) {}
+
+ExtractionCache& ExtractionCache::shared() {
+  static ExtractionCache cache;
+  return cache;
+}
+
+std::uint64_t ExtractionCache::keyFor(std::string_view url, std::string_view html) {
+  return util::xxh64(html, util::xxh64(url));
+}
+
+std::size_t ExtractionCache::estimateBytes(const ExtractedPage& ep) {
+  std::size_t n = sizeof(ExtractedPage);
+  n += ep.title.capacity() + ep.description.capacity() + ep.canonicalUrl.capacity() + ep.fullText.capacity();
+  for (const auto& h : ep.headings) n += sizeof(h) + h.text.capacity();
+  for (const auto& l : ep.links) n += sizeof(l) + l.href.capacity() + l.text.capacity() + l.rel.capacity();
+  for (const auto& b : ep.blocks) n += sizeof(b) + b.id.capacity() + b.text.capacity();
+  for (const auto& e : ep.structured) {
+    n += sizeof(e) + e.type.capacity() + e.name.capacity() + e.id.capacity() + e.url.capacity() + e.source.capacity();
+  }
+  for (const auto& t : ep.tables) {
+    n += sizeof(t) + t.caption.capacity();
+    for (const auto& s : t.strings) n += sizeof(s) + s.capacity();
+    for (const auto& c : t.columns) n += sizeof(c) + c.name.capacity() + c.cells.capacity() * sizeof(std::uint32_t);
+  }
+  return n;
+}
+
+std::shared_ptr<const ExtractedPage> ExtractionCache::find(std::uint64_t key) {
+  std::lock_guard<std::mutex> lk(mu_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    ++stats_.misses;
+    return nullptr;
+  }
+  ++stats_.hits;
+  lru_.splice(lru_.begin(), lru_, it->second);
+  return it->second->page;
+}
+
+std::shared_ptr<const ExtractedPage> ExtractionCache::insert(std::uint64_t key, ExtractedPage page) {
+  const std::size_t bytes = estimateBytes(page);
+  auto sp = std::make_shared<const ExtractedPage>(std::move(page));
+
+  std::lock_guard<std::mutex> lk(mu_);
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    // Another thread extracted the same document first; keep the cached copy.
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->page;
+  }
+  if (bytes > budget_) return sp; // never cacheable, hand it back uncached
+
+  lru_.push_front(Entry{key, sp, bytes});
+  index_[key] = lru_.begin();
+  bytes_ += bytes;
+  evictLocked();
+  return sp;
+}
+
+std::shared_ptr<const ExtractedPage> ExtractionCache::getOrExtract(HtmlExtractor& extractor,
+                                                                   std::string_view html,
+                                                                   const std::string& baseUrl) {
+  const std::uint64_t key = keyFor(baseUrl, html);
+  if (auto hit = find(key)) return hit;
+  return insert(key, extractor.extract(html, baseUrl));
+}
+
+std::shared_ptr<const ExtractedPage> ExtractionCache::getOrExtract(HtmlExtractor& extractor, const HtmlSnapshot& snapshot) {
+  if (auto hit = find(snapshot.key)) return hit;
+  return insert(snapshot.key, extractor.extract(snapshot.document(), snapshot.url));
+}
+
+void ExtractionCache::setBudgetBytes(std::size_t bytes) {
+  std::lock_guard<std::mutex> lk(mu_);
+  budget_ = bytes;
+  evictLocked();
+}
+
+void ExtractionCache::clear() {
+  std::lock_guard<std::mutex> lk(mu_);
+  lru_.clear();
+  index_.clear();
+  bytes_ = 0;
+}
+
+ExtractionCache::Stats ExtractionCache::stats() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  Stats s = stats_;
+  s.entries = lru_.size();
+  s.bytes = bytes_;
+  return s;
+}
+
+void ExtractionCache::evictLocked() {
+  while (bytes_ > budget_ && !lru_.empty()) {
+    const Entry& victim = lru_.back();
+    bytes_ -= victim.bytes;
+    index_.erase(victim.key);
+    lru_.pop_back();
+    ++stats_.evictions;
+  }
+}
+
+} // namespace core::extract
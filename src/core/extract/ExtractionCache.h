@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "core/extract/HtmlExtractor.h"
+#include "core/extract/HtmlSnapshot.h"
+
+namespace core::extract {
+
+// Process-wide LRU of extraction results keyed by a hash of URL + HTML, bounded by an
+// estimate of the bytes the cached pages hold. Pages are shared read-only, so a hit
+// costs one hash of the input and no parsing. Thread-safe.
+class ExtractionCache {
+public:
+  struct Stats {
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t evictions = 0;
+    std::size_t entries = 0;
+    std::size_t bytes = 0;
+  };
+
+  explicit ExtractionCache(std::size_t budgetBytes = 32 * 1024 * 1024);
+
+  static ExtractionCache& shared();
+
+  static std::uint64_t keyFor(std::string_view url, std::string_view html);
+
+  std::shared_ptr<const ExtractedPage> find(std::uint64_t key);
+  std::shared_ptr<const ExtractedPage> insert(std::uint64_t key, ExtractedPage page);
+
+  // Cache lookup, falling back to extractor.extract() and caching the result.
+  std::shared_ptr<const ExtractedPage> getOrExtract(HtmlExtractor& extractor,
+                                                    std::string_view html,
+                                                    const std::string& baseUrl);
+  // Same, reusing the key computed when the snapshot was taken.
+  std::shared_ptr<const ExtractedPage> getOrExtract(HtmlExtractor& extractor, const HtmlSnapshot& snapshot);
+
+  void setBudgetBytes(std::size_t bytes);
+  void clear();
+  Stats stats() const;
+
+  static std::size_t estimateBytes(const ExtractedPage& ep);
+
+private:
+  struct Entry {
+    std::uint64_t key;
+    std::shared_ptr<const ExtractedPage> page;
+    std::size_t bytes;
+  };
+
+  mutable std::mutex mu_;
+  std::list<Entry> lru_; // front = most recently used
+  std::unordered_map<std::uint64_t, std::list<Entry>::iterator> index_;
+  std::size_t budget_;
+  std::size_t bytes_;
+  Stats stats_;
+
+  void evictLocked();
+};
+
+} // namespace core::extract
@@ -1,24 +1,37 @@
 \
 /* src/core/extract/HtmlExtractor.cpp */
 #include "core/extract/HtmlExtractor.h"
+#include "core/net/LinkResolver.h"
+#include "util/Hash.h"
 #include "util/Log.h"
-#include <gumbo.h>
+#include <QUrl>
 #include <algorithm>
 #include <cctype>
+#include <cstddef>
 #include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace core::extract {
 
-static void appendText(std::string& out, const std::string& t) {
-  if (t.empty()) return;
-  if (!out.empty() && out.back() != '\n') out.push_back('\n');
-  out += t;
-}
+struct Para {
+  std::string text;
+  int section = -1;
+  std::size_t begin = 0;
+  std::size_t end = 0;
+};
 
-static bool isVisibleTextNode(const GumboNode* node) {
-  if (!node || node->type != GUMBO_NODE_TEXT) return false;
-  return true;
-}
+struct HtmlExtractor::Scratch {
+  std::vector<Para> paraTexts;
+  std::vector<std::size_t> docOrder;
+};
+
+HtmlExtractor::HtmlExtractor() : scratch_(std::make_unique<Scratch>()) {}
+HtmlExtractor::~HtmlExtractor() = default;
+HtmlExtractor::HtmlExtractor(HtmlExtractor&&) noexcept = default;
+HtmlExtractor& HtmlExtractor::operator=(HtmlExtractor&&) noexcept = default;
+
+using NodeId = ParsedDocument::NodeId;
 
 static bool isSkippableTag(GumboTag tag) {
   switch (tag) {
@@ -35,109 +48,243 @@ static bool isSkippableTag(GumboTag tag) {
   }
 }
 
-static std::string getAttribute(const GumboElement& el, const char* name) {
-  GumboAttribute* a = gumbo_get_attribute(&el.attributes, name);
-  if (!a || !a->value) return "";
-  return a->value;
+// Visible text under node in document order, whitespace runs collapsed to one space.
+static std::string collectText(const ParsedDocument& doc, NodeId node) {
+  std::string txt;
+  doc.appendText(node, txt, isSkippableTag);
+  return txt;
+}
+
+struct WalkState {
+  std::vector<Para>& paraTexts;
+  std::vector<std::size_t> itemScopes; // open microdata items, indices into ep.structured
+  std::vector<NodeId> itemEnds;        // subtree end of the element that opened each item
+  std::vector<int> openSections;       // heading path to the current position, indices into ep.headings
+};
+
+static int headingLevel(GumboTag tag) {
+  switch (tag) {
+    case GUMBO_TAG_H1: return 1;
+    case GUMBO_TAG_H2: return 2;
+    case GUMBO_TAG_H3: return 3;
+    case GUMBO_TAG_H4: return 4;
+    case GUMBO_TAG_H5: return 5;
+    case GUMBO_TAG_H6: return 6;
+    default: return 0;
+  }
+}
+
+// A heading closes every open section of the same or a deeper level, then opens its own.
+static void openSection(const ParsedDocument& doc, NodeId node, int level, ExtractedPage& ep, WalkState& st) {
+  std::string text = HtmlExtractor::stripWhitespace(collectText(doc, node));
+  if (text.empty()) return;
+  Heading h;
+  h.level = level;
+  h.text = std::move(text);
+  h.begin = doc.sourceBegin(node);
+  while (!st.openSections.empty() && ep.headings[st.openSections.back()].level >= level) {
+    ep.headings[st.openSections.back()].end = h.begin;
+    st.openSections.pop_back();
+  }
+  h.parent = st.openSections.empty() ? -1 : st.openSections.back();
+  ep.headings.push_back(std::move(h));
+  st.openSections.push_back((int)ep.headings.size() - 1);
+}
+
+static bool isJsonLdScript(const ParsedDocument& doc, NodeId node) {
+  if (doc.tag(node) != GUMBO_TAG_SCRIPT) return false;
+  std::string t(doc.attr(node, "type"));
+  std::transform(t.begin(), t.end(), t.begin(), [](unsigned char c){ return (char)std::tolower(c); });
+  return t.rfind("application/ld+json", 0) == 0;
 }
 
-static void walk(const GumboNode* node,
-                 std::vector<std::string>& headings,
-                 std::vector<std::string>& links,
-                 std::vector<std::string>& paraTexts,
-                 bool inSkippable) {
-  if (!node) return;
-
-  if (node->type == GUMBO_NODE_ELEMENT) {
-    GumboTag tag = node->v.element.tag;
-    bool skip = inSkippable || isSkippableTag(tag);
-
-    if (!skip) {
-      if (tag == GUMBO_TAG_A) {
-        auto href = getAttribute(node->v.element, "href");
-        if (!href.empty()) links.push_back(href);
+// Microdata: itemscope+itemtype opens an item; itemprop name/headline/url fill the
+// innermost open one. The item closes when the walk leaves the element's subtree.
+static void visitMicrodata(const ParsedDocument& doc, NodeId node, ExtractedPage& ep, WalkState& st) {
+  if (!st.itemScopes.empty()) {
+    std::string_view p = doc.attr(node, "itemprop");
+    if (!p.empty()) {
+      StructuredEntity& e = ep.structured[st.itemScopes.back()];
+      if ((p == "name" || p == "headline") && e.name.empty()) {
+        std::string_view content = doc.attr(node, "content");
+        e.name = HtmlExtractor::stripWhitespace(content.empty() ? collectText(doc, node) : std::string(content));
+      } else if (p == "url" && e.url.empty()) {
+        std::string_view href = doc.attr(node, "href");
+        e.url = std::string(href.empty() ? doc.attr(node, "content") : href);
       }
     }
+  }
+  if (!doc.hasAttr(node, "itemscope")) return;
+  std::string_view type = doc.attr(node, "itemtype");
+  if (type.empty()) return;
+  StructuredEntity e;
+  e.type = std::string(StructuredData::localType(type.substr(0, type.find(' '))));
+  e.kind = StructuredData::classify(e.type);
+  e.id = std::string(doc.attr(node, "itemid"));
+  e.source = "microdata";
+  ep.structured.push_back(std::move(e));
+  st.itemScopes.push_back(ep.structured.size() - 1);
+  st.itemEnds.push_back(doc.subtreeEnd(node));
+}
 
-    if (!skip && (tag == GUMBO_TAG_H1 || tag == GUMBO_TAG_H2 || tag == GUMBO_TAG_H3)) {
-      // collect text under this node
-      std::string txt;
-      // naive: recurse and gather text
-      GumboVector* children = &node->v.element.children;
-      for (unsigned i = 0; i < children->length; ++i) {
-        walk(static_cast<GumboNode*>(children->data[i]), headings, links, paraTexts, skip);
+// One linear pass over the node table in document order.
+static void walk(const ParsedDocument& doc, ExtractedPage& ep, WalkState& st) {
+  NodeId skipEnd = 0; // inside a skippable subtree while i < skipEnd
+  for (NodeId i = 0; i < doc.size(); ++i) {
+    while (!st.itemEnds.empty() && i >= st.itemEnds.back()) {
+      st.itemEnds.pop_back();
+      st.itemScopes.pop_back();
+    }
+    if (!doc.isElement(i)) continue;
+    const GumboTag tag = doc.tag(i);
+
+    // Structured data counts wherever it sits, including <head>, <header> and <nav>.
+    if (isJsonLdScript(doc, i)) {
+      for (NodeId c = doc.firstChild(i); c != ParsedDocument::kNone; c = doc.nextSibling(c)) {
+        if (doc.kind(c) == NodeKind::Text) StructuredData::parseJsonLd(doc.text(c), ep.structured);
       }
-      // headings are collected by parsing after; simpler: ignore here
+      i = doc.subtreeEnd(i) - 1;
+      continue;
     }
+    visitMicrodata(doc, i, ep, st);
 
-    if (!skip && (tag == GUMBO_TAG_P || tag == GUMBO_TAG_LI || tag == GUMBO_TAG_ARTICLE || tag == GUMBO_TAG_MAIN)) {
-      // extract visible text from subtree as paragraph-ish
-      std::string txt;
-      std::vector<const GumboNode*> stack;
-      stack.push_back(node);
-      while (!stack.empty()) {
-        const GumboNode* n = stack.back();
-        stack.pop_back();
-        if (n->type == GUMBO_NODE_TEXT && n->v.text.text) {
-          txt += n->v.text.text;
-          txt.push_back(' ');
-        } else if (n->type == GUMBO_NODE_ELEMENT) {
-          GumboTag t = n->v.element.tag;
-          if (isSkippableTag(t)) continue;
-          GumboVector* ch = &n->v.element.children;
-          for (unsigned i = 0; i < ch->length; ++i) {
-            stack.push_back(static_cast<GumboNode*>(ch->data[i]));
-          }
-        }
+    if (i >= skipEnd && isSkippableTag(tag)) skipEnd = doc.subtreeEnd(i);
+    if (i < skipEnd) continue;
+
+    if (tag == GUMBO_TAG_A) {
+      // Kept raw here; resolveLinks() makes them absolute and dedupes after the walk.
+      std::string_view href = doc.attr(i, "href");
+      if (!href.empty()) {
+        ep.links.push_back({std::string(href), HtmlExtractor::stripWhitespace(collectText(doc, i)), std::string(doc.attr(i, "rel"))});
       }
-      // normalize whitespace
-      txt.erase(std::unique(txt.begin(), txt.end(), [](char a, char b){
-        return std::isspace((unsigned char)a) && std::isspace((unsigned char)b);
-      }), txt.end());
-      if (txt.size() > 40) paraTexts.push_back(txt);
+    }
+    if (tag == GUMBO_TAG_TABLE) {
+      // Nested tables are picked up again as the walk reaches them.
+      Table t = TableExtractor::extract(doc, i);
+      if (t.rows > 0 && !t.columns.empty() && t.rows * t.columns.size() >= 2) ep.tables.push_back(std::move(t));
     }
 
-    GumboVector* children = &node->v.element.children;
-    for (unsigned i = 0; i < children->length; ++i) {
-      walk(static_cast<GumboNode*>(children->data[i]), headings, links, paraTexts, skip);
+    if (int level = headingLevel(tag)) openSection(doc, i, level, ep, st);
+
+    if (tag == GUMBO_TAG_P || tag == GUMBO_TAG_LI || tag == GUMBO_TAG_ARTICLE || tag == GUMBO_TAG_MAIN) {
+      // extract visible text from subtree as paragraph-ish
+      Para p;
+      p.text = collectText(doc, i);
+      if (p.text.size() > 40) {
+        p.section = st.openSections.empty() ? -1 : st.openSections.back();
+        p.begin = doc.sourceBegin(i);
+        p.end = doc.sourceEnd(i);
+        st.paraTexts.push_back(std::move(p));
+      }
     }
-  } else if (isVisibleTextNode(node)) {
-    // no-op; handled in paragraph scanning
   }
 }
 
-static void findMeta(const GumboNode* node, std::string& title, std::string& desc, std::string& canonical) {
-  if (!node) return;
-  if (node->type == GUMBO_NODE_ELEMENT) {
-    GumboTag tag = node->v.element.tag;
-    if (tag == GUMBO_TAG_TITLE) {
-      GumboVector* ch = &node->v.element.children;
-      for (unsigned i = 0; i < ch->length; ++i) {
-        GumboNode* c = static_cast<GumboNode*>(ch->data[i]);
-        if (c->type == GUMBO_NODE_TEXT && c->v.text.text) {
-          title = c->v.text.text;
-          break;
+static void findMeta(const ParsedDocument& doc, std::string& title, std::string& desc, std::string& canonical,
+                     std::string& baseHref) {
+  for (NodeId i = 0; i < doc.size(); ++i) {
+    if (!doc.isElement(i)) continue;
+    switch (doc.tag(i)) {
+      case GUMBO_TAG_TITLE:
+        for (NodeId c = doc.firstChild(i); c != ParsedDocument::kNone; c = doc.nextSibling(c)) {
+          if (doc.kind(c) == NodeKind::Text) {
+            title = std::string(doc.text(c));
+            break;
+          }
+        }
+        break;
+      case GUMBO_TAG_META: {
+        std::string_view content = doc.attr(i, "content");
+        if (!content.empty() && desc.empty()
+            && (doc.attr(i, "name") == "description" || doc.attr(i, "property") == "og:description")) {
+          desc = std::string(content);
         }
+        break;
       }
+      case GUMBO_TAG_LINK: {
+        std::string_view href = doc.attr(i, "href");
+        if (doc.attr(i, "rel") == "canonical" && !href.empty()) canonical = std::string(href);
+        break;
+      }
+      case GUMBO_TAG_BASE:
+        if (baseHref.empty()) baseHref = std::string(doc.attr(i, "href"));
+        break;
+      default:
+        break;
     }
-    if (tag == GUMBO_TAG_META) {
-      auto name = getAttribute(node->v.element, "name");
-      auto prop = getAttribute(node->v.element, "property");
-      auto content = getAttribute(node->v.element, "content");
-      if (!content.empty()) {
-        if (name == "description" && desc.empty()) desc = content;
-        if (prop == "og:description" && desc.empty()) desc = content;
+  }
+}
+
+// Resolves the raw hrefs collected by walk in place: absolute, normalized, one entry
+// per target in first-seen order. Repeated raw hrefs (menus, "read more") skip the
+// URL parse entirely through the raw-href map.
+static void resolveLinks(std::vector<Link>& links, const QUrl& base) {
+  core::net::LinkResolver resolver(base);
+  std::unordered_map<std::string, std::size_t> byHref; // resolved href -> index in links
+  std::unordered_map<std::string, std::size_t> byRaw;  // raw href -> index, or npos if rejected
+  byHref.reserve(links.size());
+  byRaw.reserve(links.size());
+  constexpr std::size_t kRejected = static_cast<std::size_t>(-1);
+
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < links.size(); ++i) {
+    Link& l = links[i];
+    std::size_t target;
+    auto raw = byRaw.find(l.href);
+    if (raw != byRaw.end()) {
+      target = raw->second;
+    } else {
+      std::string abs = resolver.resolve(l.href);
+      if (abs.empty()) {
+        target = kRejected;
+      } else if (auto it = byHref.find(abs); it != byHref.end()) {
+        target = it->second;
+      } else {
+        byHref.emplace(abs, kept);
+        byRaw.emplace(l.href, kept);
+        if (kept != i) links[kept] = std::move(l);
+        links[kept].href = std::move(abs);
+        ++kept;
+        continue;
       }
+      byRaw.emplace(l.href, target);
     }
-    if (tag == GUMBO_TAG_LINK) {
-      auto rel = getAttribute(node->v.element, "rel");
-      auto href = getAttribute(node->v.element, "href");
-      if (rel == "canonical" && !href.empty()) canonical = href;
+    if (target != kRejected && links[target].text.empty() && !l.text.empty()) links[target].text = std::move(l.text);
+  }
+  links.resize(kept);
+}
+
+std::uint64_t HtmlExtractor::blockHash(std::string_view text) {
+  // Paragraphs are short: normalize into a reused buffer and hash it in one call.
+  thread_local std::string norm;
+  norm.clear();
+  norm.reserve(text.size());
+  bool pendingSpace = false;
+  for (char ch : text) {
+    unsigned char c = (unsigned char)ch;
+    if (std::isspace(c)) {
+      pendingSpace = !norm.empty();
+      continue;
     }
-    GumboVector* children = &node->v.element.children;
-    for (unsigned i = 0; i < children->length; ++i) {
-      findMeta(static_cast<GumboNode*>(children->data[i]), title, desc, canonical);
+    if (pendingSpace) norm.push_back(' ');
+    pendingSpace = false;
+    norm.push_back((char)std::tolower(c));
+  }
+  return util::xxh64(norm);
+}
+
+void HtmlExtractor::assignBlockIds(std::vector<Block>& blocks, const std::vector<std::size_t>& docOrder) {
+  std::unordered_set<std::string> used;
+  used.reserve(blocks.size());
+  for (std::size_t i : docOrder) {
+    Block& b = blocks[i];
+    std::string id = "block_" + util::hex64(b.hash).substr(0, 12);
+    if (!used.insert(id).second) {
+      int n = 2;
+      while (!used.insert(id + "-" + std::to_string(n)).second) ++n;
+      id += "-" + std::to_string(n);
     }
+    b.id = std::move(id);
   }
 }
 
@@ -148,37 +295,74 @@ std::string HtmlExtractor::stripWhitespace(const std::string& s) {
   return out;
 }
 
-ExtractedPage HtmlExtractor::extract(const std::string& html, const std::string& baseUrl) {
+ExtractedPage HtmlExtractor::extract(std::string_view html, const std::string& baseUrl) {
+  return extract(ParsedDocument(html), baseUrl);
+}
+
+ExtractedPage HtmlExtractor::extract(const ParsedDocument& doc, const std::string& baseUrl) {
   ExtractedPage ep;
-  GumboOutput* output = gumbo_parse(html.c_str());
-  if (!output) return ep;
+  if (doc.empty()) return ep;
+  Scratch& s = *scratch_;
 
-  findMeta(output->root, ep.title, ep.description, ep.canonicalUrl);
+  std::string baseHref;
+  findMeta(doc, ep.title, ep.description, ep.canonicalUrl, baseHref);
 
-  std::vector<std::string> paraTexts;
-  walk(output->root, ep.headings, ep.links, paraTexts, false);
+  std::vector<Para>& paraTexts = s.paraTexts;
+  paraTexts.clear();
+  WalkState st{paraTexts, {}, {}, {}};
+  walk(doc, ep, st);
+  for (int open : st.openSections) ep.headings[open].end = doc.sourceSize();
 
-  // Simple "main content" heuristic: take top paragraphs by length
-  std::sort(paraTexts.begin(), paraTexts.end(), [](const std::string& a, const std::string& b){
-    return a.size() > b.size();
+  // Simple "main content" heuristic: take top paragraphs by length. Stable, so equal
+  // lengths keep document order and the selection does not flap between runs.
+  std::stable_sort(paraTexts.begin(), paraTexts.end(), [](const Para& a, const Para& b){
+    return a.text.size() > b.text.size();
   });
 
   const int maxBlocks = 24;
   int take = std::min<int>((int)paraTexts.size(), maxBlocks);
   ep.blocks.reserve(take);
-  std::ostringstream full;
   for (int i = 0; i < take; ++i) {
     Block b;
-    b.id = "block_" + std::string(i < 9 ? "00" : (i < 99 ? "0" : "")) + std::to_string(i + 1);
-    b.text = stripWhitespace(paraTexts[i]);
-    ep.blocks.push_back(b);
-    full << "[" << b.id << "] " << b.text << "\n\n";
+    b.text = stripWhitespace(paraTexts[i].text);
+    b.hash = blockHash(b.text);
+    b.section = paraTexts[i].section;
+    b.begin = paraTexts[i].begin;
+    b.end = paraTexts[i].end;
+    ep.blocks.push_back(std::move(b));
   }
+
+  std::vector<std::size_t>& order = s.docOrder;
+  order.resize(ep.blocks.size());
+  for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+    return ep.blocks[a].begin < ep.blocks[b].begin;
+  });
+  assignBlockIds(ep.blocks, order);
+
+  std::ostringstream full;
+  for (const auto& b : ep.blocks) full << "[" << b.id << "] " << b.text << "\n\n";
   ep.fullText = full.str();
-  ep.canonicalUrl = ep.canonicalUrl.empty() ? baseUrl : ep.canonicalUrl;
 
-  gumbo_destroy_output(&kGumboDefaultOptions, output);
+  // Links resolve against <base href>, else the document URL, else the canonical URL.
+  QUrl docUrl(QString::fromStdString(baseUrl.empty() ? ep.canonicalUrl : baseUrl));
+  if (!ep.canonicalUrl.empty()) {
+    std::string abs = core::net::LinkResolver(docUrl).resolve(ep.canonicalUrl);
+    if (!abs.empty()) ep.canonicalUrl = std::move(abs);
+  }
+  if (!baseHref.empty()) docUrl = docUrl.resolved(QUrl(QString::fromStdString(baseHref)));
+  resolveLinks(ep.links, docUrl);
+  ep.canonicalUrl = ep.canonicalUrl.empty() ? baseUrl : ep.canonicalUrl;
   return ep;
 }
 
+std::vector<std::string> headingPath(const ExtractedPage& ep, int section) {
+  std::vector<std::string> path;
+  for (int i = section; i >= 0 && i < (int)ep.headings.size(); i = ep.headings[i].parent) {
+    path.push_back(ep.headings[i].text);
+  }
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
 } // namespace core::extract
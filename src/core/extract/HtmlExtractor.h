@@ -1,33 +1,91 @@
 \
 /* src/core/extract/HtmlExtractor.h */
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 
+#include "core/extract/ParsedDocument.h"
+#include "core/extract/StructuredData.h"
+#include "core/extract/TableExtractor.h"
+
 namespace core::extract {
 
+// One H1-H6 heading. Headings form a tree through parent (-1 = top level); begin/end
+// is the section's byte range in the source HTML, from the heading's start tag up to
+// the next heading of the same or a higher level.
+struct Heading {
+  int level = 1;
+  std::string text;
+  int parent = -1;
+  std::size_t begin = 0;
+  std::size_t end = 0;
+};
+
+// An outgoing link, resolved to an absolute normalized URL. One entry per target,
+// in order of first appearance.
+struct Link {
+  std::string href;
+  std::string text; // anchor text of the first occurrence that had any
+  std::string rel;  // raw rel attribute, e.g. "nofollow noopener"
+};
+
 struct Block {
-  std::string id;
+  std::string id;          // "block_" + 12 hex digits of hash, "-2", "-3"... on collision
   std::string text;
+  std::uint64_t hash = 0;  // HtmlExtractor::blockHash(text)
+  int section = -1;      // index into ExtractedPage::headings, -1 before the first heading
+  std::size_t begin = 0; // byte range of the source element in the extracted HTML
+  std::size_t end = 0;
 };
 
 struct ExtractedPage {
   std::string title;
   std::string description;
   std::string canonicalUrl;
-  std::vector<std::string> headings;
-  std::vector<std::string> links;
+  std::vector<Heading> headings; // document order
+  std::vector<Link> links;
   std::vector<Block> blocks;
+  std::vector<Table> tables;
+  std::vector<StructuredEntity> structured; // JSON-LD + microdata
   std::string fullText;
 };
 
+// Not thread-safe: each instance keeps its own scratch buffers, so use one extractor
+// per thread (BatchExtractor keeps one per pool worker).
 class HtmlExtractor {
 public:
-  ExtractedPage extract(const std::string& html, const std::string& baseUrl);
+  HtmlExtractor();
+  ~HtmlExtractor();
+  HtmlExtractor(HtmlExtractor&&) noexcept;
+  HtmlExtractor& operator=(HtmlExtractor&&) noexcept;
+
+  // html is only read during the call; offsets in the result index into it.
+  ExtractedPage extract(std::string_view html, const std::string& baseUrl);
+  // Same over an already parsed document, e.g. HtmlSnapshot::document().
+  ExtractedPage extract(const ParsedDocument& doc, const std::string& baseUrl);
 
-private:
   static std::string stripWhitespace(const std::string& s);
+
+  // XXH64 of the text with ASCII case folded and whitespace runs collapsed, so block
+  // ids survive re-extraction, reordering and cosmetic whitespace changes.
+  static std::uint64_t blockHash(std::string_view text);
+
+  // Ids come from the content hash. Repeated text (or a 48-bit prefix collision) gets a
+  // -2, -3... suffix in document order (docOrder lists block indices), so ids do not
+  // depend on the length ranking. blocks[i].hash must be set.
+  static void assignBlockIds(std::vector<Block>& blocks, const std::vector<std::size_t>& docOrder);
+
+private:
+  struct Scratch;
+  std::unique_ptr<Scratch> scratch_;
 };
 
+// Heading texts from the top-level section down to `section`; empty for -1.
+std::vector<std::string> headingPath(const ExtractedPage& ep, int section);
+
 } // namespace core::extract
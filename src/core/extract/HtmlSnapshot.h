@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "core/extract/ParsedDocument.h"
+
+namespace core::extract {
+
+// A page's HTML as UTF-8, converted once and then shared read-only by everything that
+// extracts from it (analysis, chat context, scraper). key is ExtractionCache::keyFor(url, utf8).
+struct HtmlSnapshot {
+  std::string url;
+  std::string utf8;
+  std::uint64_t key = 0;
+
+  // Parsed on first use, then shared by every consumer; thread-safe. utf8 must not be
+  // modified once this has been called.
+  const ParsedDocument& document() const {
+    std::call_once(parsed_, [this] { doc_ = ParsedDocument(utf8); });
+    return doc_;
+  }
+
+private:
+  mutable std::once_flag parsed_;
+  mutable ParsedDocument doc_;
+};
+
+using HtmlSnapshotPtr = std::shared_ptr<const HtmlSnapshot>;
+
+} // namespace core::extract
@@ -0,0 +1,225 @@
+#include "core/extract/ParsedDocument.h"
+#include <algorithm>
+#include <cctype>
+#include <memory>
+
+namespace core::extract {
+
+namespace {
+
+// Bump allocator handed to Gumbo through GumboOptions. Gumbo frees every node on
+// destroy; here those frees are no-ops and the tree is dropped by one reset().
+// Chunks up to kRetainBytes are kept so the next parse does not hit malloc at all.
+class ParseArena {
+public:
+  static constexpr std::size_t kChunkBytes = 256 * 1024;
+  static constexpr std::size_t kRetainBytes = 8 * 1024 * 1024;
+
+  void* allocate(std::size_t size) {
+    size = (size + 15) & ~std::size_t(15);
+    while (cur_ < chunks_.size()) {
+      Chunk& c = chunks_[cur_];
+      if (c.used + size <= c.size) {
+        void* p = c.data.get() + c.used;
+        c.used += size;
+        return p;
+      }
+      ++cur_;
+    }
+    Chunk c;
+    c.size = std::max(kChunkBytes, size);
+    c.data = std::make_unique<std::byte[]>(c.size);
+    c.used = size;
+    chunks_.push_back(std::move(c));
+    cur_ = chunks_.size() - 1;
+    return chunks_.back().data.get();
+  }
+
+  void reset() {
+    std::size_t kept = 0;
+    std::size_t retained = 0;
+    for (auto& c : chunks_) {
+      if (retained + c.size > kRetainBytes) break;
+      retained += c.size;
+      c.used = 0;
+      ++kept;
+    }
+    chunks_.resize(kept);
+    cur_ = 0;
+  }
+
+  static void* gumboAlloc(void* self, size_t size) { return static_cast<ParseArena*>(self)->allocate(size); }
+  static void gumboFree(void*, void*) {}
+
+private:
+  struct Chunk {
+    std::unique_ptr<std::byte[]> data;
+    std::size_t size = 0;
+    std::size_t used = 0;
+  };
+  std::vector<Chunk> chunks_;
+  std::size_t cur_ = 0;
+};
+
+// The Gumbo tree only lives while the node table is built, so one arena per thread is
+// enough (BatchExtractor parses on every pool worker at once).
+struct ThreadParser {
+  ParseArena arena;
+  GumboOptions options = kGumboDefaultOptions;
+
+  ThreadParser() {
+    options.allocator = &ParseArena::gumboAlloc;
+    options.deallocator = &ParseArena::gumboFree;
+    options.userdata = &arena;
+  }
+};
+
+bool isTextKind(GumboNodeType t) {
+  return t == GUMBO_NODE_TEXT || t == GUMBO_NODE_WHITESPACE || t == GUMBO_NODE_CDATA || t == GUMBO_NODE_COMMENT;
+}
+
+NodeKind kindOf(GumboNodeType t) {
+  switch (t) {
+    case GUMBO_NODE_TEXT: return NodeKind::Text;
+    case GUMBO_NODE_WHITESPACE: return NodeKind::Whitespace;
+    case GUMBO_NODE_CDATA: return NodeKind::CData;
+    case GUMBO_NODE_COMMENT: return NodeKind::Comment;
+    default: return NodeKind::Element;
+  }
+}
+
+} // namespace
+
+ParsedDocument::ParsedDocument(std::string_view html) : sourceSize_(html.size()) {
+  thread_local ThreadParser parser;
+  GumboOutput* output = gumbo_parse_with_options(&parser.options, html.data(), html.size());
+  if (output) {
+    build(output->root);
+    gumbo_destroy_output(&parser.options, output);
+  }
+  parser.arena.reset();
+}
+
+ParsedDocument::Span ParsedDocument::intern(std::string_view s) {
+  Span span{(std::uint32_t)pool_.size(), (std::uint32_t)s.size()};
+  pool_.append(s);
+  return span;
+}
+
+void ParsedDocument::addClasses(std::string_view value) {
+  std::size_t i = 0;
+  while (i < value.size()) {
+    while (i < value.size() && std::isspace((unsigned char)value[i])) ++i;
+    std::size_t j = i;
+    while (j < value.size() && !std::isspace((unsigned char)value[j])) ++j;
+    if (j > i) {
+      auto [it, inserted] = classIds_.try_emplace(std::string(value.substr(i, j - i)), (std::uint32_t)classIds_.size());
+      (void)inserted;
+      classes_.push_back(it->second);
+    }
+    i = j;
+  }
+}
+
+void ParsedDocument::build(const GumboNode* root) {
+  if (!root) return;
+
+  struct Frame {
+    const GumboNode* node;
+    NodeId id;
+    unsigned next; // next child to visit
+  };
+  std::vector<Frame> stack;
+
+  auto add = [&](const GumboNode* g, NodeId parent) -> NodeId {
+    const NodeId id = (NodeId)kind_.size();
+    kind_.push_back(kindOf(g->type));
+    parent_.push_back(parent);
+    end_.push_back(id + 1);
+    attrFirst_.push_back((std::uint32_t)attrName_.size());
+    classFirst_.push_back((std::uint32_t)classes_.size());
+    if (isTextKind(g->type)) {
+      tag_.push_back(GUMBO_TAG_UNKNOWN);
+      srcBegin_.push_back((std::uint32_t)g->v.text.start_pos.offset);
+      srcEnd_.push_back((std::uint32_t)g->v.text.start_pos.offset);
+      text_.push_back(intern(g->v.text.text ? g->v.text.text : ""));
+      attrCount_.push_back(0);
+      classCount_.push_back(0);
+      return id;
+    }
+    const GumboElement& el = g->v.element;
+    const std::size_t begin = el.start_pos.offset;
+    tag_.push_back((std::uint16_t)el.tag);
+    srcBegin_.push_back((std::uint32_t)begin);
+    srcEnd_.push_back((std::uint32_t)std::max<std::size_t>(begin, el.end_pos.offset + el.original_end_tag.length));
+    text_.push_back({});
+    const unsigned n = std::min<unsigned>(el.attributes.length, 0xFFFF);
+    for (unsigned i = 0; i < n; ++i) {
+      const auto* a = static_cast<const GumboAttribute*>(el.attributes.data[i]);
+      std::string_view value = a->value ? a->value : "";
+      attrName_.push_back(intern(a->name ? a->name : ""));
+      attrValue_.push_back(intern(value));
+      if (a->name && std::string_view(a->name) == "class") addClasses(value);
+    }
+    attrCount_.push_back((std::uint16_t)n);
+    classCount_.push_back((std::uint16_t)std::min<std::size_t>(classes_.size() - classFirst_.back(), 0xFFFF));
+    return id;
+  };
+
+  stack.push_back({root, add(root, kNone), 0});
+  while (!stack.empty()) {
+    Frame& f = stack.back();
+    const GumboNode* g = f.node;
+    const bool hasChildren = g->type == GUMBO_NODE_ELEMENT; // templates keep no children
+    if (!hasChildren || f.next >= g->v.element.children.length) {
+      end_[f.id] = (NodeId)kind_.size();
+      stack.pop_back();
+      continue;
+    }
+    const auto* c = static_cast<const GumboNode*>(g->v.element.children.data[f.next++]);
+    if (c->type == GUMBO_NODE_DOCUMENT) continue;
+    const NodeId parent = f.id;
+    const NodeId id = add(c, parent);
+    if (!isTextKind(c->type)) stack.push_back({c, id, 0});
+  }
+}
+
+std::string_view ParsedDocument::text(NodeId n) const {
+  return slice(text_[n]);
+}
+
+std::string_view ParsedDocument::attr(NodeId n, std::string_view name) const {
+  const std::uint32_t first = attrFirst_[n];
+  for (std::uint32_t i = first, e = first + attrCount_[n]; i < e; ++i) {
+    if (slice(attrName_[i]) == name) return slice(attrValue_[i]);
+  }
+  return {};
+}
+
+bool ParsedDocument::hasAttr(NodeId n, std::string_view name) const {
+  const std::uint32_t first = attrFirst_[n];
+  for (std::uint32_t i = first, e = first + attrCount_[n]; i < e; ++i) {
+    if (slice(attrName_[i]) == name) return true;
+  }
+  return false;
+}
+
+std::uint32_t ParsedDocument::classId(std::string_view cls) const {
+  auto it = classIds_.find(std::string(cls));
+  return it == classIds_.end() ? kNone : it->second;
+}
+
+bool ParsedDocument::hasClass(NodeId n, std::uint32_t cls) const {
+  if (cls == kNone) return false;
+  const std::uint32_t first = classFirst_[n];
+  return std::find(classes_.begin() + first, classes_.begin() + first + classCount_[n], cls)
+         != classes_.begin() + first + classCount_[n];
+}
+
+void ParsedDocument::collapseWhitespace(std::string& s, std::size_t from) {
+  s.erase(std::unique(s.begin() + from, s.end(), [](char a, char b) {
+    return std::isspace((unsigned char)a) && std::isspace((unsigned char)b);
+  }), s.end());
+}
+
+} // namespace core::extract
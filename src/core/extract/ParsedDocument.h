@@ -0,0 +1,134 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <gumbo.h>
+
+namespace core::extract {
+
+enum class NodeKind : std::uint8_t { Element, Text, Whitespace, CData, Comment };
+
+// One HTML payload parsed once by Gumbo and flattened into a compact, read-only node
+// table. Nodes are numbered in document order (pre-order) and stored as parallel
+// arrays, so the subtree of n is exactly the id range [n, subtreeEnd(n)) and walking
+// it is a linear scan; skipping a subtree is one jump. The Gumbo tree is dropped as
+// soon as the table is built. Text and attribute strings live in one pool; class
+// attributes are split into interned tokens at build time.
+//
+// Immutable after construction and safe to share between threads. <template> elements
+// are kept but their (inert) contents are not, as in the browser DOM.
+class ParsedDocument {
+public:
+  using NodeId = std::uint32_t;
+  static constexpr NodeId kNone = 0xFFFFFFFFu;
+
+  ParsedDocument() = default;
+  // html is only read during the call; source offsets index into it.
+  explicit ParsedDocument(std::string_view html);
+  ParsedDocument(ParsedDocument&&) noexcept = default;
+  ParsedDocument& operator=(ParsedDocument&&) noexcept = default;
+  ParsedDocument(const ParsedDocument&) = delete;
+  ParsedDocument& operator=(const ParsedDocument&) = delete;
+
+  bool empty() const { return kind_.empty(); }
+  std::size_t size() const { return kind_.size(); }
+  std::size_t sourceSize() const { return sourceSize_; }
+  // The <html> element; kNone for an empty document.
+  NodeId root() const { return empty() ? kNone : 0; }
+
+  NodeKind kind(NodeId n) const { return kind_[n]; }
+  bool isElement(NodeId n) const { return kind_[n] == NodeKind::Element; }
+  // GUMBO_TAG_UNKNOWN for non-elements and unrecognized tags.
+  GumboTag tag(NodeId n) const { return static_cast<GumboTag>(tag_[n]); }
+  bool is(NodeId n, GumboTag t) const { return kind_[n] == NodeKind::Element && tag_[n] == t; }
+
+  NodeId parent(NodeId n) const { return parent_[n]; }
+  NodeId subtreeEnd(NodeId n) const { return end_[n]; }
+  NodeId firstChild(NodeId n) const { return n + 1 < end_[n] ? n + 1 : kNone; }
+  NodeId nextSibling(NodeId n) const {
+    const NodeId p = parent_[n];
+    return p != kNone && end_[n] < end_[p] ? end_[n] : kNone;
+  }
+
+  // Content of a text, whitespace, CDATA or comment node; empty for elements.
+  std::string_view text(NodeId n) const;
+
+  // Attribute value, or an empty view when absent (see hasAttr). Names are lowercase.
+  std::string_view attr(NodeId n, std::string_view name) const;
+  bool hasAttr(NodeId n, std::string_view name) const;
+  std::size_t attrCount(NodeId n) const { return attrCount_[n]; }
+  std::string_view attrName(NodeId n, std::size_t i) const { return slice(attrName_[attrFirst_[n] + i]); }
+  std::string_view attrValue(NodeId n, std::size_t i) const { return slice(attrValue_[attrFirst_[n] + i]); }
+
+  // Interned class token, kNone if no element in the document carries it. Resolve once
+  // and test many nodes with the id overload.
+  std::uint32_t classId(std::string_view cls) const;
+  bool hasClass(NodeId n, std::uint32_t cls) const;
+  bool hasClass(NodeId n, std::string_view cls) const { return hasClass(n, classId(cls)); }
+  // Interned class tokens of an element, in attribute order.
+  std::span<const std::uint32_t> classes(NodeId n) const { return {classes_.data() + classFirst_[n], classCount_[n]}; }
+
+  // Byte range of an element in the source, end tag included when present; for other
+  // nodes the start offset only.
+  std::size_t sourceBegin(NodeId n) const { return srcBegin_[n]; }
+  std::size_t sourceEnd(NodeId n) const { return srcEnd_[n]; }
+
+  // Concatenated text of the subtree: every text node followed by one space, whitespace
+  // runs collapsed to their first character. Subtrees rooted at an element for which
+  // skip(tag) is true are left out, n itself included.
+  template <class SkipFn> void appendText(NodeId n, std::string& out, SkipFn&& skip) const {
+    const std::size_t start = out.size();
+    for (NodeId i = n, e = end_[n]; i < e; ++i) {
+      if (kind_[i] == NodeKind::Element) {
+        if (skip(static_cast<GumboTag>(tag_[i]))) i = end_[i] - 1;
+      } else if (kind_[i] == NodeKind::Text) {
+        out += text(i);
+        out.push_back(' ');
+      }
+    }
+    collapseWhitespace(out, start);
+  }
+  std::string textContent(NodeId n) const {
+    std::string out;
+    appendText(n, out, [](GumboTag) { return false; });
+    return out;
+  }
+
+private:
+  struct Span {
+    std::uint32_t offset = 0;
+    std::uint32_t length = 0;
+  };
+
+  // Node table, one entry per node.
+  std::vector<NodeKind> kind_;
+  std::vector<std::uint16_t> tag_;
+  std::vector<NodeId> parent_;
+  std::vector<NodeId> end_;
+  std::vector<std::uint32_t> srcBegin_;
+  std::vector<std::uint32_t> srcEnd_;
+  std::vector<Span> text_;                // text nodes; empty span for elements
+  std::vector<std::uint32_t> attrFirst_;  // into attrName_/attrValue_
+  std::vector<std::uint16_t> attrCount_;
+  std::vector<std::uint32_t> classFirst_; // into classes_
+  std::vector<std::uint16_t> classCount_;
+
+  std::vector<Span> attrName_;
+  std::vector<Span> attrValue_;
+  std::vector<std::uint32_t> classes_;
+  std::unordered_map<std::string, std::uint32_t> classIds_;
+  std::string pool_;
+  std::size_t sourceSize_ = 0;
+
+  std::string_view slice(Span s) const { return std::string_view(pool_).substr(s.offset, s.length); }
+  Span intern(std::string_view s);
+  void build(const GumboNode* root);
+  void addClasses(std::string_view value);
+  static void collapseWhitespace(std::string& s, std::size_t from);
+};
+
+} // namespace core::extract
@@ -0,0 +1,428 @@
+#include "core/extract/Selector.h"
+#include "util/Hash.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <unordered_map>
+
+namespace core::extract {
+
+namespace {
+
+using NodeId = ParsedDocument::NodeId;
+
+// Keys put into the ancestor filter: tags and class tokens by number, ids by content.
+std::uint64_t mix(std::uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return x;
+}
+std::uint64_t tagKey(std::uint32_t tag) { return mix((1ULL << 32) | tag); }
+std::uint64_t classKey(std::uint32_t cls) { return mix((2ULL << 32) | cls); }
+std::uint64_t idKey(std::string_view id) { return mix(util::xxh64(id) ^ 3); }
+
+// Counting Bloom filter over the current ancestor chain (two probes, 4096 counters).
+// A counter that saturates stays saturated, which only costs false positives.
+class AncestorFilter {
+public:
+  void add(std::uint64_t h) {
+    for (std::size_t i : {slot1(h), slot2(h)}) {
+      if (c_[i] != 0xFF) ++c_[i];
+    }
+  }
+  void remove(std::uint64_t h) {
+    for (std::size_t i : {slot1(h), slot2(h)}) {
+      if (c_[i] != 0xFF && c_[i] != 0) --c_[i];
+    }
+  }
+  bool mayContain(std::uint64_t h) const { return c_[slot1(h)] && c_[slot2(h)]; }
+
+private:
+  std::array<std::uint8_t, 4096> c_{};
+  static std::size_t slot1(std::uint64_t h) { return h & 4095; }
+  static std::size_t slot2(std::uint64_t h) { return (h >> 32) & 4095; }
+};
+
+template <class Fn> void forEachKey(const ParsedDocument& doc, NodeId n, Fn&& fn) {
+  if (doc.tag(n) != GUMBO_TAG_UNKNOWN) fn(tagKey(doc.tag(n)));
+  for (std::uint32_t c : doc.classes(n)) fn(classKey(c));
+  if (doc.hasAttr(n, "id")) fn(idKey(doc.attr(n, "id")));
+}
+
+NodeId previousElement(const ParsedDocument& doc, NodeId n) {
+  const NodeId p = doc.parent(n);
+  if (p == ParsedDocument::kNone) return ParsedDocument::kNone;
+  NodeId last = ParsedDocument::kNone;
+  for (NodeId c = doc.firstChild(p); c != n; c = doc.nextSibling(c)) {
+    if (doc.isElement(c)) last = c;
+  }
+  return last;
+}
+
+bool isIdentChar(char c) {
+  return std::isalnum((unsigned char)c) || c == '-' || c == '_' || (unsigned char)c >= 0x80;
+}
+
+// Recursive-descent parser for one selector list. Compounds come out left to right.
+struct Parser {
+  std::string_view s;
+  std::size_t pos = 0;
+  std::string error;
+
+  bool atEnd() const { return pos >= s.size(); }
+  char peek() const { return atEnd() ? '\0' : s[pos]; }
+  bool skipWs() {
+    const std::size_t start = pos;
+    while (!atEnd() && std::isspace((unsigned char)s[pos])) ++pos;
+    return pos != start;
+  }
+  bool fail(std::string msg) {
+    if (error.empty()) error = std::move(msg) + " at offset " + std::to_string(pos);
+    return false;
+  }
+  bool ident(std::string& out) {
+    const std::size_t start = pos;
+    while (!atEnd() && isIdentChar(s[pos])) ++pos;
+    if (peek() == '\\') return fail("escapes are not supported");
+    if (pos == start) return fail("expected a name");
+    out.assign(s.substr(start, pos - start));
+    return true;
+  }
+  bool value(std::string& out) {
+    const char q = peek();
+    if (q != '"' && q != '\'') return ident(out);
+    const std::size_t start = ++pos;
+    while (!atEnd() && s[pos] != q) {
+      if (s[pos] == '\\') return fail("escapes are not supported");
+      ++pos;
+    }
+    if (atEnd()) return fail("unterminated string");
+    out.assign(s.substr(start, pos - start));
+    ++pos;
+    return true;
+  }
+};
+
+std::string lower(std::string s) {
+  std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+  return s;
+}
+
+} // namespace
+
+struct SelectorSet::Bound {
+  std::vector<std::uint32_t> classIds;   // per instruction, for Op::Class
+  std::vector<char> viable;              // per complex: every class it needs exists
+  std::vector<std::vector<std::uint64_t>> ancestorKeys; // per complex
+};
+
+std::uint32_t SelectorSet::string(std::string_view s) {
+  strings_.emplace_back(s);
+  return (std::uint32_t)(strings_.size() - 1);
+}
+
+int SelectorSet::add(std::string_view selectorList, std::string* error) {
+  Parser p{selectorList, 0, {}};
+  const std::size_t instrMark = instrs_.size();
+  const std::size_t compoundMark = compounds_.size();
+  const std::size_t complexMark = complexes_.size();
+  const std::size_t stringMark = strings_.size();
+
+  auto parseCompound = [&](std::vector<Instr>& out) -> bool {
+    const bool universal = p.peek() == '*';
+    if (universal) {
+      ++p.pos;
+    } else if (isIdentChar(p.peek())) {
+      std::string name;
+      if (!p.ident(name)) return false;
+      name = lower(std::move(name));
+      GumboTag tag = gumbo_tag_enum(name.c_str());
+      if (tag == GUMBO_TAG_UNKNOWN) return p.fail("unknown tag '" + name + "'");
+      out.push_back({Op::Tag, (std::uint16_t)tag, 0, 0});
+    }
+    for (;;) {
+      const char c = p.peek();
+      if (c == '#' || c == '.') {
+        ++p.pos;
+        std::string name;
+        if (!p.ident(name)) return false;
+        out.push_back({c == '#' ? Op::Id : Op::Class, 0, string(name), 0});
+      } else if (c == '[') {
+        ++p.pos;
+        p.skipWs();
+        std::string name;
+        if (!p.ident(name)) return false;
+        p.skipWs();
+        Instr in{Op::AttrExists, 0, string(lower(std::move(name))), 0};
+        if (p.peek() != ']') {
+          switch (p.peek()) {
+            case '=': in.op = Op::AttrEquals; break;
+            case '~': in.op = Op::AttrIncludes; break;
+            case '|': in.op = Op::AttrDash; break;
+            case '^': in.op = Op::AttrPrefix; break;
+            case '$': in.op = Op::AttrSuffix; break;
+            case '*': in.op = Op::AttrContains; break;
+            default: return p.fail("expected an attribute operator");
+          }
+          ++p.pos;
+          if (in.op != Op::AttrEquals) {
+            if (p.peek() != '=') return p.fail("expected '='");
+            ++p.pos;
+          }
+          p.skipWs();
+          std::string v;
+          if (!p.value(v)) return false;
+          in.b = string(v);
+          p.skipWs();
+        }
+        if (p.peek() != ']') return p.fail("expected ']'");
+        ++p.pos;
+        out.push_back(in);
+      } else if (c == ':') {
+        return p.fail("pseudo-classes are not supported");
+      } else {
+        break;
+      }
+    }
+    if (out.empty() && !universal) return p.fail("expected a selector");
+    // Cheapest tests first: tag, id, class, then attributes.
+    std::stable_sort(out.begin(), out.end(), [](const Instr& a, const Instr& b) { return a.op < b.op; });
+    return true;
+  };
+
+  auto parseComplex = [&]() -> bool {
+    std::vector<std::vector<Instr>> parts;
+    std::vector<Combinator> joins; // joins[k] sits between parts[k] and parts[k + 1]
+    p.skipWs();
+    for (;;) {
+      parts.emplace_back();
+      if (!parseCompound(parts.back())) return false;
+      const bool ws = p.skipWs();
+      const char c = p.peek();
+      if (p.atEnd() || c == ',') break;
+      if (c == '>' || c == '+' || c == '~') {
+        ++p.pos;
+        p.skipWs();
+        joins.push_back(c == '>' ? Combinator::Child : c == '+' ? Combinator::Adjacent : Combinator::Sibling);
+      } else if (ws) {
+        joins.push_back(Combinator::Descendant);
+      } else {
+        return p.fail(std::string("unexpected '") + c + "'");
+      }
+    }
+    Complex cx;
+    cx.list = (std::uint32_t)lists_;
+    cx.first = (std::uint32_t)compounds_.size();
+    cx.count = (std::uint32_t)parts.size();
+    for (std::size_t k = parts.size(); k-- > 0; ) {
+      Compound c;
+      c.first = (std::uint32_t)instrs_.size();
+      c.count = (std::uint32_t)parts[k].size();
+      c.left = k > 0 ? joins[k - 1] : Combinator::None;
+      instrs_.insert(instrs_.end(), parts[k].begin(), parts[k].end());
+      compounds_.push_back(c);
+    }
+    complexes_.push_back(cx);
+    return true;
+  };
+
+  bool ok = true;
+  for (;;) {
+    if (!parseComplex()) {
+      ok = false;
+      break;
+    }
+    if (p.atEnd()) break;
+    ++p.pos; // ','
+  }
+  if (!ok) {
+    instrs_.resize(instrMark);
+    compounds_.resize(compoundMark);
+    complexes_.resize(complexMark);
+    strings_.resize(stringMark);
+    if (error) *error = p.error;
+    return -1;
+  }
+  return (int)lists_++;
+}
+
+bool SelectorSet::compoundMatches(const ParsedDocument& doc, const Bound& bound, const Compound& c, NodeId n) const {
+  if (!doc.isElement(n)) return false;
+  for (std::uint32_t i = c.first, e = c.first + c.count; i < e; ++i) {
+    const Instr& in = instrs_[i];
+    switch (in.op) {
+      case Op::Tag:
+        if (doc.tag(n) != in.tag) return false;
+        break;
+      case Op::Id:
+        if (!doc.hasAttr(n, "id") || doc.attr(n, "id") != strings_[in.a]) return false;
+        break;
+      case Op::Class:
+        if (!doc.hasClass(n, bound.classIds[i])) return false;
+        break;
+      default: {
+        const std::string& name = strings_[in.a];
+        if (!doc.hasAttr(n, name)) return false;
+        if (in.op == Op::AttrExists) break;
+        const std::string_view v = doc.attr(n, name);
+        const std::string& want = strings_[in.b];
+        bool hit = false;
+        switch (in.op) {
+          case Op::AttrEquals: hit = v == want; break;
+          case Op::AttrDash: hit = v == want || (v.size() > want.size() && v.substr(0, want.size()) == want && v[want.size()] == '-'); break;
+          case Op::AttrPrefix: hit = !want.empty() && v.substr(0, want.size()) == want; break;
+          case Op::AttrSuffix: hit = !want.empty() && v.size() >= want.size() && v.substr(v.size() - want.size()) == want; break;
+          case Op::AttrContains: hit = !want.empty() && v.find(want) != std::string_view::npos; break;
+          case Op::AttrIncludes: {
+            for (std::size_t i0 = 0; i0 < v.size() && !hit; ) {
+              while (i0 < v.size() && std::isspace((unsigned char)v[i0])) ++i0;
+              std::size_t j = i0;
+              while (j < v.size() && !std::isspace((unsigned char)v[j])) ++j;
+              hit = j > i0 && v.substr(i0, j - i0) == want;
+              i0 = j;
+            }
+            break;
+          }
+          default: break;
+        }
+        if (!hit) return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool SelectorSet::matchFrom(const ParsedDocument& doc, const Bound& bound, const Complex& cx, std::uint32_t k, NodeId n) const {
+  const Compound& c = compounds_[cx.first + k];
+  if (!compoundMatches(doc, bound, c, n)) return false;
+  if (k + 1 == cx.count) return true;
+  switch (c.left) {
+    case Combinator::Child: {
+      const NodeId p = doc.parent(n);
+      return p != ParsedDocument::kNone && matchFrom(doc, bound, cx, k + 1, p);
+    }
+    case Combinator::Descendant:
+      for (NodeId p = doc.parent(n); p != ParsedDocument::kNone; p = doc.parent(p)) {
+        if (matchFrom(doc, bound, cx, k + 1, p)) return true;
+      }
+      return false;
+    case Combinator::Adjacent: {
+      const NodeId s = previousElement(doc, n);
+      return s != ParsedDocument::kNone && matchFrom(doc, bound, cx, k + 1, s);
+    }
+    case Combinator::Sibling: {
+      const NodeId p = doc.parent(n);
+      if (p == ParsedDocument::kNone) return false;
+      for (NodeId s = doc.firstChild(p); s != n; s = doc.nextSibling(s)) {
+        if (doc.isElement(s) && matchFrom(doc, bound, cx, k + 1, s)) return true;
+      }
+      return false;
+    }
+    case Combinator::None:
+      break;
+  }
+  return true;
+}
+
+std::vector<std::vector<SelectorSet::NodeId>> SelectorSet::match(const ParsedDocument& doc) const {
+  std::vector<std::vector<NodeId>> out(lists_);
+  if (doc.empty() || complexes_.empty()) return out;
+
+  // Bind the program to this document: class names become the document's class tokens,
+  // and each complex selector is filed under the key of its rightmost compound.
+  Bound bound;
+  bound.classIds.assign(instrs_.size(), ParsedDocument::kNone);
+  bound.viable.assign(complexes_.size(), 1);
+  bound.ancestorKeys.resize(complexes_.size());
+  std::unordered_map<std::string_view, std::vector<std::uint32_t>> byId;
+  std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> byClass;
+  std::vector<std::vector<std::uint32_t>> byTag(GUMBO_TAG_LAST + 1);
+  std::vector<std::uint32_t> universal;
+
+  for (std::uint32_t ci = 0; ci < complexes_.size(); ++ci) {
+    const Complex& cx = complexes_[ci];
+    for (std::uint32_t k = 0; k < cx.count && bound.viable[ci]; ++k) {
+      const Compound& c = compounds_[cx.first + k];
+      // Compounds left of a child or descendant combinator are ancestors of the subject.
+      const bool ancestor = k > 0 && (compounds_[cx.first + k - 1].left == Combinator::Child
+                                   || compounds_[cx.first + k - 1].left == Combinator::Descendant);
+      for (std::uint32_t i = c.first; i < c.first + c.count; ++i) {
+        const Instr& in = instrs_[i];
+        if (in.op == Op::Class) {
+          bound.classIds[i] = doc.classId(strings_[in.a]);
+          if (bound.classIds[i] == ParsedDocument::kNone) bound.viable[ci] = 0;
+          else if (ancestor) bound.ancestorKeys[ci].push_back(classKey(bound.classIds[i]));
+        } else if (ancestor && in.op == Op::Tag) {
+          bound.ancestorKeys[ci].push_back(tagKey(in.tag));
+        } else if (ancestor && in.op == Op::Id) {
+          bound.ancestorKeys[ci].push_back(idKey(strings_[in.a]));
+        }
+      }
+    }
+    if (!bound.viable[ci]) continue;
+
+    const Compound& subject = compounds_[cx.first];
+    const Instr* best = nullptr;
+    for (std::uint32_t i = subject.first; i < subject.first + subject.count; ++i) {
+      const Instr& in = instrs_[i];
+      if (in.op == Op::Id) { best = &in; break; }
+      if (in.op == Op::Class && (!best || best->op == Op::Tag)) best = &in;
+      if (in.op == Op::Tag && !best) best = &in;
+    }
+    if (!best) universal.push_back(ci);
+    else if (best->op == Op::Id) byId[strings_[best->a]].push_back(ci);
+    else if (best->op == Op::Class) byClass[bound.classIds[best - instrs_.data()]].push_back(ci);
+    else byTag[best->tag].push_back(ci);
+  }
+
+  AncestorFilter filter;
+  std::vector<NodeId> ancestors;
+  std::vector<NodeId> lastTried(complexes_.size(), ParsedDocument::kNone);
+
+  auto tryComplex = [&](std::uint32_t ci, NodeId n) {
+    if (lastTried[ci] == n) return; // reachable through two of the node's classes
+    lastTried[ci] = n;
+    const Complex& cx = complexes_[ci];
+    if (!compoundMatches(doc, bound, compounds_[cx.first], n)) return;
+    for (std::uint64_t key : bound.ancestorKeys[ci]) {
+      if (!filter.mayContain(key)) return;
+    }
+    if (cx.count > 1 && !matchFrom(doc, bound, cx, 0, n)) return;
+    auto& hits = out[cx.list];
+    if (hits.empty() || hits.back() != n) hits.push_back(n);
+  };
+
+  for (NodeId n = 0; n < doc.size(); ++n) {
+    while (!ancestors.empty() && doc.subtreeEnd(ancestors.back()) <= n) {
+      forEachKey(doc, ancestors.back(), [&](std::uint64_t h) { filter.remove(h); });
+      ancestors.pop_back();
+    }
+    if (!doc.isElement(n)) continue;
+
+    if (!byId.empty() && doc.hasAttr(n, "id")) {
+      if (auto it = byId.find(doc.attr(n, "id")); it != byId.end()) {
+        for (std::uint32_t ci : it->second) tryComplex(ci, n);
+      }
+    }
+    for (std::uint32_t cls : doc.classes(n)) {
+      if (auto it = byClass.find(cls); it != byClass.end()) {
+        for (std::uint32_t ci : it->second) tryComplex(ci, n);
+      }
+    }
+    if (doc.tag(n) <= GUMBO_TAG_LAST) {
+      for (std::uint32_t ci : byTag[doc.tag(n)]) tryComplex(ci, n);
+    }
+    for (std::uint32_t ci : universal) tryComplex(ci, n);
+
+    if (doc.firstChild(n) != ParsedDocument::kNone) {
+      forEachKey(doc, n, [&](std::uint64_t h) { filter.add(h); });
+      ancestors.push_back(n);
+    }
+  }
+  return out;
+}
+
+} // namespace core::extract
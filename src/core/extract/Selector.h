@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/extract/ParsedDocument.h"
+
+namespace core::extract {
+
+// CSS selectors compiled into a flat matcher program and evaluated together over a
+// ParsedDocument in one document-order pass.
+//
+// Supported: type and universal selectors, #id, .class, attribute selectors
+// ([a], [a=v], [a~=v], [a|=v], [a^=v], [a$=v], [a*=v], quoted or bare values),
+// the descendant, child (>), adjacent (+) and general sibling (~) combinators, and
+// comma-separated lists. Pseudo-classes and namespaces are rejected at compile time.
+//
+// Matching is right to left. Each selector is filed under the most selective key of its
+// rightmost compound (id, then class, then tag), so a node only runs the selectors that
+// can possibly match it. Before walking up the tree, the tags, ids and classes the
+// selector needs from ancestors are checked against a counting Bloom filter of the
+// current ancestor chain, which rejects most candidates without touching a parent.
+//
+// Compile once, then match() any number of documents; match() is const and may run
+// concurrently on different documents.
+class SelectorSet {
+public:
+  using NodeId = ParsedDocument::NodeId;
+
+  // Compiles a selector list and returns its index, or -1 with *error set.
+  int add(std::string_view selectorList, std::string* error = nullptr);
+
+  std::size_t size() const { return lists_; }
+  bool empty() const { return lists_ == 0; }
+
+  // Matching elements per added list, each in document order without duplicates.
+  std::vector<std::vector<NodeId>> match(const ParsedDocument& doc) const;
+
+private:
+  enum class Op : std::uint8_t {
+    Tag, Id, Class,
+    AttrExists, AttrEquals, AttrIncludes, AttrDash, AttrPrefix, AttrSuffix, AttrContains
+  };
+  enum class Combinator : std::uint8_t { None, Descendant, Child, Adjacent, Sibling };
+
+  // One simple-selector test. a/b index into strings_ (attribute name / value, class or
+  // id), tag holds the GumboTag.
+  struct Instr {
+    Op op;
+    std::uint16_t tag = 0;
+    std::uint32_t a = 0;
+    std::uint32_t b = 0;
+  };
+  // A compound selector: instrs_[first, first + count), joined to the compound on its
+  // left by `left`.
+  struct Compound {
+    std::uint32_t first = 0;
+    std::uint32_t count = 0;
+    Combinator left = Combinator::None;
+  };
+  // One complex selector; compounds_[first..] from the subject (rightmost) leftwards.
+  struct Complex {
+    std::uint32_t list = 0;
+    std::uint32_t first = 0;
+    std::uint32_t count = 0;
+  };
+
+  std::vector<Instr> instrs_;
+  std::vector<Compound> compounds_;
+  std::vector<Complex> complexes_;
+  std::vector<std::string> strings_;
+  std::size_t lists_ = 0;
+
+  struct Bound;
+  std::uint32_t string(std::string_view s);
+  bool compoundMatches(const ParsedDocument& doc, const Bound& bound, const Compound& c, NodeId n) const;
+  bool matchFrom(const ParsedDocument& doc, const Bound& bound, const Complex& cx, std::uint32_t k, NodeId n) const;
+};
+
+} // namespace core::extract
@@ -0,0 +1,151 @@
+#include "core/extract/StructuredData.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <array>
+
+namespace core::extract {
+
+namespace {
+
+using json = nlohmann::json;
+
+// Keeps one frame per open object and records only the handful of keys we need;
+// every other value is dropped as soon as the parser hands it over.
+class JsonLdHandler : public nlohmann::json_sax<json> {
+public:
+  explicit JsonLdHandler(std::vector<StructuredEntity>& out) : out_(out) {}
+
+  bool null() override { return true; }
+  bool boolean(bool) override { return true; }
+  bool number_integer(number_integer_t) override { return true; }
+  bool number_unsigned(number_unsigned_t) override { return true; }
+  bool number_float(number_float_t, const string_t&) override { return true; }
+  bool binary(binary_t&) override { return true; }
+
+  bool string(string_t& val) override {
+    Frame* f = owner();
+    if (!f) return true;
+    const std::string& k = f->key;
+    StructuredEntity& e = f->entity;
+    if (k == "@type") {
+      if (e.type.empty()) e.type = std::move(val);
+    } else if (k == "name") {
+      if (e.name.empty()) e.name = std::move(val);
+    } else if (k == "headline") {
+      if (f->headline.empty()) f->headline = std::move(val);
+    } else if (k == "@id") {
+      if (e.id.empty()) e.id = std::move(val);
+    } else if (k == "url") {
+      if (e.url.empty()) e.url = std::move(val);
+    }
+    return true;
+  }
+
+  bool start_object(std::size_t) override {
+    frames_.emplace_back();
+    containers_.push_back(true);
+    return true;
+  }
+
+  bool key(string_t& val) override {
+    if (!frames_.empty()) frames_.back().key = std::move(val);
+    return true;
+  }
+
+  bool end_object() override {
+    if (frames_.empty()) return true;
+    Frame f = std::move(frames_.back());
+    frames_.pop_back();
+    containers_.pop_back();
+    if (!f.entity.type.empty()) {
+      StructuredEntity& e = f.entity;
+      e.kind = StructuredData::classify(e.type);
+      if (e.name.empty()) e.name = std::move(f.headline);
+      e.source = "jsonld";
+      out_.push_back(std::move(e));
+    }
+    return true;
+  }
+
+  bool start_array(std::size_t) override {
+    containers_.push_back(false);
+    return true;
+  }
+
+  bool end_array() override {
+    if (!containers_.empty()) containers_.pop_back();
+    return true;
+  }
+
+  bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override {
+    return false;
+  }
+
+private:
+  struct Frame {
+    StructuredEntity entity;
+    std::string key;
+    std::string headline;
+  };
+
+  std::vector<StructuredEntity>& out_;
+  std::vector<Frame> frames_;
+  std::vector<bool> containers_; // true = object, false = array
+
+  // Object a scalar belongs to. Scalars inside arrays ("@type": ["A","B"]) count for
+  // the object holding the array, but only one level deep.
+  Frame* owner() {
+    if (frames_.empty() || containers_.empty()) return nullptr;
+    if (containers_.back()) return &frames_.back();
+    if (containers_.size() >= 2 && containers_[containers_.size() - 2]) return &frames_.back();
+    return nullptr;
+  }
+};
+
+} // namespace
+
+bool StructuredData::parseJsonLd(std::string_view jsonText, std::vector<StructuredEntity>& out) {
+  JsonLdHandler handler(out);
+  return json::sax_parse(jsonText.begin(), jsonText.end(), &handler, json::input_format_t::json, false);
+}
+
+std::string_view StructuredData::localType(std::string_view t) {
+  auto cut = t.find_last_of("/#:");
+  if (cut != std::string_view::npos) t = t.substr(cut + 1);
+  return t;
+}
+
+StructuredKind StructuredData::classify(std::string_view schemaType) {
+  const std::string_view t = localType(schemaType);
+
+  static constexpr std::array<std::string_view, 2> persons = {"Person", "Patient"};
+  static constexpr std::array<std::string_view, 12> orgs = {
+    "Organization", "Corporation", "NGO", "GovernmentOrganization", "EducationalOrganization",
+    "CollegeOrUniversity", "NewsMediaOrganization", "LocalBusiness", "SportsTeam",
+    "SportsOrganization", "MedicalOrganization", "Airline"};
+  static constexpr std::array<std::string_view, 11> places = {
+    "Place", "City", "Country", "State", "AdministrativeArea", "PostalAddress",
+    "Landmark", "LandmarksOrHistoricalBuildings", "TouristAttraction", "Airport", "Continent"};
+  static constexpr std::array<std::string_view, 7> articles = {
+    "Article", "NewsArticle", "BlogPosting", "ScholarlyArticle", "TechArticle", "Report", "Review"};
+
+  auto in = [&](const auto& list) { return std::find(list.begin(), list.end(), t) != list.end(); };
+  if (in(persons)) return StructuredKind::Person;
+  if (in(orgs)) return StructuredKind::Organization;
+  if (in(places)) return StructuredKind::Place;
+  if (in(articles)) return StructuredKind::Article;
+  return StructuredKind::Other;
+}
+
+const char* StructuredData::kindName(StructuredKind k) {
+  switch (k) {
+    case StructuredKind::Person: return "person";
+    case StructuredKind::Organization: return "organization";
+    case StructuredKind::Place: return "place";
+    case StructuredKind::Article: return "article";
+    case StructuredKind::Other: return "other";
+  }
+  return "other";
+}
+
+} // namespace core::extract
@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace core::extract {
+
+enum class StructuredKind { Person, Organization, Place, Article, Other };
+
+// A typed node from JSON-LD or microdata, flattened out of whatever graph it sat in.
+struct StructuredEntity {
+  StructuredKind kind = StructuredKind::Other;
+  std::string type;   // schema.org type as written, e.g. "NewsArticle"
+  std::string name;   // name, or headline for articles
+  std::string id;     // @id / itemid
+  std::string url;
+  std::string source; // "jsonld" or "microdata"
+};
+
+class StructuredData {
+public:
+  // Parses one <script type="application/ld+json"> body with a SAX handler, so large
+  // graphs are never materialized as a DOM. Appends every typed node, nested ones
+  // included. Returns false on malformed JSON (entities seen so far are kept).
+  static bool parseJsonLd(std::string_view json, std::vector<StructuredEntity>& out);
+
+  // "https://schema.org/Person", "schema:Person" and "Person" all classify the same.
+  static std::string_view localType(std::string_view schemaType);
+  static StructuredKind classify(std::string_view schemaType);
+  static const char* kindName(StructuredKind k);
+};
+
+} // namespace core::extract
@@ -0,0 +1,372 @@
+#include "core/extract/TableExtractor.h"
+#include <algorithm>
+#include <cctype>
+#include <unordered_map>
+
+namespace core::extract {
+
+namespace {
+
+constexpr int kMaxColspan = 1000;   // limits from the HTML table model
+constexpr int kMaxRowspan = 65534;
+
+struct RawCell {
+  std::uint32_t text = 0;
+  bool header = false;
+  int rowspan = 1; // 0 = to the end of the row group
+  int colspan = 1;
+};
+
+struct RawRow {
+  GumboTag group = GUMBO_TAG_TBODY; // THEAD/TBODY/TFOOT
+  std::size_t groupIndex = 0;       // which row group, for rowspan=0
+  std::vector<RawCell> cells;
+};
+
+using NodeId = ParsedDocument::NodeId;
+
+int spanAttr(const ParsedDocument& doc, NodeId n, const char* name, int def, int max) {
+  std::string_view a = doc.attr(n, name);
+  std::size_t i = 0;
+  while (i < a.size() && std::isspace((unsigned char)a[i])) ++i;
+  if (i == a.size() || !std::isdigit((unsigned char)a[i])) return def;
+  long v = 0;
+  while (i < a.size() && std::isdigit((unsigned char)a[i]) && v <= max) v = v * 10 + (a[i++] - '0');
+  return (int)std::min<long>(v, max);
+}
+
+// Visible text of a cell with whitespace collapsed; nested tables are skipped.
+std::string cellText(const ParsedDocument& doc, NodeId cell) {
+  std::string out;
+  bool pendingSpace = false;
+  for (NodeId i = cell + 1, e = doc.subtreeEnd(cell); i < e; ++i) {
+    switch (doc.kind(i)) {
+      case NodeKind::Text:
+      case NodeKind::Whitespace:
+      case NodeKind::CData:
+        for (char ch : doc.text(i)) {
+          if (std::isspace((unsigned char)ch)) { pendingSpace = true; continue; }
+          if (pendingSpace && !out.empty()) out.push_back(' ');
+          pendingSpace = false;
+          out.push_back(ch);
+        }
+        break;
+      case NodeKind::Element: {
+        GumboTag t = doc.tag(i);
+        if (t == GUMBO_TAG_TABLE || t == GUMBO_TAG_SCRIPT || t == GUMBO_TAG_STYLE) i = doc.subtreeEnd(i) - 1;
+        else if (t == GUMBO_TAG_BR) pendingSpace = true;
+        break;
+      }
+      case NodeKind::Comment:
+        break;
+    }
+  }
+  return out;
+}
+
+class Builder {
+public:
+  Table t;
+  std::vector<RawRow> rows;
+
+  Builder() { t.strings.emplace_back(); }
+
+  std::uint32_t intern(std::string s) {
+    if (s.empty()) return 0;
+    t.strings.push_back(std::move(s));
+    return (std::uint32_t)(t.strings.size() - 1);
+  }
+
+  void collectRow(const ParsedDocument& doc, NodeId tr, GumboTag group, std::size_t groupIndex) {
+    RawRow row;
+    row.group = group;
+    row.groupIndex = groupIndex;
+    for (NodeId c = doc.firstChild(tr); c != ParsedDocument::kNone; c = doc.nextSibling(c)) {
+      if (!doc.is(c, GUMBO_TAG_TD) && !doc.is(c, GUMBO_TAG_TH)) continue;
+      RawCell cell;
+      cell.header = doc.tag(c) == GUMBO_TAG_TH;
+      cell.colspan = std::max(1, spanAttr(doc, c, "colspan", 1, kMaxColspan));
+      cell.rowspan = spanAttr(doc, c, "rowspan", 1, kMaxRowspan);
+      cell.text = intern(cellText(doc, c));
+      row.cells.push_back(cell);
+    }
+    rows.push_back(std::move(row));
+  }
+
+  void collect(const ParsedDocument& doc, NodeId table) {
+    std::size_t groupIndex = 0;
+    for (NodeId c = doc.firstChild(table); c != ParsedDocument::kNone; c = doc.nextSibling(c)) {
+      if (!doc.isElement(c)) continue;
+      GumboTag tag = doc.tag(c);
+      if (tag == GUMBO_TAG_CAPTION && t.caption.empty()) {
+        t.caption = cellText(doc, c);
+      } else if (tag == GUMBO_TAG_TR) {
+        collectRow(doc, c, GUMBO_TAG_TBODY, groupIndex);
+      } else if (tag == GUMBO_TAG_THEAD || tag == GUMBO_TAG_TBODY || tag == GUMBO_TAG_TFOOT) {
+        ++groupIndex;
+        for (NodeId tr = doc.firstChild(c); tr != ParsedDocument::kNone; tr = doc.nextSibling(tr)) {
+          if (doc.is(tr, GUMBO_TAG_TR)) collectRow(doc, tr, tag, groupIndex);
+        }
+        ++groupIndex;
+      }
+    }
+  }
+
+  // Places cells on a row-major grid, expanding spans. Each grid slot holds a string
+  // index; a parallel flag marks slots filled by <th> cells.
+  void layout(std::vector<std::vector<std::uint32_t>>& grid, std::vector<std::vector<char>>& isHeader) {
+    std::size_t width = 0;
+    std::vector<int> carryRows;            // remaining rows a span above still covers, per column
+    std::vector<std::uint32_t> carryText;
+    std::vector<char> carryHeader;
+
+    // End (exclusive) of each row's group, for clamping rowspans; one backward pass.
+    std::vector<std::size_t> groupEnds(rows.size());
+    for (std::size_t r = rows.size(); r > 0; --r) {
+      const bool last = (r == rows.size()) || rows[r].groupIndex != rows[r - 1].groupIndex;
+      groupEnds[r - 1] = last ? r : groupEnds[r];
+    }
+
+    grid.resize(rows.size());
+    isHeader.resize(rows.size());
+    for (std::size_t r = 0; r < rows.size(); ++r) {
+      const RawRow& row = rows[r];
+      const std::size_t groupEnd = groupEnds[r];
+
+      std::vector<std::uint32_t>& g = grid[r];
+      std::vector<char>& h = isHeader[r];
+      g.assign(width, 0);
+      h.assign(width, 0);
+
+      auto ensure = [&](std::size_t w) {
+        if (w <= g.size()) return;
+        g.resize(w, 0);
+        h.resize(w, 0);
+        if (carryRows.size() < w) {
+          carryRows.resize(w, 0);
+          carryText.resize(w, 0);
+          carryHeader.resize(w, 0);
+        }
+      };
+
+      std::size_t col = 0;
+      for (const RawCell& cell : row.cells) {
+        while (col < carryRows.size() && carryRows[col] > 0) ++col;
+        ensure(col + cell.colspan);
+        int span = cell.rowspan == 0 ? (int)(groupEnd - r) : std::min<int>(cell.rowspan, (int)(groupEnd - r));
+        for (int k = 0; k < cell.colspan; ++k) {
+          g[col + k] = cell.text;
+          h[col + k] = cell.header;
+          carryRows[col + k] = span; // counts this row; decremented below
+          carryText[col + k] = cell.text;
+          carryHeader[col + k] = cell.header;
+        }
+        col += cell.colspan;
+      }
+
+      for (std::size_t c = 0; c < carryRows.size(); ++c) {
+        if (carryRows[c] <= 0) continue;
+        ensure(c + 1);
+        g[c] = carryText[c];
+        h[c] = carryHeader[c];
+        --carryRows[c];
+      }
+      width = std::max(width, g.size());
+    }
+    for (auto& g : grid) g.resize(width, 0);
+    for (auto& h : isHeader) h.resize(width, 0);
+  }
+};
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Integer: [+-]digits with optional 3-digit "," grouping. Number: integer part,
+// optional ".digits", optional exponent.
+ColumnType classify(const std::string& s) {
+  std::size_t i = 0, n = s.size();
+  if (i < n && (s[i] == '+' || s[i] == '-')) ++i;
+  if (i + 1 < n && s[i] == '0' && isDigit(s[i + 1])) return ColumnType::Text; // "007", zip codes
+  std::size_t groupLen = 0;
+  bool grouped = false, any = false;
+  for (; i < n; ++i) {
+    if (isDigit(s[i])) { any = true; ++groupLen; continue; }
+    if (s[i] == ',' && any && (!grouped ? groupLen <= 3 : groupLen == 3) && i + 1 < n && isDigit(s[i + 1])) {
+      grouped = true;
+      groupLen = 0;
+      continue;
+    }
+    break;
+  }
+  if (!any || (grouped && groupLen != 3)) return ColumnType::Text;
+  if (i == n) return ColumnType::Integer;
+  if (s[i] == '.') {
+    ++i;
+    std::size_t fracStart = i;
+    while (i < n && isDigit(s[i])) ++i;
+    if (i == fracStart) return ColumnType::Text;
+  }
+  if (i < n && (s[i] == 'e' || s[i] == 'E')) {
+    ++i;
+    if (i < n && (s[i] == '+' || s[i] == '-')) ++i;
+    std::size_t expStart = i;
+    while (i < n && isDigit(s[i])) ++i;
+    if (i == expStart) return ColumnType::Text;
+  }
+  return i == n ? ColumnType::Number : ColumnType::Text;
+}
+
+void appendEscaped(std::string& out, const std::string& s) {
+  static const char* hex = "0123456789abcdef";
+  out.push_back('"');
+  for (char c : s) {
+    switch (c) {
+      case '\\': out += "\\\\"; break;
+      case '"': out += "\\\""; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if ((unsigned char)c < 0x20) {
+          out += "\\u00";
+          out.push_back(hex[(c >> 4) & 0xF]);
+          out.push_back(hex[c & 0xF]);
+        } else {
+          out.push_back(c);
+        }
+    }
+  }
+  out.push_back('"');
+}
+
+void appendNumber(std::string& out, const std::string& s) {
+  for (char c : s) {
+    if (c == ',') continue;
+    if (c == '+' && out.back() != 'e' && out.back() != 'E') continue; // JSON has no unary plus
+    out.push_back(c);
+  }
+}
+
+} // namespace
+
+Table TableExtractor::extract(const ParsedDocument& doc, ParsedDocument::NodeId table) {
+  Builder b;
+  if (table >= doc.size() || !doc.isElement(table)) return std::move(b.t);
+  b.collect(doc, table);
+  if (b.rows.empty()) return std::move(b.t);
+
+  std::vector<std::vector<std::uint32_t>> grid;
+  std::vector<std::vector<char>> isHeader;
+  b.layout(grid, isHeader);
+  const std::size_t width = grid.empty() ? 0 : grid[0].size();
+
+  // Header rows: everything in <thead>; otherwise leading rows made only of <th>.
+  std::size_t headerRows = 0;
+  while (headerRows < b.rows.size() && b.rows[headerRows].group == GUMBO_TAG_THEAD) ++headerRows;
+  if (headerRows == 0) {
+    while (headerRows < b.rows.size() && !b.rows[headerRows].cells.empty()
+           && std::all_of(b.rows[headerRows].cells.begin(), b.rows[headerRows].cells.end(),
+                          [](const RawCell& c) { return c.header; })) {
+      ++headerRows;
+    }
+    if (headerRows == b.rows.size()) headerRows = 0; // a table of only <th> is data
+  }
+
+  Table& t = b.t;
+  t.rows = b.rows.size() - headerRows;
+  t.columns.resize(width);
+  std::unordered_map<std::string, int> seenNames;
+  for (std::size_t c = 0; c < width; ++c) {
+    TableColumn& col = t.columns[c];
+    // Multi-row headers join as "Group / Name"; repeats from colspan collapse.
+    std::uint32_t last = 0;
+    for (std::size_t r = 0; r < headerRows; ++r) {
+      std::uint32_t s = grid[r][c];
+      if (s == 0 || s == last) continue;
+      if (!col.name.empty()) col.name += " / ";
+      col.name += t.strings[s];
+      last = s;
+    }
+    if (col.name.empty()) col.name = "col" + std::to_string(c + 1);
+    int& seen = seenNames[col.name];
+    if (++seen > 1) col.name += "_" + std::to_string(seen);
+
+    col.cells.reserve(t.rows);
+    ColumnType type = ColumnType::Empty;
+    for (std::size_t r = headerRows; r < grid.size(); ++r) {
+      std::uint32_t s = grid[r][c];
+      col.cells.push_back(s);
+      if (s == 0 || type == ColumnType::Text) continue;
+      ColumnType v = classify(t.strings[s]);
+      if (v == ColumnType::Text) type = ColumnType::Text;
+      else if (v == ColumnType::Number || type == ColumnType::Number) type = ColumnType::Number;
+      else type = ColumnType::Integer;
+    }
+    col.type = type;
+  }
+  return std::move(b.t);
+}
+
+const char* TableExtractor::typeName(ColumnType t) {
+  switch (t) {
+    case ColumnType::Empty: return "empty";
+    case ColumnType::Integer: return "integer";
+    case ColumnType::Number: return "number";
+    case ColumnType::Text: return "text";
+  }
+  return "text";
+}
+
+void TableExtractor::appendJson(const Table& t, std::string& out) {
+  out += "{\"caption\": ";
+  appendEscaped(out, t.caption);
+  out += ", \"rows\": " + std::to_string(t.rows) + ", \"columns\": [";
+  for (std::size_t c = 0; c < t.columns.size(); ++c) {
+    const TableColumn& col = t.columns[c];
+    const bool numeric = col.type == ColumnType::Integer || col.type == ColumnType::Number;
+    if (c) out += ", ";
+    out += "\n  {\"name\": ";
+    appendEscaped(out, col.name);
+    out += ", \"type\": \"";
+    out += typeName(col.type);
+    out += "\", \"values\": [";
+    for (std::size_t r = 0; r < col.cells.size(); ++r) {
+      if (r) out.push_back(',');
+      const std::uint32_t s = col.cells[r];
+      if (s == 0) out += (numeric || col.type == ColumnType::Empty) ? "null" : "\"\"";
+      else if (numeric) appendNumber(out, t.strings[s]);
+      else appendEscaped(out, t.strings[s]);
+    }
+    out += "]}";
+  }
+  out += "]}";
+}
+
+static void writeCsvField(std::ostream& out, const std::string& s) {
+  if (s.find_first_of(",\"\r\n") == std::string::npos) {
+    out << s;
+    return;
+  }
+  out << '"';
+  for (char c : s) {
+    if (c == '"') out << '"';
+    out << c;
+  }
+  out << '"';
+}
+
+void TableExtractor::writeCsv(const Table& t, std::ostream& out) {
+  for (std::size_t c = 0; c < t.columns.size(); ++c) {
+    if (c) out << ',';
+    writeCsvField(out, t.columns[c].name);
+  }
+  out << "\r\n";
+  for (std::size_t r = 0; r < t.rows; ++r) {
+    for (std::size_t c = 0; c < t.columns.size(); ++c) {
+      if (c) out << ',';
+      writeCsvField(out, t.value(c, r));
+    }
+    out << "\r\n";
+  }
+}
+
+} // namespace core::extract
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "core/extract/ParsedDocument.h"
+
+namespace core::extract {
+
+enum class ColumnType { Empty, Integer, Number, Text };
+
+// Column of a table in columnar form. Cells index into Table::strings, so a cell
+// spanning several rows/columns is stored once however often it is repeated.
+struct TableColumn {
+  std::string name;
+  ColumnType type = ColumnType::Empty;
+  std::vector<std::uint32_t> cells; // one per body row
+};
+
+struct Table {
+  std::string caption;
+  std::size_t rows = 0; // body rows (header rows excluded)
+  std::vector<TableColumn> columns;
+  std::vector<std::string> strings; // strings[0] is the empty cell
+
+  const std::string& value(std::size_t col, std::size_t row) const { return strings[columns[col].cells[row]]; }
+};
+
+class TableExtractor {
+public:
+  // Builds the cell grid of one <table> element: rowspan/colspan are expanded,
+  // header rows detected (thead, or leading rows of only <th>), and every column
+  // typed as integer/number/text. Nested tables are left to their own extract().
+  static Table extract(const ParsedDocument& doc, ParsedDocument::NodeId table);
+
+  // Columnar JSON: {"caption":..,"rows":N,"columns":[{"name","type","values":[..]}]}
+  // Numeric columns are written as JSON numbers. Output is appended, never rebuilt.
+  static void appendJson(const Table& t, std::string& out);
+  // RFC 4180 CSV, one header line, streamed row by row.
+  static void writeCsv(const Table& t, std::ostream& out);
+
+  static const char* typeName(ColumnType t);
+};
+
+} // namespace core::extract
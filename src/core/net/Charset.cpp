@@ -0,0 +1,278 @@
+#include "core/net/Charset.h"
+#include "util/Log.h"
+#include <QStringDecoder>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+
+namespace core::net {
+
+namespace {
+
+// Windows-1252 0x80-0x9F; the rest of the byte range maps to the same code point.
+constexpr char16_t kCp1252High[32] = {
+  0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+  0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+  0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+  0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178,
+};
+
+char lowerAscii(char c) {
+  return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c;
+}
+
+bool startsWithNoCase(std::string_view s, std::size_t at, std::string_view word) {
+  if (s.size() - at < word.size()) return false;
+  for (std::size_t i = 0; i < word.size(); ++i) {
+    if (lowerAscii(s[at + i]) != word[i]) return false;
+  }
+  return true;
+}
+
+std::size_t findNoCase(std::string_view s, std::string_view word, std::size_t from = 0) {
+  for (std::size_t i = from; i + word.size() <= s.size(); ++i) {
+    if (startsWithNoCase(s, i, word)) return i;
+  }
+  return std::string_view::npos;
+}
+
+bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+// Value after "charset" at pos: optional spaces, '=', then a quoted or bare token.
+std::string charsetValue(std::string_view s, std::size_t pos) {
+  pos += 7; // "charset"
+  while (pos < s.size() && isSpace(s[pos])) ++pos;
+  if (pos >= s.size() || s[pos] != '=') return {};
+  ++pos;
+  while (pos < s.size() && isSpace(s[pos])) ++pos;
+  char quote = 0;
+  if (pos < s.size() && (s[pos] == '"' || s[pos] == '\'')) quote = s[pos++];
+  const std::size_t start = pos;
+  while (pos < s.size() && s[pos] != quote && s[pos] != ';' && s[pos] != '>' && !isSpace(s[pos])
+         && (quote || (s[pos] != '"' && s[pos] != '\''))) {
+    ++pos;
+  }
+  std::string v(s.substr(start, pos - start));
+  std::transform(v.begin(), v.end(), v.begin(), lowerAscii);
+  return v;
+}
+
+// <meta charset=...> or <meta http-equiv content="...; charset=..."> in the first
+// 1024 bytes, skipping comments.
+std::string prescanMeta(std::string_view body) {
+  const std::string_view head = body.substr(0, 1024);
+  for (std::size_t i = 0; i < head.size(); ) {
+    if (head.compare(i, 4, "<!--") == 0) {
+      const std::size_t end = head.find("-->", i + 4);
+      if (end == std::string_view::npos) break;
+      i = end + 3;
+      continue;
+    }
+    if (startsWithNoCase(head, i, "<meta") && i + 5 < head.size() && (isSpace(head[i + 5]) || head[i + 5] == '/')) {
+      const std::size_t end = head.find('>', i);
+      const std::string_view tag = head.substr(i, end == std::string_view::npos ? std::string_view::npos : end - i);
+      for (std::size_t at = findNoCase(tag, "charset"); at != std::string_view::npos; at = findNoCase(tag, "charset", at + 7)) {
+        std::string v = charsetValue(tag, at);
+        if (!v.empty()) return v;
+      }
+      if (end == std::string_view::npos) break;
+      i = end + 1;
+      continue;
+    }
+    ++i;
+  }
+  return {};
+}
+
+std::size_t utf8Length(char32_t cp) {
+  return cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+}
+
+char* putUtf8(char* out, char32_t cp) {
+  if (cp < 0x80) {
+    *out++ = (char)cp;
+  } else if (cp < 0x800) {
+    *out++ = (char)(0xC0 | (cp >> 6));
+    *out++ = (char)(0x80 | (cp & 0x3F));
+  } else {
+    *out++ = (char)(0xE0 | (cp >> 12));
+    *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+    *out++ = (char)(0x80 | (cp & 0x3F));
+  }
+  return out;
+}
+
+char32_t cp1252(unsigned char b) {
+  return (b >= 0x80 && b < 0xA0) ? kCp1252High[b - 0x80] : b;
+}
+
+// Writes the UTF-8 form of a Windows-1252 buffer; out needs in.size() * 3 bytes.
+char* writeWindows1252(std::string_view in, char* out) {
+  std::size_t i = 0;
+  while (i < in.size()) {
+    const std::size_t run = Charset::asciiPrefix(in.substr(i));
+    std::memcpy(out, in.data() + i, run);
+    out += run;
+    i += run;
+    while (i < in.size() && ((unsigned char)in[i] & 0x80)) out = putUtf8(out, cp1252((unsigned char)in[i++]));
+  }
+  return out;
+}
+
+} // namespace
+
+Encoding Charset::fromLabel(std::string_view label) {
+  while (!label.empty() && isSpace(label.front())) label.remove_prefix(1);
+  while (!label.empty() && isSpace(label.back())) label.remove_suffix(1);
+  std::string l(label);
+  std::transform(l.begin(), l.end(), l.begin(), lowerAscii);
+  if (l == "utf-8" || l == "utf8" || l == "unicode-1-1-utf-8") return Encoding::Utf8;
+  if (l == "windows-1252" || l == "cp1252" || l == "x-cp1252" || l == "iso-8859-1" || l == "iso8859-1"
+      || l == "iso_8859-1" || l == "latin1" || l == "l1" || l == "us-ascii" || l == "ascii"
+      || l == "cp819" || l == "ibm819" || l == "iso-ir-100") {
+    return Encoding::Windows1252;
+  }
+  if (l == "utf-16" || l == "utf-16le" || l == "unicode") return Encoding::Utf16LE;
+  if (l == "utf-16be") return Encoding::Utf16BE;
+  return Encoding::Other;
+}
+
+std::size_t Charset::asciiPrefix(std::string_view s) {
+  const char* p = s.data();
+  const std::size_t n = s.size();
+  std::size_t i = 0;
+  // Eight bytes per step: any byte with its high bit set ends the run.
+  for (; i + 8 <= n; i += 8) {
+    std::uint64_t w;
+    std::memcpy(&w, p + i, 8);
+    if (w & 0x8080808080808080ULL) break;
+  }
+  while (i < n && !((unsigned char)p[i] & 0x80)) ++i;
+  return i;
+}
+
+bool Charset::isValidUtf8(std::string_view s) {
+  std::size_t i = 0;
+  const std::size_t n = s.size();
+  while (i < n) {
+    i += asciiPrefix(s.substr(i));
+    if (i >= n) break;
+    const unsigned char c = (unsigned char)s[i];
+    std::size_t len;
+    char32_t cp;
+    if (c >= 0xC2 && c <= 0xDF) { len = 2; cp = c & 0x1F; }
+    else if (c >= 0xE0 && c <= 0xEF) { len = 3; cp = c & 0x0F; }
+    else if (c >= 0xF0 && c <= 0xF4) { len = 4; cp = c & 0x07; }
+    else return false;
+    if (n - i < len) return false;
+    for (std::size_t k = 1; k < len; ++k) {
+      const unsigned char cc = (unsigned char)s[i + k];
+      if ((cc & 0xC0) != 0x80) return false;
+      cp = (cp << 6) | (cc & 0x3F);
+    }
+    // Overlong forms, surrogates and code points past U+10FFFF.
+    if (utf8Length(cp) != len || (cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF) return false;
+    i += len;
+  }
+  return true;
+}
+
+DetectedCharset Charset::detect(std::string_view body, std::string_view contentType) {
+  DetectedCharset cs;
+  const auto bom = [&](std::string_view mark) { return body.substr(0, mark.size()) == mark; };
+  if (bom("\xEF\xBB\xBF")) {
+    cs.encoding = Encoding::Utf8;
+    cs.label = "utf-8";
+    cs.bomLength = 3;
+    cs.source = "bom";
+    return cs;
+  }
+  if (bom("\xFF\xFE") || bom("\xFE\xFF")) {
+    cs.encoding = body[0] == '\xFF' ? Encoding::Utf16LE : Encoding::Utf16BE;
+    cs.label = cs.encoding == Encoding::Utf16LE ? "utf-16le" : "utf-16be";
+    cs.bomLength = 2;
+    cs.source = "bom";
+    return cs;
+  }
+
+  if (std::size_t at = findNoCase(contentType, "charset"); at != std::string_view::npos) {
+    std::string label = charsetValue(contentType, at);
+    if (!label.empty()) {
+      cs.encoding = fromLabel(label);
+      cs.label = std::move(label);
+      cs.source = "header";
+      return cs;
+    }
+  }
+
+  std::string meta = prescanMeta(body);
+  if (!meta.empty()) {
+    cs.encoding = fromLabel(meta);
+    // A page that can carry an ASCII meta tag is not UTF-16, whatever it claims.
+    if (cs.encoding == Encoding::Utf16LE || cs.encoding == Encoding::Utf16BE) {
+      cs.encoding = Encoding::Utf8;
+      meta = "utf-8";
+    }
+    cs.label = std::move(meta);
+    cs.source = "meta";
+    return cs;
+  }
+
+  const bool utf8 = isValidUtf8(body);
+  cs.encoding = utf8 ? Encoding::Utf8 : Encoding::Windows1252;
+  cs.label = utf8 ? "utf-8" : "windows-1252";
+  return cs;
+}
+
+void Charset::appendWindows1252(std::string_view in, std::string& out) {
+  const std::size_t start = out.size();
+  out.resize(start + in.size() * 3);
+  char* end = writeWindows1252(in, out.data() + start);
+  out.resize(std::size_t(end - out.data()));
+}
+
+bool Charset::toUtf8(QByteArray& body, const DetectedCharset& cs) {
+  const std::string_view in = std::string_view(body.constData(), (std::size_t)body.size()).substr(cs.bomLength);
+  switch (cs.encoding) {
+    case Encoding::Utf8:
+      if (cs.bomLength == 0) return false;
+      body.remove(0, (qsizetype)cs.bomLength);
+      return true;
+    case Encoding::Windows1252: {
+      const std::size_t ascii = asciiPrefix(in);
+      if (ascii == in.size()) {
+        if (cs.bomLength) body.remove(0, (qsizetype)cs.bomLength);
+        return cs.bomLength != 0;
+      }
+      // The ASCII prefix is copied as is; only the tail goes through the table.
+      QByteArray out(qsizetype(ascii + (in.size() - ascii) * 3), Qt::Uninitialized);
+      std::memcpy(out.data(), in.data(), ascii);
+      char* end = writeWindows1252(in.substr(ascii), out.data() + ascii);
+      out.truncate(qsizetype(end - out.data()));
+      body = std::move(out);
+      return true;
+    }
+    case Encoding::Utf16LE:
+    case Encoding::Utf16BE:
+    case Encoding::Other: {
+      QStringDecoder dec = cs.encoding == Encoding::Utf16LE ? QStringDecoder(QStringDecoder::Utf16LE)
+                         : cs.encoding == Encoding::Utf16BE ? QStringDecoder(QStringDecoder::Utf16BE)
+                         : QStringDecoder(cs.label.c_str());
+      if (!dec.isValid()) {
+        util::Log::warn("Charset: no decoder for '" + cs.label + "', reading as windows-1252");
+        DetectedCharset fallback = cs;
+        fallback.encoding = Encoding::Windows1252;
+        return toUtf8(body, fallback);
+      }
+      QString text = dec.decode(QByteArrayView(in.data(), (qsizetype)in.size()));
+      body = text.toUtf8();
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace core::net
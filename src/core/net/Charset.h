@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <QByteArray>
+
+namespace core::net {
+
+enum class Encoding { Utf8, Windows1252, Utf16LE, Utf16BE, Other };
+
+struct DetectedCharset {
+  Encoding encoding = Encoding::Utf8;
+  std::string label;          // lowercase charset name, e.g. "shift_jis" for Other
+  std::size_t bomLength = 0;  // bytes to drop from the front
+  const char* source = "default"; // "bom", "header", "meta" or "default"
+};
+
+// Charset sniffing and one-pass transcoding to UTF-8 for fetched HTML and text.
+//
+// Detection follows the HTML encoding-sniffing order: byte order mark, then the
+// Content-Type charset parameter, then a <meta charset> / http-equiv prescan of the
+// first 1024 bytes, then UTF-8 if the body validates and Windows-1252 otherwise. As in
+// browsers, ISO-8859-1 and US-ASCII labels decode as Windows-1252, and a UTF-16 label
+// found in a meta tag means UTF-8.
+//
+// ASCII runs are skipped eight bytes at a time. UTF-8 and pure-ASCII bodies are never
+// copied; Windows-1252 is converted by table in one pass into an output reserved up
+// front; everything else goes through QStringDecoder.
+class Charset {
+public:
+  static DetectedCharset detect(std::string_view body, std::string_view contentType);
+
+  // Canonical encoding for a charset label (case and surrounding space ignored).
+  static Encoding fromLabel(std::string_view label);
+
+  // Length of the leading all-ASCII prefix.
+  static std::size_t asciiPrefix(std::string_view s);
+  static bool isValidUtf8(std::string_view s);
+
+  // Transcodes in place. Returns false (body untouched) when no conversion was needed.
+  static bool toUtf8(QByteArray& body, const DetectedCharset& cs);
+  static void appendWindows1252(std::string_view in, std::string& out);
+};
+
+} // namespace core::net
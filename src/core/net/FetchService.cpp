@@ -1,6 +1,7 @@
 \
 /* src/core/net/FetchService.cpp */
 #include "core/net/FetchService.h"
+#include "core/net/Charset.h"
 #include "core/net/UrlTools.h"
 #include "util/Log.h"
 #include "util/Time.h"
@@ -9,6 +10,12 @@
 
 namespace core::net {
 
+static bool isTextType(const QByteArray& contentType) {
+  const QByteArray t = contentType.trimmed().toLower();
+  return t.startsWith("text/") || t.startsWith("application/xhtml")
+      || t.startsWith("application/xml");
+}
+
 FetchService::FetchService(QObject* parent)
   : QObject(parent),
     timeoutMs_(12000),
@@ -82,15 +89,25 @@ void FetchService::fetchOnce(const QUrl& inUrl, int attempt, const std::function
       if (fr.status == 304 && haveCache) {
         fr.body = cached.body;
         fr.contentType = cached.contentType;
+        fr.charset = cached.charset;
         fr.status = 200;
         cb(fr);
       } else {
         fr.body = reply->readAll();
+        if (isTextType(fr.contentType)) {
+          // Transcode once here so the cache and every consumer hold UTF-8.
+          const DetectedCharset cs = Charset::detect(
+            std::string_view(fr.body.constData(), (std::size_t)fr.body.size()),
+            std::string_view(fr.contentType.constData(), (std::size_t)fr.contentType.size()));
+          Charset::toUtf8(fr.body, cs);
+          fr.charset = QByteArray::fromStdString(cs.label);
+        }
         // Cache only small-ish responses (basic safety)
         if (fr.body.size() <= 1024 * 1024) {
           CacheEntry ce;
           ce.body = fr.body;
           ce.contentType = fr.contentType;
+          ce.charset = fr.charset;
           ce.etag = fr.etag;
           ce.lastModified = fr.lastModified;
           ce.tsMs = util::now_ms();
@@ -14,8 +14,9 @@ namespace core::net {
 
 struct FetchResult {
   int status = 0;
-  QByteArray body;
+  QByteArray body;         // HTML/text bodies are delivered as UTF-8
   QByteArray contentType;
+  QByteArray charset;      // source charset of a transcoded text body, e.g. "windows-1252"
   QUrl finalUrl;
   QString error;
   QByteArray etag;
@@ -46,6 +47,7 @@ private:
   struct CacheEntry {
     QByteArray body;
     QByteArray contentType;
+    QByteArray charset;
     QByteArray etag;
     QByteArray lastModified;
     qint64 tsMs = 0;
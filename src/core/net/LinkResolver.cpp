@@ -0,0 +1,52 @@
+#include "core/net/LinkResolver.h"
+#include "core/net/UrlTools.h"
+#include <cctype>
+
+namespace core::net {
+
+static bool startsWithNoCase(std::string_view s, std::string_view prefix) {
+  if (s.size() < prefix.size()) return false;
+  for (size_t i = 0; i < prefix.size(); ++i) {
+    if (std::tolower((unsigned char)s[i]) != prefix[i]) return false;
+  }
+  return true;
+}
+
+static std::string_view trimmed(std::string_view s) {
+  while (!s.empty() && std::isspace((unsigned char)s.front())) s.remove_prefix(1);
+  while (!s.empty() && std::isspace((unsigned char)s.back())) s.remove_suffix(1);
+  return s;
+}
+
+LinkResolver::LinkResolver(const QUrl& base) : base_(base) {}
+
+std::string LinkResolver::resolve(std::string_view href) const {
+  href = trimmed(href);
+  // Reject the common non-navigable forms before paying for a QUrl parse.
+  if (href.empty() || href.front() == '#') return {};
+  if (startsWithNoCase(href, "javascript:") || startsWithNoCase(href, "mailto:") ||
+      startsWithNoCase(href, "tel:") || startsWithNoCase(href, "data:")) {
+    return {};
+  }
+
+  QUrl rel(QString::fromUtf8(href.data(), (qsizetype)href.size()));
+  if (!rel.isValid()) return {};
+  QUrl abs = rel.isRelative() ? base_.resolved(rel) : rel;
+  const QString scheme = abs.scheme().toLower();
+  if ((scheme != "http" && scheme != "https") || abs.host().isEmpty()) return {};
+  return normalize(abs).toString(QUrl::FullyEncoded).toStdString();
+}
+
+QUrl LinkResolver::normalize(const QUrl& url) {
+  QUrl out = url.adjusted(QUrl::RemoveFragment | QUrl::NormalizePathSegments);
+  out.setScheme(out.scheme().toLower());
+  out.setHost(out.host().toLower());
+  if ((out.scheme() == "http" && out.port() == 80) || (out.scheme() == "https" && out.port() == 443)) out.setPort(-1);
+  if (out.path().isEmpty()) out.setPath("/");
+  out = stripTracking(out);
+  // stripTracking leaves "?" behind when every parameter was tracking.
+  if (out.hasQuery() && out.query().isEmpty()) out.setQuery(QString());
+  return out;
+}
+
+} // namespace core::net
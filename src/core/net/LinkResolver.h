@@ -0,0 +1,26 @@
+#pragma once
+#include <QUrl>
+#include <string>
+#include <string_view>
+
+namespace core::net {
+
+// Resolves hrefs from one document against its base. Cheap to construct per page;
+// the base is parsed once and reused for every link.
+class LinkResolver {
+public:
+  explicit LinkResolver(const QUrl& base);
+
+  // Absolute, normalized, tracking-stripped http(s) URL, or "" for fragments,
+  // javascript:, mailto: and anything else a crawler cannot fetch.
+  std::string resolve(std::string_view href) const;
+
+  // Lowercase host, default port and fragment dropped, dot segments removed,
+  // empty path -> "/", tracking parameters stripped.
+  static QUrl normalize(const QUrl& url);
+
+private:
+  QUrl base_;
+};
+
+} // namespace core::net
@@ -0,0 +1,110 @@
+#include "core/storage/BatchWriter.h"
+#include "util/Log.h"
+
+namespace core::storage {
+
+BatchWriter::BatchWriter(SqliteDb& db, Options options) : db_(db), options_(options) {
+  if (options_.maxRows == 0) options_.maxRows = 1;
+  timer_ = std::thread([this] { timerLoop(); });
+}
+
+BatchWriter::~BatchWriter() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  timer_.join();
+  flush();
+}
+
+void BatchWriter::add(const std::string& sql, std::initializer_list<Param> params) {
+  std::lock_guard<std::mutex> lk(mu_);
+  Pending& p = pending_;
+  if (p.rows.empty()) oldest_ = Clock::now();
+  auto [it, fresh] = p.sqlIndex.try_emplace(sql, std::uint32_t(p.sql.size()));
+  if (fresh) p.sql.push_back(sql);
+
+  p.rows.push_back({it->second, std::uint32_t(p.values.size()), std::uint32_t(params.size())});
+  for (const Param& param : params) {
+    Value v{param.kind_, param.int_, param.real_, p.bytes.size(), param.data_.size()};
+    p.bytes.append(param.data_);
+    p.values.push_back(v);
+  }
+  // Start the delay clock, or hand over a full batch. Writing it here could take the
+  // batch order while this thread holds the database, the reverse of the timer thread.
+  if (p.rows.size() == 1 || p.rows.size() == options_.maxRows) wake_.notify_one();
+}
+
+bool BatchWriter::flush() {
+  std::lock_guard<std::mutex> order(flushMu_);
+  Pending batch;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    std::swap(batch, pending_);
+  }
+  return batch.rows.empty() || write(batch);
+}
+
+bool BatchWriter::write(Pending& batch) {
+  std::uint64_t failed = batch.rows.size();
+  {
+    Transaction tx(db_);
+    // Without BEGIN the rows would autocommit one by one; leave them all unwritten.
+    if (tx.active()) {
+      failed = 0;
+      std::vector<Param> params;
+      for (const Entry& row : batch.rows) {
+        params.clear();
+        for (std::uint32_t i = row.firstValue; i < row.firstValue + row.valueCount; ++i) {
+          const Value& v = batch.values[i];
+          Param p;
+          p.kind_ = v.kind;
+          p.int_ = v.i;
+          p.real_ = v.r;
+          p.data_ = std::string_view(batch.bytes).substr(v.offset, v.size);
+          params.push_back(p);
+        }
+        if (!db_.execParams(batch.sql[row.statement], params)) ++failed;
+      }
+      if (!tx.commit()) failed = batch.rows.size();
+    }
+  }
+  if (failed) util::Log::warn("BatchWriter: " + std::to_string(failed) + " of " + std::to_string(batch.rows.size()) +
+                              " rows failed");
+
+  std::lock_guard<std::mutex> lk(mu_);
+  written_ += batch.rows.size() - failed;
+  failed_ += failed;
+  return failed == 0;
+}
+
+void BatchWriter::timerLoop() {
+  std::unique_lock<std::mutex> lk(mu_);
+  while (!stop_) {
+    if (pending_.rows.empty()) {
+      wake_.wait(lk, [&] { return stop_ || !pending_.rows.empty(); });
+      continue;
+    }
+    const auto due = oldest_ + options_.maxDelay;
+    if (pending_.rows.size() < options_.maxRows && Clock::now() < due) {
+      wake_.wait_until(lk, due);
+      continue;
+    }
+    lk.unlock();
+    flush();
+    lk.lock();
+  }
+}
+
+std::uint64_t BatchWriter::rowsWritten() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return written_;
+}
+
+std::uint64_t BatchWriter::rowsFailed() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return failed_;
+}
+
+} // namespace core::storage
@@ -0,0 +1,90 @@
+#pragma once
+#include "core/storage/SqliteDb.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace core::storage {
+
+// Queues single-row writes and commits them in groups, one transaction per batch:
+// a batch goes out once maxRows rows are queued or the oldest has waited maxDelay,
+// whichever comes first. Parameters are copied on add(), so callers may pass
+// temporaries. A row that fails is logged and skipped; the rest of its batch
+// still commits. If the batch's transaction cannot begin, none of it is run.
+//
+// add() may be called from any thread, including one inside a Transaction or
+// iterating Rows: it never touches the database. A background thread writes both
+// full and timed batches; rows added while it is writing wait for the next batch.
+class BatchWriter {
+public:
+  struct Options {
+    std::size_t maxRows = 1000;
+    std::chrono::milliseconds maxDelay{250};
+  };
+
+  explicit BatchWriter(SqliteDb& db, Options options);
+  explicit BatchWriter(SqliteDb& db) : BatchWriter(db, Options{}) {}
+  ~BatchWriter(); // writes whatever is still queued
+
+  BatchWriter(const BatchWriter&) = delete;
+  BatchWriter& operator=(const BatchWriter&) = delete;
+
+  void add(const std::string& sql, std::initializer_list<Param> params);
+  // Writes everything queued so far; false if any of it failed. Not while this thread
+  // holds a Transaction or open Rows: the background thread may be waiting for them
+  // with the batch order held.
+  bool flush();
+
+  std::uint64_t rowsWritten() const;
+  std::uint64_t rowsFailed() const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  // Parameters in owned form; text and blob bytes live in Pending::bytes.
+  struct Value {
+    Param::Kind kind;
+    std::int64_t i;
+    double r;
+    std::size_t offset;
+    std::size_t size;
+  };
+  struct Entry {
+    std::uint32_t statement;
+    std::uint32_t firstValue;
+    std::uint32_t valueCount;
+  };
+  struct Pending {
+    std::vector<std::string> sql;
+    std::unordered_map<std::string, std::uint32_t> sqlIndex;
+    std::vector<Entry> rows;
+    std::vector<Value> values;
+    std::string bytes;
+  };
+
+  SqliteDb& db_;
+  Options options_;
+
+  mutable std::mutex mu_;
+  std::condition_variable wake_;
+  Pending pending_;
+  Clock::time_point oldest_;
+  std::uint64_t written_ = 0;
+  std::uint64_t failed_ = 0;
+  bool stop_ = false;
+
+  std::mutex flushMu_; // keeps batches in queue order
+  std::thread timer_;
+
+  void timerLoop();
+  bool write(Pending& batch);
+};
+
+} // namespace core::storage
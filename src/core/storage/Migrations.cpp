@@ -16,16 +16,14 @@ static bool ensureMeta(SqliteDb& db) {
 
 static int currentVersion(SqliteDb& db) {
   int v = 0;
-  db.query("SELECT value FROM meta WHERE key='schema_version';", {}, [&](int, char** vals, char**) {
-    if (vals && vals[0]) v = std::atoi(vals[0]);
-  });
+  for (const auto& row : db.query("SELECT value FROM meta WHERE key='schema_version';")) v = int(row.int64(0));
   return v;
 }
 
 static bool setVersion(SqliteDb& db, int v) {
   return db.execParams("INSERT INTO meta(key,value) VALUES('schema_version', ?) "
                        "ON CONFLICT(key) DO UPDATE SET value=excluded.value;",
-                       {std::to_string(v)});
+                       {v});
 }
 
 bool runMigrations(SqliteDb& db) {
@@ -118,6 +116,152 @@ bool runMigrations(SqliteDb& db) {
     if (!setVersion(db, 1)) return false;
   }
 
+  if (v < 2) {
+    // One local_docs row per URL (entity links refer to it by url_or_path), and an
+    // index for the per-document side of entity_links.
+    bool ok = db.exec(R"SQL(
+      DELETE FROM local_docs WHERE id NOT IN (SELECT MAX(id) FROM local_docs GROUP BY url_or_path);
+      CREATE UNIQUE INDEX IF NOT EXISTS idx_local_docs_url ON local_docs(url_or_path);
+      CREATE INDEX IF NOT EXISTS idx_entity_links_doc ON entity_links(doc_id);
+    )SQL");
+    if (!ok) return false;
+    if (!setVersion(db, 2)) return false;
+  }
+
+  if (v < 3) {
+    // Corpus-wide entity co-occurrence, kept incrementally by DeepSearchService. Pairs
+    // are stored in both directions so "related to X" is one primary-key range scan.
+    // Corpus totals live in meta (cooc_docs, cooc_blocks); their absence makes the
+    // service rebuild these tables from entity_links.
+    bool ok = db.exec(R"SQL(
+      CREATE TABLE IF NOT EXISTS entity_stats(
+        entity_id TEXT PRIMARY KEY,
+        docs INTEGER NOT NULL,
+        blocks INTEGER NOT NULL
+      ) WITHOUT ROWID;
+
+      CREATE TABLE IF NOT EXISTS entity_cooc(
+        a TEXT NOT NULL,
+        b TEXT NOT NULL,
+        docs INTEGER NOT NULL,
+        blocks INTEGER NOT NULL,
+        PRIMARY KEY(a, b)
+      ) WITHOUT ROWID;
+    )SQL");
+    if (!ok) return false;
+    if (!setVersion(db, 3)) return false;
+  }
+
+  if (v < 4) {
+    // Relations asserted by DeepSearch profiles (profile entity -> related entity);
+    // weight counts how often. Loaded into the in-memory graph at startup.
+    bool ok = db.exec(R"SQL(
+      CREATE TABLE IF NOT EXISTS entity_relations(
+        src TEXT NOT NULL,
+        dst TEXT NOT NULL,
+        relation TEXT NOT NULL,
+        weight REAL NOT NULL,
+        ts INTEGER NOT NULL,
+        PRIMARY KEY(src, dst, relation)
+      ) WITHOUT ROWID;
+      CREATE INDEX IF NOT EXISTS idx_entity_relations_dst ON entity_relations(dst);
+    )SQL");
+    if (!ok) return false;
+    if (!setVersion(db, 4)) return false;
+  }
+
+  if (v < 5) {
+    // Profile lookup index: entity_index gets a stable integer key so a trigram FTS5
+    // table can use it as external content (names and aliases are not stored twice),
+    // and triggers keep the index in step with every write to entity_index. Ranking
+    // weighs name matches over alias matches. A NOCASE index on name serves prefix
+    // lookups too short for trigrams.
+    Transaction tx(db);
+    bool ok = tx.active() && db.exec(R"SQL(
+      CREATE TABLE entity_index_v5(
+        id INTEGER PRIMARY KEY,
+        entity_id TEXT NOT NULL UNIQUE,
+        name TEXT NOT NULL,
+        type TEXT NOT NULL,
+        aliases TEXT,
+        ts INTEGER NOT NULL
+      );
+      INSERT INTO entity_index_v5(entity_id,name,type,aliases,ts)
+        SELECT entity_id,name,type,aliases,ts FROM entity_index;
+      DROP TABLE entity_index;
+      ALTER TABLE entity_index_v5 RENAME TO entity_index;
+      CREATE INDEX IF NOT EXISTS idx_entity_index_name ON entity_index(name COLLATE NOCASE);
+
+      CREATE VIRTUAL TABLE IF NOT EXISTS entity_fts USING fts5(
+        name, aliases, content = 'entity_index', content_rowid = 'id', tokenize = 'trigram'
+      );
+      INSERT INTO entity_fts(entity_fts, rank) VALUES('rank', 'bm25(10.0, 1.0)');
+      INSERT INTO entity_fts(entity_fts) VALUES('rebuild');
+
+      CREATE TRIGGER IF NOT EXISTS entity_index_fts_ai AFTER INSERT ON entity_index BEGIN
+        INSERT INTO entity_fts(rowid, name, aliases) VALUES(new.id, new.name, new.aliases);
+      END;
+      CREATE TRIGGER IF NOT EXISTS entity_index_fts_ad AFTER DELETE ON entity_index BEGIN
+        INSERT INTO entity_fts(entity_fts, rowid, name, aliases) VALUES('delete', old.id, old.name, old.aliases);
+      END;
+      CREATE TRIGGER IF NOT EXISTS entity_index_fts_au AFTER UPDATE OF name, aliases ON entity_index
+      WHEN old.name IS NOT new.name OR old.aliases IS NOT new.aliases BEGIN
+        INSERT INTO entity_fts(entity_fts, rowid, name, aliases) VALUES('delete', old.id, old.name, old.aliases);
+        INSERT INTO entity_fts(rowid, name, aliases) VALUES(new.id, new.name, new.aliases);
+      END;
+    )SQL");
+    if (!ok || !setVersion(db, 5) || !tx.commit()) return false;
+  }
+
+  if (v < 6) {
+    // Which source (page URL) asserted each relation. A page seen again only adds the
+    // relations it did not assert before and withdraws those it no longer asserts, so
+    // entity_relations.weight counts sources rather than views. Weights stored before
+    // this table existed are kept as they are.
+    bool ok = db.exec(R"SQL(
+      CREATE TABLE IF NOT EXISTS entity_relation_sources(
+        src TEXT NOT NULL,
+        source TEXT NOT NULL,
+        dst TEXT NOT NULL,
+        relation TEXT NOT NULL,
+        ts INTEGER NOT NULL,
+        PRIMARY KEY(src, source, dst, relation)
+      ) WITHOUT ROWID;
+      CREATE INDEX IF NOT EXISTS idx_entity_relation_sources_dst ON entity_relation_sources(dst);
+    )SQL");
+    if (!ok) return false;
+    if (!setVersion(db, 6)) return false;
+  }
+
+  if (v < 7) {
+    // Audit trail for DeepSearch entity merges: the removed entity_index row and the
+    // entity it was merged into, so a merge can be reviewed or reverted by hand.
+    bool ok = db.exec(R"SQL(
+      CREATE TABLE IF NOT EXISTS entity_merges(
+        id INTEGER PRIMARY KEY,
+        from_id TEXT NOT NULL,
+        into_id TEXT NOT NULL,
+        name TEXT NOT NULL,
+        type TEXT NOT NULL,
+        aliases TEXT,
+        ts INTEGER NOT NULL
+      );
+      CREATE INDEX IF NOT EXISTS idx_entity_merges_into ON entity_merges(into_id);
+    )SQL");
+    if (!ok) return false;
+    if (!setVersion(db, 7)) return false;
+  }
+
+  if (v < 8) {
+    // Per-trigram document counts of entity_fts, so fuzzy profile search can read the
+    // rarest posting lists first and skip the common ones.
+    bool ok = db.exec(R"SQL(
+      CREATE VIRTUAL TABLE IF NOT EXISTS entity_fts_vocab USING fts5vocab('entity_fts', 'row');
+    )SQL");
+    if (!ok) return false;
+    if (!setVersion(db, 8)) return false;
+  }
+
   return true;
 }
 
@@ -2,15 +2,14 @@
 /* src/core/storage/SqliteDb.cpp */
 #include "core/storage/SqliteDb.h"
 #include "util/Log.h"
-#include <sstream>
 
 namespace core::storage {
 
-SqliteDb::SqliteDb() : db_(nullptr) {}
+SqliteDb::SqliteDb(std::size_t statementCacheSize) : db_(nullptr), statementCacheSize_(statementCacheSize) {}
 SqliteDb::~SqliteDb() { close(); }
 
 bool SqliteDb::open(const std::string& path) {
-  std::lock_guard<std::mutex> lk(mu_);
+  std::lock_guard<std::recursive_mutex> lk(mu_);
   if (db_) return true;
 
   int rc = sqlite3_open_v2(path.c_str(), &db_,
@@ -21,25 +20,34 @@ bool SqliteDb::open(const std::string& path) {
     return false;
   }
 
-  // Pragmas: reasonable defaults for desktop app
-  exec("PRAGMA journal_mode=WAL;");
-  exec("PRAGMA synchronous=NORMAL;");
-  exec("PRAGMA foreign_keys=ON;");
-  exec("PRAGMA temp_store=MEMORY;");
-  exec("PRAGMA cache_size=-20000;"); // ~20MB pages
+  // Pragmas: reasonable defaults for desktop app. exec() takes mu_, so run them directly.
+  static const char* kPragmas[] = {
+    "PRAGMA journal_mode=WAL;",
+    "PRAGMA synchronous=NORMAL;",
+    "PRAGMA foreign_keys=ON;",
+    "PRAGMA temp_store=MEMORY;",
+    "PRAGMA cache_size=-20000;", // ~20MB pages
+  };
+  for (const char* pragma : kPragmas) {
+    if (sqlite3_exec(db_, pragma, nullptr, nullptr, nullptr) != SQLITE_OK)
+      util::Log::warn("SQLite pragma failed: " + lastError() + " SQL=" + pragma);
+  }
 
   return true;
 }
 
 void SqliteDb::close() {
-  std::lock_guard<std::mutex> lk(mu_);
+  std::lock_guard<std::recursive_mutex> lk(mu_);
   if (!db_) return;
+  for (auto& c : lru_) sqlite3_finalize(c.stmt);
+  statements_.clear();
+  lru_.clear();
   sqlite3_close(db_);
   db_ = nullptr;
 }
 
 bool SqliteDb::exec(const std::string& sql) {
-  std::lock_guard<std::mutex> lk(mu_);
+  std::lock_guard<std::recursive_mutex> lk(mu_);
   if (!db_) return false;
   char* err = nullptr;
   int rc = sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, &err);
@@ -52,23 +60,24 @@ bool SqliteDb::exec(const std::string& sql) {
   return true;
 }
 
-bool SqliteDb::execParams(const std::string& sql, const std::vector<std::string>& params) {
-  std::lock_guard<std::mutex> lk(mu_);
-  if (!db_) return false;
+bool SqliteDb::execParams(const std::string& sql, std::initializer_list<Param> params) {
+  return execBound(sql, params.begin(), params.size());
+}
 
-  sqlite3_stmt* stmt = nullptr;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
-  if (rc != SQLITE_OK) {
-    util::Log::error("SQLite prepare failed: " + lastError());
-    return false;
-  }
+bool SqliteDb::execParams(const std::string& sql, const std::vector<Param>& params) {
+  return execBound(sql, params.data(), params.size());
+}
 
-  for (int i = 0; i < (int)params.size(); ++i) {
-    sqlite3_bind_text(stmt, i + 1, params[i].c_str(), -1, SQLITE_TRANSIENT);
-  }
+bool SqliteDb::execBound(const std::string& sql, const Param* params, std::size_t count) {
+  std::lock_guard<std::recursive_mutex> lk(mu_);
+  if (!db_) return false;
+
+  const StatementHandle stmt = acquire(sql);
+  if (!stmt.stmt) return false;
+  bind(stmt.stmt, params, count, SQLITE_STATIC);
 
-  rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
+  const int rc = sqlite3_step(stmt.stmt);
+  release(stmt);
   if (rc != SQLITE_DONE) {
     util::Log::error("SQLite step failed: " + lastError());
     return false;
@@ -76,41 +85,87 @@ bool SqliteDb::execParams(const std::string& sql, const std::vector<std::string>
   return true;
 }
 
-bool SqliteDb::query(const std::string& sql, const std::vector<std::string>& params,
-                     const std::function<void(int, char**, char**)>& rowCb) {
-  std::lock_guard<std::mutex> lk(mu_);
+bool SqliteDb::execBatch(const std::vector<BatchStatement>& statements) {
+  std::lock_guard<std::recursive_mutex> lk(mu_);
   if (!db_) return false;
 
-  sqlite3_stmt* stmt = nullptr;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
-  if (rc != SQLITE_OK) {
-    util::Log::error("SQLite prepare failed: " + lastError());
-    return false;
+  Transaction tx(*this);
+  if (!tx.active()) return false;
+  for (const auto& st : statements) {
+    if (st.rows.empty()) continue;
+    const StatementHandle handle = acquire(st.sql);
+    sqlite3_stmt* stmt = handle.stmt;
+    if (!stmt) return false;
+    for (const auto& row : st.rows) {
+      for (int i = 0; i < (int)row.size(); ++i) {
+        sqlite3_bind_text(stmt, i + 1, row[i].c_str(), (int)row[i].size(), SQLITE_STATIC);
+      }
+      const int rc = sqlite3_step(stmt);
+      if (rc != SQLITE_DONE && rc != SQLITE_ROW) {
+        util::Log::error("SQLite batch step failed: " + lastError() + " SQL=" + st.sql);
+        release(handle);
+        return false;
+      }
+      sqlite3_reset(stmt);
+      sqlite3_clear_bindings(stmt);
+    }
+    release(handle);
   }
+  return tx.commit();
+}
 
-  for (int i = 0; i < (int)params.size(); ++i) {
-    sqlite3_bind_text(stmt, i + 1, params[i].c_str(), -1, SQLITE_TRANSIENT);
-  }
+Rows SqliteDb::query(const std::string& sql, std::initializer_list<Param> params) {
+  return queryBound(sql, params.begin(), params.size());
+}
 
-  int colCount = sqlite3_column_count(stmt);
-  std::vector<char*> values(colCount, nullptr);
-  std::vector<char*> names(colCount, nullptr);
+Rows SqliteDb::query(const std::string& sql, const std::vector<Param>& params) {
+  return queryBound(sql, params.data(), params.size());
+}
+
+Rows SqliteDb::queryBound(const std::string& sql, const Param* params, std::size_t count) {
+  std::unique_lock<std::recursive_mutex> lk(mu_);
+  const StatementHandle stmt = db_ ? acquire(sql) : StatementHandle{};
+  // Copied: the rows are stepped after a temporary argument list has been destroyed.
+  if (stmt.stmt) bind(stmt.stmt, params, count, SQLITE_TRANSIENT);
+  return Rows(this, std::move(lk), stmt);
+}
 
-  while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-    for (int c = 0; c < colCount; ++c) {
-      names[c] = const_cast<char*>(sqlite3_column_name(stmt, c));
-      const unsigned char* txt = sqlite3_column_text(stmt, c);
-      values[c] = const_cast<char*>(reinterpret_cast<const char*>(txt ? txt : reinterpret_cast<const unsigned char*>("")));
+void SqliteDb::bind(sqlite3_stmt* stmt, const Param* params, std::size_t count, sqlite3_destructor_type lifetime) {
+  for (std::size_t i = 0; i < count; ++i) {
+    const int n = int(i) + 1;
+    const Param& p = params[i];
+    switch (p.kind_) {
+      case Param::Kind::Null: sqlite3_bind_null(stmt, n); break;
+      case Param::Kind::Int: sqlite3_bind_int64(stmt, n, p.int_); break;
+      case Param::Kind::Real: sqlite3_bind_double(stmt, n, p.real_); break;
+      case Param::Kind::Text: sqlite3_bind_text(stmt, n, p.data_.data(), int(p.data_.size()), lifetime); break;
+      case Param::Kind::Blob: sqlite3_bind_blob(stmt, n, p.data_.data(), int(p.data_.size()), lifetime); break;
     }
-    rowCb(colCount, values.data(), names.data());
   }
+}
 
-  sqlite3_finalize(stmt);
-  if (rc != SQLITE_DONE) {
-    util::Log::error("SQLite query failed: " + lastError());
-    return false;
+Rows::Rows(SqliteDb* db, std::unique_lock<std::recursive_mutex> lock, StatementHandle stmt)
+  : db_(db), lock_(std::move(lock)), stmt_(stmt), ok_(stmt.stmt != nullptr) {
+  if (stmt_.stmt) step();
+}
+
+Rows::Rows(Rows&& other) noexcept
+  : db_(other.db_), lock_(std::move(other.lock_)), stmt_(other.stmt_), hasRow_(other.hasRow_), ok_(other.ok_) {
+  other.stmt_ = {};
+  other.hasRow_ = false;
+}
+
+Rows::~Rows() {
+  if (stmt_.stmt) db_->release(stmt_);
+}
+
+void Rows::step() {
+  const int rc = sqlite3_step(stmt_.stmt);
+  hasRow_ = rc == SQLITE_ROW;
+  if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+    util::Log::error("SQLite query failed: " + db_->lastError() + " SQL=" + sqlite3_sql(stmt_.stmt));
+    ok_ = false;
   }
-  return true;
 }
 
 std::string SqliteDb::lastError() const {
@@ -118,4 +173,86 @@ std::string SqliteDb::lastError() const {
   return sqlite3_errmsg(db_);
 }
 
+std::size_t SqliteDb::cachedStatementCount() const {
+  std::lock_guard<std::recursive_mutex> lk(mu_);
+  return lru_.size();
+}
+
+StatementHandle SqliteDb::acquire(const std::string& sql) {
+  const auto it = statements_.find(sql);
+  if (it != statements_.end() && !it->second->inUse) {
+    lru_.splice(lru_.begin(), lru_, it->second);
+    it->second->inUse = true;
+    return {it->second->stmt, &*it->second};
+  }
+
+  sqlite3_stmt* stmt = nullptr;
+  const bool cache = statementCacheSize_ > 0 && it == statements_.end();
+  if (sqlite3_prepare_v3(db_, sql.c_str(), (int)sql.size() + 1, cache ? SQLITE_PREPARE_PERSISTENT : 0, &stmt,
+                         nullptr) != SQLITE_OK) {
+    util::Log::error("SQLite prepare failed: " + lastError() + " SQL=" + sql);
+    sqlite3_finalize(stmt);
+    return {};
+  }
+  if (!cache) return {stmt, nullptr};
+
+  lru_.push_front({sql, stmt, true});
+  statements_.emplace(lru_.front().sql, lru_.begin());
+  if (lru_.size() > statementCacheSize_) {
+    // Evict the least recently used statement that nobody is stepping.
+    for (auto victim = std::prev(lru_.end()); victim != lru_.begin(); --victim) {
+      if (victim->inUse) continue;
+      statements_.erase(victim->sql);
+      sqlite3_finalize(victim->stmt);
+      lru_.erase(victim);
+      break;
+    }
+  }
+  return {stmt, &lru_.front()};
+}
+
+void SqliteDb::release(const StatementHandle& stmt) {
+  // The cache is keyed on the caller's SQL, which sqlite3_sql() may not reproduce
+  // (it stops after the first statement), so go by the handle rather than a lookup.
+  if (!stmt.entry) {
+    sqlite3_finalize(stmt.stmt);
+    return;
+  }
+  sqlite3_reset(stmt.stmt);
+  sqlite3_clear_bindings(stmt.stmt);
+  stmt.entry->inUse = false;
+}
+
+Transaction::Transaction(SqliteDb& db) : db_(db), lock_(db.mu_) {
+  if (!db_.db_) return;
+  nested_ = !sqlite3_get_autocommit(db_.db_);
+  const char* sql = nested_ ? "SAVEPOINT nova_tx;" : "BEGIN IMMEDIATE;";
+  active_ = sqlite3_exec(db_.db_, sql, nullptr, nullptr, nullptr) == SQLITE_OK;
+  if (!active_) util::Log::error("SQLite begin failed: " + db_.lastError());
+}
+
+Transaction::~Transaction() {
+  if (active_) rollback();
+}
+
+bool Transaction::commit() {
+  if (!active_) return false;
+  active_ = false;
+  const char* sql = nested_ ? "RELEASE nova_tx;" : "COMMIT;";
+  if (sqlite3_exec(db_.db_, sql, nullptr, nullptr, nullptr) == SQLITE_OK) return true;
+  util::Log::error("SQLite commit failed: " + db_.lastError());
+  active_ = true;
+  rollback();
+  return false;
+}
+
+void Transaction::rollback() {
+  if (!active_) return;
+  active_ = false;
+  // Rolling back to a savepoint leaves it open, so release it as well.
+  const char* sql = nested_ ? "ROLLBACK TO nova_tx; RELEASE nova_tx;" : "ROLLBACK;";
+  if (sqlite3_exec(db_.db_, sql, nullptr, nullptr, nullptr) != SQLITE_OK)
+    util::Log::error("SQLite rollback failed: " + db_.lastError());
+}
+
 } // namespace core::storage
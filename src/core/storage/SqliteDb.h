@@ -2,16 +2,178 @@
 /* src/core/storage/SqliteDb.h */
 #pragma once
 #include <sqlite3.h>
-#include <functional>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <list>
 #include <mutex>
+#include <span>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace core::storage {
 
+// One statement of a batch, executed once per parameter row.
+struct BatchStatement {
+  std::string sql;
+  std::vector<std::vector<std::string>> rows;
+};
+
+// A statement parameter: NULL, integer, real, text or blob. Text and blobs are views;
+// execParams binds them without copying (the step finishes inside the call), query
+// copies them because rows are stepped after the argument list has gone.
+class Param {
+public:
+  enum class Kind { Null, Int, Real, Text, Blob };
+
+  Param() = default;
+  Param(std::nullptr_t) {}
+  template <std::integral T>
+  Param(T v) : kind_(Kind::Int), int_(static_cast<std::int64_t>(v)) {}
+  Param(double v) : kind_(Kind::Real), real_(v) {}
+  Param(std::string_view v) : kind_(Kind::Text), data_(v) {}
+  Param(const std::string& v) : Param(std::string_view(v)) {}
+  Param(const char* v) : Param(std::string_view(v)) {}
+  static Param blob(std::span<const std::byte> v) {
+    Param p;
+    p.kind_ = Kind::Blob;
+    p.data_ = {reinterpret_cast<const char*>(v.data()), v.size()};
+    return p;
+  }
+
+  Kind kind() const { return kind_; }
+
+private:
+  friend class SqliteDb;
+  friend class BatchWriter;
+  Kind kind_ = Kind::Null;
+  std::int64_t int_ = 0;
+  double real_ = 0;
+  std::string_view data_;
+};
+
+// The current row of a query. text() and blob() point into SQLite's buffers and are
+// valid until the iteration moves on.
+class Row {
+public:
+  explicit Row(sqlite3_stmt* stmt) : stmt_(stmt) {}
+
+  int columnCount() const { return sqlite3_column_count(stmt_); }
+  std::string_view columnName(int c) const { return sqlite3_column_name(stmt_, c); }
+  bool isNull(int c) const { return sqlite3_column_type(stmt_, c) == SQLITE_NULL; }
+  std::int64_t int64(int c) const { return sqlite3_column_int64(stmt_, c); }
+  double real(int c) const { return sqlite3_column_double(stmt_, c); }
+  // Empty for NULL.
+  std::string_view text(int c) const {
+    const auto* p = reinterpret_cast<const char*>(sqlite3_column_text(stmt_, c));
+    return p ? std::string_view(p, std::size_t(sqlite3_column_bytes(stmt_, c))) : std::string_view();
+  }
+  std::span<const std::byte> blob(int c) const {
+    const auto* p = static_cast<const std::byte*>(sqlite3_column_blob(stmt_, c));
+    return {p, p ? std::size_t(sqlite3_column_bytes(stmt_, c)) : 0};
+  }
+
+private:
+  sqlite3_stmt* stmt_;
+};
+
+class SqliteDb;
+
+struct CachedStatement {
+  std::string sql;
+  sqlite3_stmt* stmt;
+  bool inUse;
+};
+
+// A statement handed out by SqliteDb's cache. entry is null for an uncached copy,
+// which release() finalizes instead of returning.
+struct StatementHandle {
+  sqlite3_stmt* stmt = nullptr;
+  CachedStatement* entry = nullptr;
+};
+
+// Result of SqliteDb::query, iterated once with range-for. Holds the database lock
+// until destroyed; the loop body may use the same SqliteDb from this thread.
+class Rows {
+public:
+  class Iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Row;
+    using difference_type = std::ptrdiff_t;
+
+    Row operator*() const { return Row(rows_->stmt_.stmt); }
+    Iterator& operator++() {
+      rows_->step();
+      return *this;
+    }
+    void operator++(int) { rows_->step(); }
+    bool operator==(std::default_sentinel_t) const { return !rows_->hasRow_; }
+
+  private:
+    friend class Rows;
+    explicit Iterator(Rows* rows) : rows_(rows) {}
+    Rows* rows_;
+  };
+
+  Rows(Rows&& other) noexcept;
+  Rows(const Rows&) = delete;
+  Rows& operator=(const Rows&) = delete;
+  Rows& operator=(Rows&&) = delete;
+  ~Rows();
+
+  Iterator begin() { return Iterator(this); }
+  std::default_sentinel_t end() const { return {}; }
+  // False if the statement failed to prepare or a step failed (already logged).
+  bool ok() const { return ok_; }
+
+private:
+  friend class SqliteDb;
+  Rows(SqliteDb* db, std::unique_lock<std::recursive_mutex> lock, StatementHandle stmt);
+  void step();
+
+  SqliteDb* db_;
+  std::unique_lock<std::recursive_mutex> lock_;
+  StatementHandle stmt_;
+  bool hasRow_ = false;
+  bool ok_;
+};
+
+// Scoped transaction. Begins on construction (BEGIN IMMEDIATE, or a savepoint when a
+// transaction is already open) and rolls back on destruction unless commit() ran.
+// Holds the connection lock for its whole life, so this thread's statements land
+// inside it and other threads wait.
+class Transaction {
+public:
+  explicit Transaction(SqliteDb& db);
+  ~Transaction();
+
+  Transaction(const Transaction&) = delete;
+  Transaction& operator=(const Transaction&) = delete;
+
+  // False if BEGIN failed; statements then run outside any transaction.
+  bool active() const { return active_; }
+  bool commit();
+  void rollback();
+
+private:
+  SqliteDb& db_;
+  std::unique_lock<std::recursive_mutex> lock_;
+  bool nested_ = false;
+  bool active_ = false;
+};
+
+// execParams, execBatch and query keep their prepared statements in a small LRU
+// cache keyed on the SQL text; a hit is reset and re-bound instead of re-parsed.
+// exec() is for one-off scripts and bypasses it.
 class SqliteDb {
 public:
-  SqliteDb();
+  // statementCacheSize 0 prepares and finalizes on every call.
+  explicit SqliteDb(std::size_t statementCacheSize = 64);
   ~SqliteDb();
 
   SqliteDb(const SqliteDb&) = delete;
@@ -21,18 +183,43 @@ public:
   void close();
 
   bool exec(const std::string& sql);
-  bool execParams(const std::string& sql, const std::vector<std::string>& params);
+  bool execParams(const std::string& sql, std::initializer_list<Param> params = {});
+  bool execParams(const std::string& sql, const std::vector<Param>& params);
+  // Runs the statements in order inside one transaction, each prepared once and
+  // re-bound per row. All or nothing: any failure rolls the whole batch back.
+  bool execBatch(const std::vector<BatchStatement>& statements);
 
-  bool query(const std::string& sql, const std::vector<std::string>& params,
-             const std::function<void(int, char** , char**)>& rowCb);
+  //   for (const auto& row : db.query("SELECT url, ts FROM history WHERE ts > ?;", {since}))
+  //     use(row.text(0), row.int64(1));
+  Rows query(const std::string& sql, std::initializer_list<Param> params = {});
+  Rows query(const std::string& sql, const std::vector<Param>& params);
 
   sqlite3* handle() const { return db_; }
 
   std::string lastError() const;
+  std::size_t cachedStatementCount() const;
 
 private:
+  friend class Rows;
+  friend class Transaction;
+
   sqlite3* db_;
-  mutable std::mutex mu_;
+  // Recursive so a Transaction or an open Rows can keep it while the same thread
+  // issues further statements.
+  mutable std::recursive_mutex mu_;
+  std::size_t statementCacheSize_;
+  std::list<CachedStatement> lru_; // most recently used first
+  std::unordered_map<std::string_view, std::list<CachedStatement>::iterator> statements_;
+
+  // Both expect mu_ held. acquire() returns a null stmt (and logs) if preparing fails;
+  // release() must follow every successful acquire() with the same handle. A statement
+  // still in use further up this thread's stack is never handed out twice or evicted;
+  // a second user of the same SQL gets an uncached copy.
+  StatementHandle acquire(const std::string& sql);
+  void release(const StatementHandle& stmt);
+  bool execBound(const std::string& sql, const Param* params, std::size_t count);
+  Rows queryBound(const std::string& sql, const Param* params, std::size_t count);
+  static void bind(sqlite3_stmt* stmt, const Param* params, std::size_t count, sqlite3_destructor_type lifetime);
 };
 
 } // namespace core::storage
@@ -0,0 +1,77 @@
+#include "services/analysis/PageAnalysisService.h"
+#include "core/extract/ExtractionCache.h"
+#include "util/Log.h"
+#include "util/Time.h"
+
+namespace services::analysis {
+
+PageAnalysisService::PageAnalysisService(QObject* parent)
+  : QObject(parent),
+    pool_(core::exec::WorkStealingPool::shared()),
+    state_(std::make_shared<State>()) {
+  state_->workers.resize(pool_.size());
+  state_->owner = this;
+}
+
+PageAnalysisService::~PageAnalysisService() {
+  // Results already posted to us are dropped by Qt along with this object.
+  std::lock_guard<std::mutex> lk(state_->mu);
+  state_->owner = nullptr;
+}
+
+bool PageAnalysisService::alive(State& state) {
+  std::lock_guard<std::mutex> lk(state.mu);
+  return state.owner != nullptr;
+}
+
+void PageAnalysisService::deliver(State& state, const QPointer<QObject>& guard,
+                                  const std::function<void(const PageAnalysisPtr&)>& cb, PageAnalysisPtr result) {
+  // Deliver via the service (which outlives every tab) and re-check the context there.
+  // Posting under mu keeps the destructor from completing in between.
+  std::lock_guard<std::mutex> lk(state.mu);
+  if (!state.owner) return;
+  QMetaObject::invokeMethod(state.owner, [guard, cb, result]() {
+    if (guard) cb(result);
+  }, Qt::QueuedConnection);
+}
+
+void PageAnalysisService::analyzeAsync(const QUrl& url, const core::extract::HtmlSnapshotPtr& snapshot, QObject* context,
+                                       const std::function<void(const PageAnalysisPtr&)>& cb) {
+  if (!snapshot) return;
+  QPointer<QObject> guard(context);
+
+  pool_.submit([state = state_, url, snapshot, guard, cb](std::size_t worker) {
+    if (!alive(*state)) return;
+    Worker& w = state->workers[worker];
+
+    auto a = std::make_shared<PageAnalysis>();
+    a->url = url;
+    a->contentKey = snapshot->key;
+    a->page = core::extract::ExtractionCache::shared().getOrExtract(w.extractor, *snapshot);
+    a->entities = w.detector.detectPage(*a->page);
+    a->tsMs = util::now_ms();
+    deliver(*state, guard, cb, std::move(a));
+  });
+}
+
+void PageAnalysisService::analyzePageAsync(const QUrl& url, core::extract::ExtractedPage page, std::uint64_t modelVersion,
+                                           QObject* context, const std::function<void(const PageAnalysisPtr&)>& cb) {
+  QPointer<QObject> guard(context);
+
+  auto shared = std::make_shared<const core::extract::ExtractedPage>(std::move(page));
+  pool_.submit([state = state_, url, shared, modelVersion, guard, cb](std::size_t worker) {
+    if (!alive(*state)) return;
+    Worker& w = state->workers[worker];
+
+    auto a = std::make_shared<PageAnalysis>();
+    a->url = url;
+    a->contentKey = core::extract::ExtractionCache::keyFor(shared->canonicalUrl, shared->fullText);
+    a->page = shared;
+    a->entities = w.detector.detectPage(*shared);
+    a->modelVersion = modelVersion;
+    a->tsMs = util::now_ms();
+    deliver(*state, guard, cb, std::move(a));
+  });
+}
+
+} // namespace services::analysis
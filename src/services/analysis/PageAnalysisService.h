@@ -0,0 +1,69 @@
+#pragma once
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QUrl>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "core/exec/WorkStealingPool.h"
+#include "core/extract/HtmlExtractor.h"
+#include "core/extract/HtmlSnapshot.h"
+#include "core/entities/EntityDetector.h"
+
+namespace services::analysis {
+
+// Everything the side panel needs from a loaded page, computed ahead of time.
+struct PageAnalysis {
+  QUrl url;
+  std::uint64_t contentKey = 0;
+  std::shared_ptr<const core::extract::ExtractedPage> page;
+  std::vector<core::entities::EntityMention> entities;
+  std::uint64_t modelVersion = 0; // DocumentModel version it was built from; 0 for HTML snapshots
+  qint64 tsMs = 0;
+};
+
+using PageAnalysisPtr = std::shared_ptr<const PageAnalysis>;
+
+// Runs extraction and entity detection on the shared worker pool and
+// hands the result back on the GUI thread. Extraction goes through ExtractionCache,
+// so a later Analyze/Ask/Scrape on the same HTML is a cache hit as well.
+class PageAnalysisService : public QObject {
+  Q_OBJECT
+public:
+  explicit PageAnalysisService(QObject* parent = nullptr);
+  ~PageAnalysisService() override;
+
+  // cb runs on this object's thread, and only if context is still alive by then.
+  void analyzeAsync(const QUrl& url, const core::extract::HtmlSnapshotPtr& snapshot, QObject* context,
+                    const std::function<void(const PageAnalysisPtr&)>& cb);
+  // For pages already extracted elsewhere (a live DocumentModel): detection only.
+  void analyzePageAsync(const QUrl& url, core::extract::ExtractedPage page, std::uint64_t modelVersion,
+                        QObject* context, const std::function<void(const PageAnalysisPtr&)>& cb);
+
+private:
+  struct Worker {
+    core::extract::HtmlExtractor extractor;
+    core::entities::EntityDetector detector;
+  };
+
+  // Co-owned by the queued tasks, so the service can be destroyed without waiting for
+  // them: tasks that run later find owner cleared, skip their work and deliver nothing.
+  struct State {
+    std::vector<Worker> workers;
+    std::mutex mu;
+    PageAnalysisService* owner;
+  };
+
+  core::exec::WorkStealingPool& pool_;
+  std::shared_ptr<State> state_;
+
+  static bool alive(State& state);
+  static void deliver(State& state, const QPointer<QObject>& guard,
+                      const std::function<void(const PageAnalysisPtr&)>& cb, PageAnalysisPtr result);
+};
+
+} // namespace services::analysis
@@ -1,9 +1,21 @@
 \
 /* src/services/deepsearch/DeepSearchService.cpp */
 #include "services/deepsearch/DeepSearchService.h"
+#include "services/deepsearch/ProfileSearch.h"
 #include "util/Time.h"
+#include "util/Log.h"
+#include "core/exec/WorkStealingPool.h"
 #include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <QCoreApplication>
 #include <QCryptographicHash>
+#include <QPointer>
 
 namespace services::deepsearch {
 
@@ -20,12 +32,38 @@ EntityProfile DeepSearchService::buildProfileFromText(const QString& seedName, c
   EntityProfile p;
   p.name = seedName.toStdString();
   p.type = "person";
-  p.entityId = makeId(p.name, p.type);
+  p.entityId = canonicalId(p.name, p.type);
 
-  auto mentions = detector_.detect(extractedText.toStdString());
+  const std::string text = extractedText.toStdString();
+  auto mentions = detector_.detectParallel(text);
   p.confidence = 0.65;
   p.sources.push_back(url.toStdString());
 
+  addRelated(p, mentions);
+  return p;
+}
+
+EntityProfile DeepSearchService::buildProfileFromPage(const QString& seedName, const QString& url,
+                                                     const std::vector<core::entities::EntityMention>& mentions) {
+  EntityProfile p;
+  p.name = seedName.toStdString();
+  p.type = "person";
+  p.confidence = 0.65;
+
+  for (const auto& m : mentions) {
+    if (m.name != p.name) continue;
+    if (m.type != core::entities::EntityType::Unknown) p.type = core::entities::toString(m.type);
+    p.confidence = std::max(p.confidence, std::min(0.95, m.confidence));
+    break;
+  }
+  p.entityId = canonicalId(p.name, p.type);
+  p.sources.push_back(url.toStdString());
+
+  addRelated(p, mentions);
+  return p;
+}
+
+void DeepSearchService::addRelated(EntityProfile& p, const std::vector<core::entities::EntityMention>& mentions) {
   int added = 0;
   for (const auto& m : mentions) {
     if (m.name == p.name) continue;
@@ -36,36 +74,578 @@ EntityProfile DeepSearchService::buildProfileFromText(const QString& seedName, c
     p.related.push_back({m.name, rel});
     if (++added >= 10) break;
   }
-  return p;
+}
+
+static const char* kUpsertEntitySql =
+  "INSERT INTO entity_index(entity_id,name,type,aliases,ts) VALUES(?,?,?,?,?) "
+  "ON CONFLICT(entity_id) DO UPDATE SET name=excluded.name, type=excluded.type, aliases=excluded.aliases, ts=excluded.ts;";
+
+static std::vector<std::string> parseAliases(std::string_view s) {
+  std::vector<std::string> out;
+  const auto j = nlohmann::json::parse(s, nullptr, false);
+  if (j.is_array()) {
+    for (const auto& a : j) if (a.is_string()) out.push_back(a.get<std::string>());
+  }
+  return out;
+}
+
+void DeepSearchService::loadAliases() {
+  if (aliasesLoaded_ || !db_) return;
+  aliasesLoaded_ = true;
+
+  // Each row is its own entity here. Rows that look like duplicates of one another are
+  // only merged on request (findDuplicates, mergeEntities), never as a side effect of
+  // loading; new surface forms still join existing entities as they are resolved.
+  for (const auto& r : db_->query("SELECT entity_id,name,type,aliases FROM entity_index ORDER BY ts;")) {
+    aliases_.add({std::string(r.text(0)), std::string(r.text(1)), r.isNull(2) ? "unknown" : std::string(r.text(2)),
+                  parseAliases(r.text(3))});
+  }
+}
+
+void DeepSearchService::findDuplicates(QObject* context, std::function<void(const std::vector<EntityMerge>&)> cb) {
+  if (!db_) return;
+  struct Row { std::string id, name, type; };
+  auto rows = std::make_shared<std::vector<Row>>();
+  for (const auto& r : db_->query("SELECT entity_id,name,type FROM entity_index ORDER BY ts;")) {
+    rows->push_back({std::string(r.text(0)), std::string(r.text(1)), r.isNull(2) ? "unknown" : std::string(r.text(2))});
+  }
+
+  QPointer<QObject> guard(context);
+  core::exec::WorkStealingPool::shared().submit([rows, guard, cb](std::size_t) {
+    std::vector<std::pair<std::string, std::string>> names;
+    names.reserve(rows->size());
+    for (const auto& r : *rows) names.emplace_back(r.name, r.type);
+    const auto groups = core::entities::AliasResolver::cluster(names);
+
+    std::vector<EntityMerge> merges;
+    for (std::size_t i = 0; i < rows->size(); ++i) {
+      if (groups[i] == i) continue;
+      const Row& from = (*rows)[i];
+      const Row& into = (*rows)[groups[i]];
+      merges.push_back({from.id, from.name, into.id, into.name, from.type});
+    }
+    QMetaObject::invokeMethod(QCoreApplication::instance(), [guard, cb, merges = std::move(merges)]() {
+      if (guard) cb(merges);
+    }, Qt::QueuedConnection);
+  });
+}
+
+std::size_t DeepSearchService::mergeEntities(const std::vector<EntityMerge>& merges) {
+  if (!db_) return 0;
+  loadAliases();
+  std::unordered_map<std::string_view, std::size_t> byId;
+  for (std::size_t i = 0; i < aliases_.size(); ++i) byId.emplace(aliases_.entity(i).id, i);
+
+  const std::string ts = std::to_string(util::now_ms());
+  using core::storage::BatchStatement;
+  // Recorded before the row is deleted, so a merge of a row that is already gone
+  // leaves no audit entry and changes nothing else either.
+  BatchStatement record{
+    "INSERT INTO entity_merges(from_id,into_id,name,type,aliases,ts) "
+    "SELECT entity_id, ?, name, type, aliases, ? FROM entity_index WHERE entity_id = ?;",
+    {}};
+  BatchStatement relink{
+    "INSERT INTO entity_links(entity_id,doc_id,confidence,mentions_json) "
+    "SELECT ?, doc_id, confidence, mentions_json FROM entity_links WHERE entity_id = ? "
+    "ON CONFLICT(entity_id, doc_id) DO UPDATE SET confidence=MAX(confidence, excluded.confidence);",
+    {}};
+  BatchStatement dropLinks{"DELETE FROM entity_links WHERE entity_id = ?;", {}};
+  BatchStatement dropEntity{"DELETE FROM entity_index WHERE entity_id = ?;", {}};
+  // A relation between the duplicate and its canonical entity would become a self-loop;
+  // it is dropped with the duplicate's other rows instead.
+  BatchStatement relinkSrc{
+    "INSERT INTO entity_relations(src,dst,relation,weight,ts) "
+    "SELECT ?1, dst, relation, weight, ts FROM entity_relations WHERE src = ?2 AND dst <> ?1 "
+    "ON CONFLICT(src, dst, relation) DO UPDATE SET weight=weight+excluded.weight;",
+    {}};
+  BatchStatement relinkDst{
+    "INSERT INTO entity_relations(src,dst,relation,weight,ts) "
+    "SELECT src, ?1, relation, weight, ts FROM entity_relations WHERE dst = ?2 AND src <> ?1 "
+    "ON CONFLICT(src, dst, relation) DO UPDATE SET weight=weight+excluded.weight;",
+    {}};
+  BatchStatement dropRelations{"DELETE FROM entity_relations WHERE src = ? OR dst = ?;", {}};
+  BatchStatement relinkSourcesSrc{
+    "INSERT OR IGNORE INTO entity_relation_sources(src,source,dst,relation,ts) "
+    "SELECT ?1, source, dst, relation, ts FROM entity_relation_sources WHERE src = ?2 AND dst <> ?1;",
+    {}};
+  BatchStatement relinkSourcesDst{
+    "INSERT OR IGNORE INTO entity_relation_sources(src,source,dst,relation,ts) "
+    "SELECT src, source, ?1, relation, ts FROM entity_relation_sources WHERE dst = ?2 AND src <> ?1;",
+    {}};
+  BatchStatement dropSources{"DELETE FROM entity_relation_sources WHERE src = ? OR dst = ?;", {}};
+  // The summed weights above count a source twice when it asserted the relation for both
+  // entities, while its source rows collapse into one; recount the canonical entity's
+  // edges from their sources. Edges with no source rows predate them and keep the sum.
+  BatchStatement recount{
+    "UPDATE entity_relations SET weight = (SELECT COUNT(*) FROM entity_relation_sources s "
+    "WHERE s.src = entity_relations.src AND s.dst = entity_relations.dst AND s.relation = entity_relations.relation) "
+    "WHERE (src = ?1 OR dst = ?1) AND EXISTS(SELECT 1 FROM entity_relation_sources s "
+    "WHERE s.src = entity_relations.src AND s.dst = entity_relations.dst AND s.relation = entity_relations.relation);",
+    {}};
+  // Co-occurrence counts are keyed by entity id; have them rebuilt under the merged ids.
+  BatchStatement resetCooc{"DELETE FROM meta WHERE key IN ('cooc_docs', 'cooc_blocks');", {{}}};
+
+  std::vector<std::size_t> touched;
+  std::vector<std::string> merged; // log lines
+  std::unordered_set<std::string_view> gone;
+  for (const auto& m : merges) {
+    const auto from = byId.find(m.fromId);
+    const auto into = byId.find(m.intoId);
+    // Both must still exist (findDuplicates ran on a snapshot), and a row merged away
+    // in this batch cannot take further merges.
+    if (m.fromId == m.intoId || from == byId.end() || into == byId.end() || gone.count(m.fromId) || gone.count(m.intoId))
+      continue;
+    gone.insert(m.fromId);
+
+    const auto& dup = aliases_.entity(from->second);
+    const std::size_t e = into->second;
+    aliases_.addAlias(e, dup.name);
+    for (const auto& a : dup.aliases) aliases_.addAlias(e, a);
+    record.rows.push_back({m.intoId, ts, m.fromId});
+    relink.rows.push_back({m.intoId, m.fromId});
+    dropLinks.rows.push_back({m.fromId});
+    dropEntity.rows.push_back({m.fromId});
+    relinkSrc.rows.push_back({m.intoId, m.fromId});
+    relinkDst.rows.push_back({m.intoId, m.fromId});
+    dropRelations.rows.push_back({m.fromId, m.fromId});
+    relinkSourcesSrc.rows.push_back({m.intoId, m.fromId});
+    relinkSourcesDst.rows.push_back({m.intoId, m.fromId});
+    dropSources.rows.push_back({m.fromId, m.fromId});
+    recount.rows.push_back({m.intoId});
+    touched.push_back(e);
+    merged.push_back(dup.name + " (" + m.fromId + ") into " + aliases_.entity(e).name + " (" + m.intoId + ")");
+  }
+  if (touched.empty()) return 0;
+  if (!db_->execBatch({record, relink, dropLinks, dropEntity, relinkSrc, relinkDst, dropRelations, relinkSourcesSrc,
+                       relinkSourcesDst, dropSources, recount, entityRows(touched), resetCooc})) {
+    // The in-memory aliases were extended above; reload them to match the table again.
+    aliases_ = core::entities::AliasResolver();
+    aliasesLoaded_ = false;
+    return 0;
+  }
+  for (const auto& line : merged) util::Log::info("DeepSearch merged " + line);
+
+  // The merged-away entities are still in the resolver and the graph; rebuild both.
+  aliases_ = core::entities::AliasResolver();
+  aliasesLoaded_ = false;
+  if (graphLoaded_) {
+    graph_ = core::entities::EntityGraph();
+    graphLoaded_ = false;
+    loadGraph();
+  }
+  return merged.size();
+}
+
+std::size_t DeepSearchService::resolveEntity(const std::string& name, const std::string& type) {
+  loadAliases();
+  const std::ptrdiff_t found = aliases_.find(name, type);
+  if (found < 0) return aliases_.add({makeId(name, type), name, type, {}});
+  aliases_.addAlias(std::size_t(found), name);
+  return std::size_t(found);
+}
+
+std::string DeepSearchService::canonicalId(const std::string& name, const std::string& type) {
+  loadAliases();
+  const std::ptrdiff_t found = aliases_.find(name, type);
+  return found < 0 ? makeId(name, type) : aliases_.entity(std::size_t(found)).id;
+}
+
+core::storage::BatchStatement DeepSearchService::entityRows(std::vector<std::size_t> entities) const {
+  std::sort(entities.begin(), entities.end());
+  entities.erase(std::unique(entities.begin(), entities.end()), entities.end());
+
+  const std::string ts = std::to_string(util::now_ms());
+  core::storage::BatchStatement upsert{kUpsertEntitySql, {}};
+  upsert.rows.reserve(entities.size());
+  for (auto i : entities) {
+    const auto& e = aliases_.entity(i);
+    upsert.rows.push_back({e.id, e.name, e.type, nlohmann::json(e.aliases).dump(), ts});
+  }
+  return upsert;
 }
 
 bool DeepSearchService::upsertEntity(const EntityProfile& p) {
+  return upsertEntities({p});
+}
+
+// Type of a related entity, from the relation addRelated() gave it.
+static std::string relatedType(const std::string& relation) {
+  if (relation == "affiliated") return "org";
+  if (relation == "related_person") return "person";
+  if (relation == "location") return "place";
+  return "unknown";
+}
+
+bool DeepSearchService::upsertEntities(const std::vector<EntityProfile>& profiles) {
   if (!db_) return false;
-  const std::string aliases = "[]";
-  const std::int64_t ts = util::now_ms();
-  bool ok = db_->execParams(
-    "INSERT INTO entity_index(entity_id,name,type,aliases,ts) VALUES(?,?,?,?,?) "
-    "ON CONFLICT(entity_id) DO UPDATE SET name=excluded.name, type=excluded.type, aliases=excluded.aliases, ts=excluded.ts;",
-    {p.entityId, p.name, p.type, aliases, std::to_string(ts)}
-  );
-  return ok;
+  // What each (entity, source) pair asserts now; a profile without sources is its own
+  // anonymous source.
+  using Edge = std::pair<std::string, std::string>; // (dst id, relation)
+  std::map<std::pair<std::string, std::string>, std::set<Edge>> asserted;
+  std::vector<std::size_t> entities;
+  entities.reserve(profiles.size());
+  for (const auto& p : profiles) {
+    const std::size_t src = resolveEntity(p.name, p.type);
+    entities.push_back(src);
+    auto& edges = asserted[{aliases_.entity(src).id, p.sources.empty() ? std::string() : p.sources.front()}];
+    for (const auto& [name, relation] : p.related) {
+      const std::size_t dst = resolveEntity(name, relatedType(relation));
+      if (dst == src) continue;
+      entities.push_back(dst);
+      edges.insert({aliases_.entity(dst).id, relation});
+    }
+  }
+
+  // Diff against what the same sources asserted before: weights move by one per
+  // source that starts or stops asserting a relation, never per view.
+  struct Relation { std::string src, source, dst, relation; };
+  std::vector<Relation> added, removed;
+  for (const auto& [key, now] : asserted) {
+    std::set<Edge> before;
+    for (const auto& row : db_->query("SELECT dst, relation FROM entity_relation_sources WHERE src = ? AND source = ?;",
+                                      {key.first, key.second})) {
+      before.insert({std::string(row.text(0)), std::string(row.text(1))});
+    }
+    for (const auto& e : now) {
+      if (!before.count(e)) added.push_back({key.first, key.second, e.first, e.second});
+    }
+    for (const auto& e : before) {
+      if (!now.count(e)) removed.push_back({key.first, key.second, e.first, e.second});
+    }
+  }
+
+  const std::string ts = std::to_string(util::now_ms());
+  using core::storage::BatchStatement;
+  BatchStatement addSource{"INSERT OR IGNORE INTO entity_relation_sources(src,source,dst,relation,ts) VALUES(?,?,?,?,?);", {}};
+  BatchStatement dropSource{"DELETE FROM entity_relation_sources WHERE src = ? AND source = ? AND dst = ? AND relation = ?;", {}};
+  BatchStatement strengthen{
+    "INSERT INTO entity_relations(src,dst,relation,weight,ts) VALUES(?,?,?,1,?) "
+    "ON CONFLICT(src, dst, relation) DO UPDATE SET weight=weight+1, ts=excluded.ts;",
+    {}};
+  BatchStatement weaken{"UPDATE entity_relations SET weight=weight-1 WHERE src = ? AND dst = ? AND relation = ?;", {}};
+  BatchStatement prune{"DELETE FROM entity_relations WHERE src = ? AND dst = ? AND relation = ? AND weight <= 0;", {}};
+  for (const auto& r : added) {
+    addSource.rows.push_back({r.src, r.source, r.dst, r.relation, ts});
+    strengthen.rows.push_back({r.src, r.dst, r.relation, ts});
+  }
+  for (const auto& r : removed) {
+    dropSource.rows.push_back({r.src, r.source, r.dst, r.relation});
+    weaken.rows.push_back({r.src, r.dst, r.relation});
+    prune.rows.push_back({r.src, r.dst, r.relation});
+  }
+  if (!db_->execBatch({entityRows(std::move(entities)), addSource, dropSource, strengthen, weaken, prune})) return false;
+
+  if (graphLoaded_) {
+    for (const auto& r : added) {
+      graph_.addEdge(graph_.intern(r.src), graph_.intern(r.dst), 1.0f, graph_.internRelation(r.relation));
+    }
+    for (const auto& r : removed) {
+      graph_.removeEdge(graph_.intern(r.src), graph_.intern(r.dst), 1.0f, graph_.internRelation(r.relation));
+    }
+  }
+  return true;
 }
 
-std::vector<EntityProfile> DeepSearchService::searchProfiles(const QString& queryLike) {
-  std::vector<EntityProfile> out;
+void DeepSearchService::loadGraph() {
+  if (graphLoaded_ || !db_) return;
+  loadAliases();
+  graphLoaded_ = true;
+
+  std::vector<core::entities::EntityGraph::Edge> edges;
+  for (const auto& row : db_->query("SELECT src, dst, relation, weight FROM entity_relations;")) {
+    if (row.isNull(0) || row.isNull(1) || row.text(0) == row.text(1)) continue;
+    edges.push_back({graph_.intern(row.text(0)), graph_.intern(row.text(1)), row.isNull(3) ? 1.0f : float(row.real(3)),
+                     graph_.internRelation(row.isNull(2) ? "related" : row.text(2))});
+  }
+  graph_.build(edges);
+  util::Log::info("DeepSearch graph: " + std::to_string(graph_.nodeCount()) + " entities, " +
+                  std::to_string(edges.size()) + " relations");
+}
+
+NetworkNode DeepSearchService::describe(std::uint32_t node) {
+  NetworkNode n;
+  n.entityId = graph_.entityId(node);
+  n.name = n.entityId;
+  n.type = "unknown";
+  for (const auto& row : db_->query("SELECT name, type FROM entity_index WHERE entity_id = ?;", {n.entityId})) {
+    if (!row.isNull(0)) n.name = row.text(0);
+    if (!row.isNull(1)) n.type = row.text(1);
+  }
+  return n;
+}
+
+std::string DeepSearchService::edgeRelation(std::uint32_t from, std::uint32_t to) const {
+  std::string relation;
+  float best = 0;
+  graph_.forEachNeighbor(from, [&](std::uint32_t v, float w, std::uint16_t r) {
+    if (v == to && w > best) {
+      best = w;
+      relation = graph_.relationName(r);
+    }
+  });
+  return relation;
+}
+
+std::vector<NetworkNode> DeepSearchService::network(const std::string& entityId, int hops, int limit) {
+  std::vector<NetworkNode> out;
+  if (!db_ || limit <= 0) return out;
+  loadGraph();
+  const std::uint32_t src = graph_.find(entityId);
+  if (src == core::entities::EntityGraph::kNone) return out;
+
+  // Rank the neighbourhood by PageRank from the entity; fill up in BFS order when the
+  // walk reaches fewer nodes than asked for.
+  std::unordered_map<std::uint32_t, int> hopOf;
+  const auto hood = graph_.kHop(src, hops, 5000);
+  for (const auto& [node, h] : hood) hopOf.emplace(node, h);
+
+  std::vector<std::pair<std::uint32_t, double>> picked;
+  for (const auto& [node, score] : graph_.personalizedPageRank({src}, std::size_t(limit) * 4 + 1)) {
+    if (node != src && hopOf.count(node) && picked.size() < std::size_t(limit)) picked.push_back({node, score});
+  }
+  for (const auto& [node, h] : hood) {
+    if (picked.size() >= std::size_t(limit)) break;
+    if (node == src || std::any_of(picked.begin(), picked.end(), [&](const auto& p) { return p.first == node; })) continue;
+    picked.push_back({node, 0.0});
+  }
+
+  for (const auto& [node, score] : picked) {
+    NetworkNode n = describe(node);
+    n.hops = hopOf[node];
+    n.score = score;
+    if (n.hops == 1) n.relation = edgeRelation(src, node);
+    out.push_back(std::move(n));
+  }
+  return out;
+}
+
+std::vector<NetworkNode> DeepSearchService::pathBetween(const std::string& fromId, const std::string& toId) {
+  std::vector<NetworkNode> out;
+  if (!db_) return out;
+  loadGraph();
+  const auto path = graph_.shortestPath(graph_.find(fromId), graph_.find(toId));
+  for (std::size_t i = 0; i < path.size(); ++i) {
+    NetworkNode n = describe(path[i]);
+    n.hops = int(i);
+    if (i > 0) n.relation = edgeRelation(path[i - 1], path[i]);
+    out.push_back(std::move(n));
+  }
+  return out;
+}
+
+std::string DeepSearchService::mentionsJson(const core::entities::EntityMention& m) {
+  auto spans = nlohmann::json::array();
+  for (const auto& s : m.spans) spans.push_back({{"block", s.blockId}, {"begin", s.begin}, {"end", s.end}});
+  return spans.dump();
+}
+
+bool DeepSearchService::indexDocument(const QString& url, const core::extract::ExtractedPage& page,
+                                      const std::vector<core::entities::EntityMention>& mentions) {
+  if (!db_ || url.isEmpty()) return false;
+  const std::string key = url.toStdString();
+  const std::string ts = std::to_string(util::now_ms());
+
+  using core::storage::BatchStatement;
+  BatchStatement doc{
+    "INSERT INTO local_docs(url_or_path,title,ts,content) VALUES(?,?,?,?) "
+    "ON CONFLICT(url_or_path) DO UPDATE SET title=excluded.title, ts=excluded.ts, content=excluded.content;",
+    {{key, page.title, ts, page.fullText}}};
+  // Links are replaced wholesale, so entities no longer on the page drop out.
+  BatchStatement clear{"DELETE FROM entity_links WHERE doc_id = (SELECT id FROM local_docs WHERE url_or_path = ?);", {{key}}};
+  BatchStatement links{
+    "INSERT INTO entity_links(entity_id,doc_id,confidence,mentions_json) "
+    "VALUES(?, (SELECT id FROM local_docs WHERE url_or_path = ?), ?, ?) "
+    "ON CONFLICT(entity_id, doc_id) DO UPDATE SET confidence=MAX(confidence, excluded.confidence);",
+    {}};
+
+  // Several surface forms of one entity collapse into a single link.
+  std::map<std::size_t, core::entities::EntityMention> merged;
+  for (const auto& m : mentions) {
+    const std::size_t e = resolveEntity(m.name, core::entities::toString(m.type));
+    auto [it, fresh] = merged.try_emplace(e, m);
+    if (fresh) continue;
+    it->second.confidence = std::max(it->second.confidence, m.confidence);
+    it->second.spans.insert(it->second.spans.end(), m.spans.begin(), m.spans.end());
+  }
+
+  std::vector<std::size_t> ids;
+  links.rows.reserve(merged.size());
+  for (const auto& [e, m] : merged) {
+    ids.push_back(e);
+    links.rows.push_back({aliases_.entity(e).id, key, std::to_string(m.confidence), mentionsJson(m)});
+  }
+  const BatchStatement entities = entityRows(std::move(ids));
+
+  // Co-occurrence moves by the difference between the page's previous links and these.
+  ensureCooccurrence();
+  core::entities::CooccurrenceDelta delta;
+  delta.add(storedOccurrences(key), -1);
+  core::entities::DocumentOccurrences now;
+  for (const auto& [e, m] : merged) {
+    auto& blocks = now[aliases_.entity(e).id];
+    for (const auto& span : m.spans) {
+      if (!span.blockId.empty()) blocks.push_back(span.blockId);
+    }
+  }
+  delta.add(std::move(now));
+  delta.prune();
+
+  std::vector<BatchStatement> batch{doc, entities, clear, links};
+  appendCooccurrence(delta, batch);
+  return db_->execBatch(batch);
+}
+
+std::vector<std::string> DeepSearchService::spanBlocks(std::string_view mentionsJson) {
+  std::vector<std::string> out;
+  if (mentionsJson.empty()) return out;
+  const auto j = nlohmann::json::parse(mentionsJson, nullptr, false);
+  if (!j.is_array()) return out;
+  for (const auto& span : j) {
+    if (!span.is_object()) continue;
+    const auto it = span.find("block");
+    if (it != span.end() && it->is_string() && !it->get_ref<const std::string&>().empty()) out.push_back(it->get<std::string>());
+  }
+  return out;
+}
+
+core::entities::DocumentOccurrences DeepSearchService::storedOccurrences(const std::string& url) {
+  core::entities::DocumentOccurrences occ;
+  for (const auto& row : db_->query("SELECT l.entity_id, l.mentions_json FROM entity_links l "
+                                    "JOIN local_docs d ON d.id = l.doc_id WHERE d.url_or_path = ?;",
+                                    {url})) {
+    occ[std::string(row.text(0))] = spanBlocks(row.text(1));
+  }
+  return occ;
+}
+
+void DeepSearchService::appendCooccurrence(const core::entities::CooccurrenceDelta& delta,
+                                           std::vector<core::storage::BatchStatement>& batch) {
+  using core::storage::BatchStatement;
+  BatchStatement stats{
+    "INSERT INTO entity_stats(entity_id,docs,blocks) VALUES(?,?,?) "
+    "ON CONFLICT(entity_id) DO UPDATE SET docs=docs+excluded.docs, blocks=blocks+excluded.blocks;",
+    {}};
+  BatchStatement pairs{
+    "INSERT INTO entity_cooc(a,b,docs,blocks) VALUES(?,?,?,?) "
+    "ON CONFLICT(a, b) DO UPDATE SET docs=docs+excluded.docs, blocks=blocks+excluded.blocks;",
+    {}};
+  // Rows that dropped to zero are removed, so the tables stay as sparse as the corpus.
+  BatchStatement dropStats{"DELETE FROM entity_stats WHERE entity_id = ? AND docs <= 0;", {}};
+  BatchStatement dropPairs{"DELETE FROM entity_cooc WHERE a = ? AND b = ? AND docs <= 0;", {}};
+  BatchStatement totals{
+    "INSERT INTO meta(key,value) VALUES(?,?) "
+    "ON CONFLICT(key) DO UPDATE SET value=CAST(value AS INTEGER)+CAST(excluded.value AS INTEGER);",
+    {{"cooc_docs", std::to_string(delta.docs())}, {"cooc_blocks", std::to_string(delta.blocks())}}};
+
+  for (const auto& [id, c] : delta.entities()) {
+    stats.rows.push_back({id, std::to_string(c.docs), std::to_string(c.blocks)});
+    if (c.docs < 0) dropStats.rows.push_back({id});
+  }
+  for (const auto& [ab, c] : delta.pairs()) {
+    const std::string docs = std::to_string(c.docs), blocks = std::to_string(c.blocks);
+    pairs.rows.push_back({ab.first, ab.second, docs, blocks});
+    pairs.rows.push_back({ab.second, ab.first, docs, blocks});
+    if (c.docs < 0) {
+      dropPairs.rows.push_back({ab.first, ab.second});
+      dropPairs.rows.push_back({ab.second, ab.first});
+    }
+  }
+  for (auto* st : {&stats, &pairs, &dropStats, &dropPairs, &totals}) batch.push_back(std::move(*st));
+}
+
+void DeepSearchService::ensureCooccurrence() {
+  if (!db_) return;
+  bool present = false;
+  for (const auto& row : db_->query("SELECT 1 FROM meta WHERE key = 'cooc_docs';")) present = row.int64(0) == 1;
+  if (!present && rebuildCooccurrence()) util::Log::info("DeepSearch rebuilt entity co-occurrence tables");
+}
+
+bool DeepSearchService::rebuildCooccurrence() {
+  core::entities::CooccurrenceDelta all;
+  core::entities::DocumentOccurrences occ;
+  std::int64_t doc = -1;
+  for (const auto& row : db_->query("SELECT doc_id, entity_id, mentions_json FROM entity_links ORDER BY doc_id;")) {
+    if (row.int64(0) != doc) {
+      all.add(std::move(occ));
+      occ.clear();
+      doc = row.int64(0);
+    }
+    occ[std::string(row.text(1))] = spanBlocks(row.text(2));
+  }
+  all.add(std::move(occ));
+
+  using core::storage::BatchStatement;
+  std::vector<BatchStatement> batch{
+    {"DELETE FROM entity_cooc;", {{}}},
+    {"DELETE FROM entity_stats;", {{}}},
+    {"DELETE FROM meta WHERE key IN ('cooc_docs', 'cooc_blocks');", {{}}}};
+  appendCooccurrence(all, batch);
+  return db_->execBatch(batch);
+}
+
+std::vector<RelatedEntity> DeepSearchService::relatedEntities(const std::string& entityId, int limit, int minDocs) {
+  std::vector<RelatedEntity> out;
+  if (!db_) return out;
+  ensureCooccurrence();
+
+  std::int64_t totalDocs = 0, totalBlocks = 0, ownDocs = 0, ownBlocks = 0;
+  for (const auto& row : db_->query("SELECT key, value FROM meta WHERE key IN ('cooc_docs', 'cooc_blocks');")) {
+    (row.text(0) == "cooc_docs" ? totalDocs : totalBlocks) = row.int64(1);
+  }
+  for (const auto& row : db_->query("SELECT docs, blocks FROM entity_stats WHERE entity_id = ?;", {entityId})) {
+    ownDocs = row.int64(0);
+    ownBlocks = row.int64(1);
+  }
+  if (ownDocs <= 0) return out;
+
+  for (const auto& row : db_->query("SELECT c.b, COALESCE(e.name, c.b), COALESCE(e.type, 'unknown'), c.docs, c.blocks, "
+                                    "s.docs, s.blocks FROM entity_cooc c JOIN entity_stats s ON s.entity_id = c.b "
+                                    "LEFT JOIN entity_index e ON e.entity_id = c.b WHERE c.a = ? AND c.docs >= ?;",
+                                    {entityId, minDocs})) {
+    RelatedEntity r;
+    r.entityId = row.text(0);
+    r.name = row.text(1);
+    r.type = row.text(2);
+    r.docs = row.int64(3);
+    r.blocks = row.int64(4);
+    r.score = std::max(core::entities::npmi(r.docs, ownDocs, row.int64(5), totalDocs),
+                       core::entities::npmi(r.blocks, ownBlocks, row.int64(6), totalBlocks));
+    out.push_back(std::move(r));
+  }
+
+  auto stronger = [](const RelatedEntity& a, const RelatedEntity& b) {
+    if (a.score != b.score) return a.score > b.score;
+    if (a.docs != b.docs) return a.docs > b.docs;
+    return a.name < b.name;
+  };
+  const std::size_t keep = std::min(out.size(), std::size_t(std::max(limit, 0)));
+  std::partial_sort(out.begin(), out.begin() + keep, out.end(), stronger);
+  out.resize(keep);
+  return out;
+}
+
+std::vector<std::string> DeepSearchService::documentsMentioning(const std::string& entityId, int limit) {
+  std::vector<std::string> out;
   if (!db_) return out;
+  for (const auto& row : db_->query("SELECT d.url_or_path FROM entity_links l JOIN local_docs d ON d.id = l.doc_id "
+                                    "WHERE l.entity_id = ? ORDER BY l.confidence DESC, d.ts DESC LIMIT ?;",
+                                    {entityId, limit})) {
+    out.push_back(std::string(row.text(0)));
+  }
+  return out;
+}
 
-  std::string like = "%" + queryLike.toStdString() + "%";
-  db_->query("SELECT entity_id,name,type,ts FROM entity_index WHERE name LIKE ? ORDER BY ts DESC LIMIT 25;",
-             {like},
-             [&](int, char** vals, char**) {
-               EntityProfile p;
-               p.entityId = vals[0] ? vals[0] : "";
-               p.name = vals[1] ? vals[1] : "";
-               p.type = vals[2] ? vals[2] : "unknown";
-               p.confidence = 0.60;
-               out.push_back(p);
-             });
+std::vector<EntityProfile> DeepSearchService::searchProfiles(const QString& query, int limit) {
+  std::vector<EntityProfile> out;
+  if (!db_ || limit <= 0) return out;
+  for (auto& m : ProfileSearch(*db_).search(query.toStdString(), std::size_t(limit))) {
+    EntityProfile p;
+    p.entityId = std::move(m.entityId);
+    p.name = std::move(m.name);
+    p.type = std::move(m.type);
+    p.confidence = 0.60;
+    out.push_back(std::move(p));
+  }
   return out;
 }
 
@@ -3,10 +3,14 @@
 #pragma once
 #include <QObject>
 #include <QString>
+#include <functional>
 #include <vector>
 #include <nlohmann/json.hpp>
 
 #include "core/storage/SqliteDb.h"
+#include "core/entities/AliasResolver.h"
+#include "core/entities/Cooccurrence.h"
+#include "core/entities/EntityGraph.h"
 #include "core/entities/EntityDetector.h"
 
 namespace services::deepsearch {
@@ -20,22 +24,117 @@ struct EntityProfile {
   std::vector<std::pair<std::string, std::string>> related; // (name, relation)
 };
 
+struct RelatedEntity {
+  std::string entityId;
+  std::string name;
+  std::string type;
+  std::int64_t docs = 0;   // documents mentioning both
+  std::int64_t blocks = 0; // blocks mentioning both
+  double score = 0.0;      // NPMI, the stronger of the document and block windows
+};
+
+// One duplicate entity_index row and the canonical entity it would be merged into.
+struct EntityMerge {
+  std::string fromId;
+  std::string fromName;
+  std::string intoId;
+  std::string intoName;
+  std::string type;
+};
+
+struct NetworkNode {
+  std::string entityId;
+  std::string name;
+  std::string type;
+  int hops = 0;
+  std::string relation; // of the edge leading here (profile neighbours, path steps)
+  double score = 0.0;   // personalized PageRank from the profile
+};
+
 class DeepSearchService : public QObject {
   Q_OBJECT
 public:
   explicit DeepSearchService(core::storage::SqliteDb* db, QObject* parent = nullptr);
 
   EntityProfile buildProfileFromText(const QString& seedName, const QString& url, const QString& extractedText);
-  std::vector<EntityProfile> searchProfiles(const QString& queryLike);
+  // From mentions already detected on the page (EntityDetector::detectPage), so its
+  // structured data counts: a declared type for the seed beats the "person" guess, and
+  // declared entities lead the related list.
+  EntityProfile buildProfileFromPage(const QString& seedName, const QString& url,
+                                     const std::vector<core::entities::EntityMention>& mentions);
+  // Profiles whose name or aliases match query, best first (see ProfileSearch). Served
+  // by the trigram index; queries under three characters use a name-prefix index instead.
+  std::vector<EntityProfile> searchProfiles(const QString& query, int limit = 25);
 
+  // Profiles are stored under their canonical entity (see AliasResolver); a new surface
+  // form is appended to that entity's aliases. Related pairs become entity_relations
+  // rows and graph edges, weighted by how many sources assert them: a profile built
+  // again from the same source replaces that source's relations instead of adding to them.
   bool upsertEntity(const EntityProfile& p);
+  bool upsertEntities(const std::vector<EntityProfile>& profiles);
+
+  // Stores the page as a local_docs row (keyed by URL) and replaces its entity_links
+  // with the detected mentions, including their block offsets, in one transaction.
+  // Mentions that resolve to the same canonical entity share one link.
+  bool indexDocument(const QString& url, const core::extract::ExtractedPage& page,
+                     const std::vector<core::entities::EntityMention>& mentions);
+  // URLs of the documents linked to an entity, most confident first.
+  std::vector<std::string> documentsMentioning(const std::string& entityId, int limit = 25);
+  // Entities seen together with entityId anywhere in the indexed corpus, strongest
+  // association first. Reads the co-occurrence tables that indexDocument() keeps up
+  // to date; nothing is re-detected.
+  std::vector<RelatedEntity> relatedEntities(const std::string& entityId, int limit = 10, int minDocs = 1);
   nlohmann::json profileToJson(const EntityProfile& p) const;
 
+  // Clusters entity_index on the worker pool and reports the rows that look like
+  // duplicates of another (see AliasResolver::cluster); nothing is changed. cb runs on
+  // the GUI thread, only while context is alive.
+  void findDuplicates(QObject* context, std::function<void(const std::vector<EntityMerge>&)> cb);
+  // Applies merges in one transaction: links and relations move to the canonical id and
+  // the duplicate row is deleted. Each merge is logged and recorded in entity_merges
+  // with the removed row. Merges whose rows no longer exist are skipped; returns the
+  // number applied.
+  std::size_t mergeEntities(const std::vector<EntityMerge>& merges);
+
+  // Loads entity_relations into the in-memory graph; later upserts add their edges to
+  // it directly. Called once at startup (queries load it on demand otherwise).
+  void loadGraph();
+  // The entity's neighbourhood within hops, ranked by personalized PageRank from it.
+  std::vector<NetworkNode> network(const std::string& entityId, int hops = 2, int limit = 15);
+  // Fewest-hop chain of relations from one entity to another; empty if none.
+  std::vector<NetworkNode> pathBetween(const std::string& fromId, const std::string& toId);
+
 private:
   core::storage::SqliteDb* db_;
   core::entities::EntityDetector detector_;
+  core::entities::AliasResolver aliases_;
+  bool aliasesLoaded_ = false;
+  core::entities::EntityGraph graph_;
+  bool graphLoaded_ = false;
+
+  // Fills aliases_ from entity_index on first use, one entity per row.
+  void loadAliases();
+  // Canonical entity for a surface form, created if unknown; the form is recorded as an
+  // alias. Callers upsert the entity's row (entityRows) to persist it.
+  std::size_t resolveEntity(const std::string& name, const std::string& type);
+  std::string canonicalId(const std::string& name, const std::string& type);
+  core::storage::BatchStatement entityRows(std::vector<std::size_t> entities) const;
+
+  // Co-occurrence tables: rebuilt from entity_links when their totals are missing
+  // (new schema, or after alias merges), otherwise updated per document by delta.
+  void ensureCooccurrence();
+  bool rebuildCooccurrence();
+  core::entities::DocumentOccurrences storedOccurrences(const std::string& url);
+  static void appendCooccurrence(const core::entities::CooccurrenceDelta& delta,
+                                 std::vector<core::storage::BatchStatement>& batch);
+  static std::vector<std::string> spanBlocks(std::string_view mentionsJson);
+
+  NetworkNode describe(std::uint32_t node);
+  std::string edgeRelation(std::uint32_t from, std::uint32_t to) const;
 
   static std::string makeId(const std::string& name, const std::string& type);
+  static std::string mentionsJson(const core::entities::EntityMention& m);
+  static void addRelated(EntityProfile& p, const std::vector<core::entities::EntityMention>& mentions);
 };
 
 } // namespace services::deepsearch
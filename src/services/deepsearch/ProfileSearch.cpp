@@ -0,0 +1,158 @@
+#include "services/deepsearch/ProfileSearch.h"
+#include "core/storage/SqliteDb.h"
+#include "util/Utf8.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace services::deepsearch {
+
+std::vector<std::string> ProfileSearch::trigrams(std::string_view s) {
+  std::vector<std::size_t> starts;
+  for (std::size_t i = 0; i < s.size(); ++i) {
+    if ((static_cast<unsigned char>(s[i]) & 0xC0) != 0x80) starts.push_back(i);
+  }
+  starts.push_back(s.size());
+  std::vector<std::string> out;
+  for (std::size_t i = 0; i + 3 < starts.size(); ++i) out.emplace_back(s.substr(starts[i], starts[i + 3] - starts[i]));
+  std::sort(out.begin(), out.end());
+  out.erase(std::unique(out.begin(), out.end()), out.end());
+  return out;
+}
+
+double ProfileSearch::matchScore(std::string_view q, const std::vector<std::string>& qGrams, std::string_view candidate) {
+  if (candidate == q) return 1.0;
+  if (candidate.starts_with(q)) return 0.9;
+  if (candidate.find(q) != std::string_view::npos) return 0.8;
+  const auto cGrams = trigrams(candidate);
+  std::vector<std::string> common;
+  std::set_intersection(qGrams.begin(), qGrams.end(), cGrams.begin(), cGrams.end(), std::back_inserter(common));
+  const std::size_t unionSize = qGrams.size() + cGrams.size() - common.size();
+  return unionSize ? 0.7 * double(common.size()) / double(unionSize) : 0.0;
+}
+
+static std::string ftsPhrase(std::string_view s) {
+  std::string out = "\"";
+  for (char c : s) {
+    out += c;
+    if (c == '"') out += '"';
+  }
+  return out + "\"";
+}
+
+static std::string_view trim(std::string_view s) {
+  const auto space = [](char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; };
+  while (!s.empty() && space(s.front())) s.remove_prefix(1);
+  while (!s.empty() && space(s.back())) s.remove_suffix(1);
+  return s;
+}
+
+std::vector<ProfileMatch> ProfileSearch::search(std::string_view query, std::size_t limit) const {
+  std::vector<ProfileMatch> out;
+  const std::string q = util::utf8::toLower(trim(query));
+  if (q.empty() || limit == 0) return out;
+  const auto qGrams = trigrams(q);
+
+  struct Hit {
+    ProfileMatch match;
+    double rank;
+  };
+  std::vector<Hit> hits;
+  std::unordered_set<std::string> seen;
+  // Columns: entity_id, name, type, aliases.
+  auto add = [&](const core::storage::Row& row, double rank) {
+    std::string id(row.text(0));
+    if (!seen.insert(id).second) return;
+    ProfileMatch m;
+    m.entityId = std::move(id);
+    m.name = row.text(1);
+    m.type = row.isNull(2) ? "unknown" : std::string(row.text(2));
+    m.score = matchScore(q, qGrams, util::utf8::toLower(m.name));
+    const auto aliases = nlohmann::json::parse(row.text(3), nullptr, false);
+    if (aliases.is_array()) {
+      for (const auto& a : aliases) {
+        if (a.is_string()) m.score = std::max(m.score, 0.95 * matchScore(q, qGrams, util::utf8::toLower(a.get<std::string>())));
+      }
+    }
+    if (m.score >= kMinScore) hits.push_back({std::move(m), rank});
+  };
+
+  if (qGrams.empty()) {
+    // Too short for trigrams: name prefix through the NOCASE index.
+    std::string prefix;
+    for (char c : q) {
+      if (c != '%' && c != '_') prefix += c;
+    }
+    for (const auto& row : db_.query("SELECT entity_id, name, type, aliases FROM entity_index WHERE name LIKE ? "
+                                     "ORDER BY ts DESC LIMIT ?;",
+                                     {prefix + "%", kMaxCandidates})) {
+      add(row, 0);
+    }
+  } else {
+    // Exact, prefix and substring matches all contain the whole query as a phrase.
+    for (const auto& row : db_.query("SELECT e.entity_id, e.name, e.type, e.aliases, entity_fts.rank FROM entity_fts "
+                                     "JOIN entity_index e ON e.id = entity_fts.rowid WHERE entity_fts MATCH ? "
+                                     "ORDER BY entity_fts.rank LIMIT ?;",
+                                     {ftsPhrase(q), kMaxCandidates})) {
+      add(row, row.real(4));
+    }
+    if (hits.size() < limit) {
+      // Fuzzy: count the query trigrams each row shares by walking their posting lists,
+      // without bm25, and score only the rows that share enough to reach kMinScore.
+      // The Jaccard union is at least qGrams.size(), so fewer shared trigrams than
+      // kMinScore / 0.7 of it can never qualify. Lists are read rarest first, within
+      // kMaxPostings rows in all; a trigram left unread lowers that bound by one.
+      std::vector<std::pair<std::int64_t, const std::string*>> present; // (documents, trigram)
+      for (const auto& g : qGrams) {
+        for (const auto& row : db_.query("SELECT doc FROM entity_fts_vocab WHERE term = ?;", {g})) {
+          present.push_back({row.int64(0), &g});
+        }
+      }
+      std::sort(present.begin(), present.end());
+      std::size_t used = 0, budget = kMaxPostings;
+      while (used < present.size() && used < kMaxQueryTrigrams &&
+             (used == 0 || std::size_t(present[used].first) <= budget)) {
+        budget -= std::min(budget, std::size_t(present[used].first));
+        ++used;
+      }
+      const std::size_t bound = (2 * qGrams.size() + 6) / 7; // ceil(qGrams * 0.2 / 0.7)
+      const std::size_t unused = present.size() - used;
+      const std::size_t need = bound > unused ? std::max<std::size_t>(1, bound - unused) : 1;
+
+      std::unordered_map<std::int64_t, std::size_t> shared;
+      for (std::size_t i = 0; i < used; ++i) {
+        // Only the rarest list can exceed the budget; it is cut short rather than skipped.
+        for (const auto& row : db_.query("SELECT rowid FROM entity_fts WHERE entity_fts MATCH ? LIMIT ?;",
+                                         {ftsPhrase(*present[i].second), kMaxPostings})) {
+          ++shared[row.int64(0)];
+        }
+      }
+      std::vector<std::pair<std::size_t, std::int64_t>> candidates; // (shared, rowid)
+      for (const auto& [rowid, n] : shared) {
+        if (n >= need) candidates.push_back({n, rowid});
+      }
+      const std::size_t keep = std::min(candidates.size(), kMaxCandidates);
+      std::partial_sort(candidates.begin(), candidates.begin() + std::ptrdiff_t(keep), candidates.end(),
+                        [](const auto& a, const auto& b) { return a.first != b.first ? a.first > b.first : a.second < b.second; });
+      for (std::size_t i = 0; i < keep; ++i) {
+        for (const auto& row : db_.query("SELECT entity_id, name, type, aliases FROM entity_index WHERE id = ?;",
+                                         {candidates[i].second})) {
+          add(row, -double(candidates[i].first)); // more shared trigrams rank first
+        }
+      }
+    }
+  }
+
+  std::sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b) {
+    if (a.match.score != b.match.score) return a.match.score > b.match.score;
+    if (a.rank != b.rank) return a.rank < b.rank; // bm25: lower is better
+    return a.match.name < b.match.name;
+  });
+  for (std::size_t i = 0; i < hits.size() && i < limit; ++i) out.push_back(std::move(hits[i].match));
+  return out;
+}
+
+} // namespace services::deepsearch
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace core::storage { class SqliteDb; }
+
+namespace services::deepsearch {
+
+struct ProfileMatch {
+  std::string entityId;
+  std::string name;
+  std::string type;
+  double score = 0.0;
+};
+
+// Profile lookup over entity_index and its trigram index (entity_fts), best first:
+// exact, then prefix, then substring, then fuzzy (shared trigrams), ties by FTS rank.
+// The query and names are lower-cased with util::utf8::toLower, the folding the
+// trigram tokenizer applies, so the tiers hold for "Łukasz" as they do for "Lukas".
+class ProfileSearch {
+public:
+  // Rows scored per tier, and query trigrams used for fuzzy candidates.
+  static constexpr std::size_t kMaxCandidates = 200;
+  static constexpr std::size_t kMaxQueryTrigrams = 16;
+  // Posting-list rows the fuzzy tier reads per search, rarest trigrams first.
+  static constexpr std::size_t kMaxPostings = 20000;
+  // Fuzzy matches sharing only a trigram or two score below this and are dropped.
+  static constexpr double kMinScore = 0.2;
+
+  explicit ProfileSearch(core::storage::SqliteDb& db) : db_(db) {}
+
+  std::vector<ProfileMatch> search(std::string_view query, std::size_t limit) const;
+
+  // Distinct overlapping three-code-point windows, sorted; as the tokenizer cuts them.
+  static std::vector<std::string> trigrams(std::string_view s);
+  // 1 exact, 0.9 prefix, 0.8 substring, below 0.7 by trigram Jaccard. Both sides
+  // already lower-cased; qGrams is trigrams(q).
+  static double matchScore(std::string_view q, const std::vector<std::string>& qGrams, std::string_view candidate);
+
+private:
+  core::storage::SqliteDb& db_;
+};
+
+} // namespace services::deepsearch
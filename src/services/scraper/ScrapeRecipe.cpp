@@ -0,0 +1,176 @@
+#include "services/scraper/ScrapeRecipe.h"
+#include "core/extract/BatchExtractor.h"
+#include "core/extract/HtmlExtractor.h"
+#include "core/net/LinkResolver.h"
+#include "core/storage/SqliteDb.h"
+#include "util/Log.h"
+#include <QUrl>
+#include <algorithm>
+#include <cctype>
+
+namespace services::scraper {
+
+static std::string_view trim(std::string_view s) {
+  while (!s.empty() && std::isspace((unsigned char)s.front())) s.remove_prefix(1);
+  while (!s.empty() && std::isspace((unsigned char)s.back())) s.remove_suffix(1);
+  return s;
+}
+
+static bool isNameChar(char c) {
+  return std::isalnum((unsigned char)c) || c == '-' || c == '_';
+}
+
+static std::string recipeKey(const std::string& host) {
+  return "scraper.recipe." + host;
+}
+
+bool ScrapeRecipe::parse(std::string_view text, ScrapeRecipe& out, std::string* error) {
+  out.fields.clear();
+  std::size_t lineNo = 0;
+  while (!text.empty()) {
+    const std::size_t nl = text.find('\n');
+    std::string_view line = trim(text.substr(0, nl));
+    text = nl == std::string_view::npos ? std::string_view() : text.substr(nl + 1);
+    ++lineNo;
+    if (line.empty()) continue;
+
+    RecipeField f;
+    // "name =" prefix; selectors themselves only contain '=' inside [...].
+    std::size_t i = 0;
+    while (i < line.size() && isNameChar(line[i])) ++i;
+    std::size_t j = i;
+    while (j < line.size() && std::isspace((unsigned char)line[j])) ++j;
+    if (i > 0 && j < line.size() && line[j] == '=') {
+      f.name = std::string(line.substr(0, i));
+      line = trim(line.substr(j + 1));
+    }
+    // "@attr" suffix, unless the '@' sits inside a quoted attribute value.
+    const std::size_t at = line.rfind('@');
+    if (at != std::string_view::npos) {
+      std::string_view attr = trim(line.substr(at + 1));
+      const auto quotes = std::count_if(line.begin(), line.begin() + at, [](char c) { return c == '"' || c == '\''; });
+      if (!attr.empty() && quotes % 2 == 0 && std::all_of(attr.begin(), attr.end(), isNameChar)) {
+        f.attr = std::string(attr);
+        std::transform(f.attr.begin(), f.attr.end(), f.attr.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+        line = trim(line.substr(0, at));
+      }
+    }
+    if (line.empty()) {
+      if (error) *error = "line " + std::to_string(lineNo) + ": missing selector";
+      return false;
+    }
+    f.selector = std::string(line);
+    if (f.name.empty()) f.name = f.selector;
+    out.fields.push_back(std::move(f));
+  }
+  if (out.fields.empty()) {
+    if (error) *error = "no selectors";
+    return false;
+  }
+  return true;
+}
+
+std::string ScrapeRecipe::toText() const {
+  std::string s;
+  for (const auto& f : fields) {
+    if (f.name != f.selector) s += f.name + " = ";
+    s += f.selector;
+    if (!f.attr.empty()) s += " @" + f.attr;
+    s += "\n";
+  }
+  return s;
+}
+
+bool CompiledRecipe::compile(const ScrapeRecipe& recipe, std::string* error) {
+  fields_.clear();
+  selectors_ = core::extract::SelectorSet();
+  for (const auto& f : recipe.fields) {
+    std::string err;
+    if (selectors_.add(f.selector, &err) < 0) {
+      if (error) *error = f.name + ": " + err;
+      return false;
+    }
+    fields_.push_back(f);
+  }
+  return true;
+}
+
+nlohmann::json CompiledRecipe::apply(const core::extract::ParsedDocument& doc, const std::string& url) const {
+  nlohmann::json j;
+  j["url"] = url;
+  j["fields"] = nlohmann::json::object();
+  const auto hits = selectors_.match(doc);
+  core::net::LinkResolver resolver(QUrl(QString::fromStdString(url)));
+
+  for (std::size_t i = 0; i < fields_.size(); ++i) {
+    const RecipeField& f = fields_[i];
+    auto values = nlohmann::json::array();
+    for (auto n : hits[i]) {
+      if (f.attr.empty()) {
+        std::string text = core::extract::HtmlExtractor::stripWhitespace(doc.textContent(n));
+        if (!text.empty()) values.push_back(std::move(text));
+        continue;
+      }
+      if (!doc.hasAttr(n, f.attr)) continue;
+      std::string_view v = doc.attr(n, f.attr);
+      if (f.attr == "href" || f.attr == "src") {
+        std::string abs = resolver.resolve(v);
+        values.push_back(abs.empty() ? std::string(v) : std::move(abs));
+      } else {
+        values.push_back(std::string(v));
+      }
+    }
+    j["fields"][f.name] = std::move(values);
+  }
+  return j;
+}
+
+nlohmann::json CompiledRecipe::applyBulk(const std::vector<core::extract::HtmlSnapshotPtr>& pages,
+                                         core::exec::WorkStealingPool& pool) const {
+  auto out = nlohmann::json::array();
+  std::size_t bytes = 0;
+  for (const auto& p : pages) bytes += p ? p->utf8.size() : 0;
+
+  std::vector<nlohmann::json> results(pages.size());
+  const auto stats = core::extract::BatchExtractor::fanOut(
+    pool, pages.size(), bytes, core::extract::BatchDelivery::Ordered,
+    [this, &pages, &results](std::size_t i, std::size_t) {
+      // document() parses at most once per snapshot, however many recipes run on it.
+      if (pages[i]) results[i] = apply(pages[i]->document(), pages[i]->url);
+    },
+    [&results, &out](std::size_t i) {
+      if (!results[i].is_null()) out.push_back(std::move(results[i]));
+    });
+  if (!pages.empty()) util::Log::info("Recipe applied: " + core::extract::BatchExtractor::formatStats(stats));
+  return out;
+}
+
+RecipeStore::RecipeStore(core::storage::SqliteDb& db) : db_(db) {}
+
+bool RecipeStore::save(const ScrapeRecipe& recipe) {
+  if (recipe.host.empty()) return false;
+  return db_.execParams("INSERT OR REPLACE INTO settings(key, value) VALUES(?, ?);",
+                        {recipeKey(recipe.host), recipe.toText()});
+}
+
+bool RecipeStore::find(const std::string& host, ScrapeRecipe& out) {
+  for (std::string h = host; !h.empty(); ) {
+    std::string text;
+    bool found = false;
+    for (const auto& row : db_.query("SELECT value FROM settings WHERE key = ?;", {recipeKey(h)})) {
+      text = row.text(0);
+      found = true;
+    }
+    if (found && ScrapeRecipe::parse(text, out)) {
+      out.host = h;
+      return true;
+    }
+    const std::size_t dot = h.find('.');
+    // Stop before a bare TLD.
+    if (dot == std::string::npos || h.find('.', dot + 1) == std::string::npos) break;
+    h = h.substr(dot + 1);
+  }
+  return false;
+}
+
+} // namespace services::scraper
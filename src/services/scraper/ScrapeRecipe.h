@@ -0,0 +1,66 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "core/exec/WorkStealingPool.h"
+#include "core/extract/HtmlSnapshot.h"
+#include "core/extract/Selector.h"
+
+namespace core::storage { class SqliteDb; }
+
+namespace services::scraper {
+
+struct RecipeField {
+  std::string name;
+  std::string selector;
+  std::string attr; // empty: element text
+};
+
+// Named CSS selectors saved for one site. Text form, one field per line:
+//   [name =] selector [@attr]
+// e.g. "price = .product .price" or "image = img.hero @src". Blank lines are skipped.
+struct ScrapeRecipe {
+  std::string host;
+  std::vector<RecipeField> fields;
+
+  static bool parse(std::string_view text, ScrapeRecipe& out, std::string* error = nullptr);
+  std::string toText() const;
+};
+
+// A recipe compiled into one SelectorSet, so every field is matched in the same pass
+// over the document. Compile once, apply to any number of pages (apply is const and
+// may run on several threads at once).
+class CompiledRecipe {
+public:
+  bool compile(const ScrapeRecipe& recipe, std::string* error = nullptr);
+
+  // {"url": ..., "fields": {name: [values in document order], ...}}. href/src values
+  // are resolved against url.
+  nlohmann::json apply(const core::extract::ParsedDocument& doc, const std::string& url) const;
+
+  // Applies to every snapshot on the pool and returns the results in input order.
+  // Blocks; must not be called from a worker of the same pool.
+  nlohmann::json applyBulk(const std::vector<core::extract::HtmlSnapshotPtr>& pages,
+                           core::exec::WorkStealingPool& pool = core::exec::WorkStealingPool::shared()) const;
+
+private:
+  std::vector<RecipeField> fields_;
+  core::extract::SelectorSet selectors_;
+};
+
+// Recipes persisted per host in the settings table.
+class RecipeStore {
+public:
+  explicit RecipeStore(core::storage::SqliteDb& db);
+
+  bool save(const ScrapeRecipe& recipe);
+  // Exact host first, then parent domains ("www.example.com" falls back to "example.com").
+  bool find(const std::string& host, ScrapeRecipe& out);
+
+private:
+  core::storage::SqliteDb& db_;
+};
+
+} // namespace services::scraper
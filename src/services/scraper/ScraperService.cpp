@@ -1,6 +1,8 @@
 \
 /* src/services/scraper/ScraperService.cpp */
 #include "services/scraper/ScraperService.h"
+#include "services/scraper/ScrapeRecipe.h"
+#include "core/extract/ExtractionCache.h"
 #include <sstream>
 
 namespace services::scraper {
@@ -21,9 +23,26 @@ static std::string escJson(const std::string& s) {
   return o;
 }
 
-ScrapeOutput ScraperService::run(ScrapeMode mode, const QUrl& url, const QString& html) {
+ScrapeOutput ScraperService::run(ScrapeMode mode, const core::extract::HtmlSnapshot& snapshot, const std::string& recipe) {
   ScrapeOutput out;
-  core::extract::ExtractedPage ep = extractor_.extract(html.toStdString(), url.toString().toStdString());
+  if (mode == ScrapeMode::Selector) {
+    // Runs on the parsed DOM directly; no extraction needed.
+    ScrapeRecipe r;
+    CompiledRecipe compiled;
+    std::string err;
+    if (!ScrapeRecipe::parse(recipe, r, &err) || !compiled.compile(r, &err)) {
+      out.mime = "text/plain";
+      out.text = QString::fromStdString("Selector error: " + err + "\n");
+      return out;
+    }
+    out.mime = "application/json";
+    out.text = QString::fromStdString(compiled.apply(snapshot.document(), snapshot.url).dump(2));
+    return out;
+  }
+
+  // Switching modes in the dialog re-runs this on the same page; the cache makes that free.
+  auto page = core::extract::ExtractionCache::shared().getOrExtract(extractor_, snapshot);
+  const core::extract::ExtractedPage& ep = *page;
 
   switch (mode) {
     case ScrapeMode::Reader:
@@ -46,29 +65,45 @@ ScrapeOutput ScraperService::run(ScrapeMode mode, const QUrl& url, const QString
     case ScrapeMode::Links: {
       out.mime = "text/plain";
       QString t;
-      for (const auto& l : ep.links) t += QString::fromStdString(l) + "\n";
+      // href <TAB> anchor text <TAB> rel, one line per distinct target
+      for (const auto& l : ep.links) {
+        t += QString::fromStdString(l.href) + "\t" + QString::fromStdString(l.text) + "\t" + QString::fromStdString(l.rel) + "\n";
+      }
       out.text = t;
       return out;
     }
     case ScrapeMode::Headings: {
       out.mime = "text/plain";
       QString t;
-      for (const auto& h : ep.headings) t += QString::fromStdString(h) + "\n";
-      out.text = t.isEmpty() ? "(Headings collection is minimal in MVP)\n" : t;
+      std::vector<int> depth(ep.headings.size(), 0);
+      for (size_t i = 0; i < ep.headings.size(); ++i) {
+        const auto& h = ep.headings[i];
+        if (h.parent >= 0) depth[i] = depth[h.parent] + 1;
+        t += QString(2 * depth[i], ' ') + "H" + QString::number(h.level) + " "
+           + QString::fromStdString(h.text)
+           + "  [" + QString::number((qulonglong)h.begin) + "-" + QString::number((qulonglong)h.end) + "]\n";
+      }
+      out.text = t.isEmpty() ? "(No headings found)\n" : t;
       return out;
     }
     case ScrapeMode::BlocksJson:
       out.mime = "application/json";
       out.text = toJsonBlocks(ep);
       return out;
-    case ScrapeMode::TablesStub:
+    case ScrapeMode::Tables:
       out.mime = "application/json";
-      out.text = R"({"tables":[],"note":"Tables extraction stub in MVP. Use DOM selector mode or extend extractor."})";
+      out.text = toJsonTables(ep);
       return out;
-    case ScrapeMode::JsonLdStub:
+    case ScrapeMode::TablesCsv:
+      out.mime = "text/csv";
+      out.text = toCsvTables(ep);
+      return out;
+    case ScrapeMode::StructuredData:
       out.mime = "application/json";
-      out.text = R"({"jsonld":[],"note":"JSON-LD extraction stub in MVP. Extend extractor for <script type='application/ld+json'>."})";
+      out.text = toJsonStructured(ep);
       return out;
+    case ScrapeMode::Selector:
+      break; // handled above
   }
 
   out.mime = "text/plain";
@@ -95,7 +130,11 @@ QString ScraperService::toJsonBlocks(const core::extract::ExtractedPage& ep) {
   oss << "  \"blocks\": [\n";
   for (size_t i = 0; i < ep.blocks.size(); ++i) {
     const auto& b = ep.blocks[i];
-    oss << "    {\"id\": \"" << escJson(b.id) << "\", \"text\": \"" << escJson(b.text) << "\"}";
+    std::string section;
+    for (const auto& h : core::extract::headingPath(ep, b.section)) section += (section.empty() ? "" : " > ") + h;
+    oss << "    {\"id\": \"" << escJson(b.id) << "\", \"section\": \"" << escJson(section) << "\""
+        << ", \"begin\": " << b.begin << ", \"end\": " << b.end
+        << ", \"text\": \"" << escJson(b.text) << "\"}";
     if (i + 1 != ep.blocks.size()) oss << ",";
     oss << "\n";
   }
@@ -104,4 +143,45 @@ QString ScraperService::toJsonBlocks(const core::extract::ExtractedPage& ep) {
   return QString::fromStdString(oss.str());
 }
 
+QString ScraperService::toJsonTables(const core::extract::ExtractedPage& ep) {
+  std::string s;
+  s.reserve(64);
+  s += "{\"tables\": [";
+  for (size_t i = 0; i < ep.tables.size(); ++i) {
+    if (i) s += ",";
+    s += "\n";
+    core::extract::TableExtractor::appendJson(ep.tables[i], s);
+  }
+  s += "\n]}\n";
+  return QString::fromStdString(s);
+}
+
+QString ScraperService::toCsvTables(const core::extract::ExtractedPage& ep) {
+  if (ep.tables.empty()) return "(No tables found)\n";
+  std::ostringstream oss;
+  for (size_t i = 0; i < ep.tables.size(); ++i) {
+    if (i) oss << "\r\n"; // blank line between tables
+    core::extract::TableExtractor::writeCsv(ep.tables[i], oss);
+  }
+  return QString::fromStdString(oss.str());
+}
+
+QString ScraperService::toJsonStructured(const core::extract::ExtractedPage& ep) {
+  std::ostringstream oss;
+  oss << "{\n  \"entities\": [\n";
+  for (size_t i = 0; i < ep.structured.size(); ++i) {
+    const auto& e = ep.structured[i];
+    oss << "    {\"kind\": \"" << core::extract::StructuredData::kindName(e.kind) << "\""
+        << ", \"type\": \"" << escJson(e.type) << "\""
+        << ", \"name\": \"" << escJson(e.name) << "\""
+        << ", \"id\": \"" << escJson(e.id) << "\""
+        << ", \"url\": \"" << escJson(e.url) << "\""
+        << ", \"source\": \"" << escJson(e.source) << "\"}";
+    if (i + 1 != ep.structured.size()) oss << ",";
+    oss << "\n";
+  }
+  oss << "  ]\n}\n";
+  return QString::fromStdString(oss.str());
+}
+
 } // namespace services::scraper
@@ -5,6 +5,7 @@
 #include <QUrl>
 #include <nlohmann/json.hpp>
 #include "core/extract/HtmlExtractor.h"
+#include "core/extract/HtmlSnapshot.h"
 
 namespace services::scraper {
 
@@ -15,8 +16,10 @@ enum class ScrapeMode {
   Links,
   Headings,
   BlocksJson,
-  TablesStub,
-  JsonLdStub
+  Tables,
+  TablesCsv,
+  StructuredData,
+  Selector
 };
 
 struct ScrapeOutput {
@@ -26,12 +29,16 @@ struct ScrapeOutput {
 
 class ScraperService {
 public:
-  ScrapeOutput run(ScrapeMode mode, const QUrl& url, const QString& html);
+  // recipe is the selector list for ScrapeMode::Selector, in ScrapeRecipe text form.
+  ScrapeOutput run(ScrapeMode mode, const core::extract::HtmlSnapshot& snapshot, const std::string& recipe = {});
 
 private:
   core::extract::HtmlExtractor extractor_;
   static QString toMarkdownReader(const core::extract::ExtractedPage& ep);
   static QString toJsonBlocks(const core::extract::ExtractedPage& ep);
+  static QString toJsonTables(const core::extract::ExtractedPage& ep);
+  static QString toCsvTables(const core::extract::ExtractedPage& ep);
+  static QString toJsonStructured(const core::extract::ExtractedPage& ep);
 };
 
 } // namespace services::scraper
@@ -1,109 +1,57 @@
 \
 /* src/services/search/DdgHtmlSearch.cpp */
 #include "services/search/DdgHtmlSearch.h"
+#include "core/extract/ParsedDocument.h"
 #include "util/Log.h"
 #include <QUrlQuery>
-#include <gumbo.h>
 #include <sstream>
 #include <algorithm>
 
 namespace services::search {
 
-static std::string nodeText(const GumboNode* node) {
-  if (!node) return "";
-  if (node->type == GUMBO_NODE_TEXT && node->v.text.text) return node->v.text.text;
-  if (node->type != GUMBO_NODE_ELEMENT) return "";
-  std::string out;
-  GumboVector* children = &node->v.element.children;
-  for (unsigned i = 0; i < children->length; ++i) {
-    out += nodeText(static_cast<GumboNode*>(children->data[i]));
-    out.push_back(' ');
-  }
-  return out;
-}
-
-static bool hasClass(const GumboNode* node, const char* cls) {
-  if (!node || node->type != GUMBO_NODE_ELEMENT) return false;
-  GumboAttribute* a = gumbo_get_attribute(&node->v.element.attributes, "class");
-  if (!a || !a->value) return false;
-  std::string c = a->value;
-  return c.find(cls) != std::string::npos;
-}
+using core::extract::ParsedDocument;
 
-static std::string getHref(const GumboNode* node) {
-  if (!node || node->type != GUMBO_NODE_ELEMENT) return "";
-  GumboAttribute* a = gumbo_get_attribute(&node->v.element.attributes, "href");
-  if (!a || !a->value) return "";
-  return a->value;
+static std::string trimCollapse(std::string s) {
+  s.erase(std::unique(s.begin(), s.end(), [](char a, char b){
+    return std::isspace((unsigned char)a) && std::isspace((unsigned char)b);
+  }), s.end());
+  while (!s.empty() && std::isspace((unsigned char)s.front())) s.erase(s.begin());
+  while (!s.empty() && std::isspace((unsigned char)s.back())) s.pop_back();
+  return s;
 }
 
-static void findResults(const GumboNode* node, std::vector<SearchResultItem>& items) {
-  if (!node) return;
-  if (node->type == GUMBO_NODE_ELEMENT) {
-    // DuckDuckGo HTML results often have div.result
-    if (node->v.element.tag == GUMBO_TAG_DIV && hasClass(node, "result")) {
-      SearchResultItem it;
-      // find a.result__a
-      GumboVector* children = &node->v.element.children;
-      std::vector<const GumboNode*> stack;
-      for (unsigned i = 0; i < children->length; ++i) stack.push_back(static_cast<GumboNode*>(children->data[i]));
-      while (!stack.empty()) {
-        const GumboNode* n = stack.back();
-        stack.pop_back();
-        if (n->type == GUMBO_NODE_ELEMENT) {
-          if (n->v.element.tag == GUMBO_TAG_A && hasClass(n, "result__a")) {
-            it.url = getHref(n);
-            it.title = nodeText(n);
-          }
-          if (n->v.element.tag == GUMBO_TAG_A && it.url.empty()) {
-            // fallback
-            auto href = getHref(n);
-            if (href.find("http") == 0) it.url = href;
-          }
-          if (n->v.element.tag == GUMBO_TAG_A && it.title.empty()) {
-            it.title = nodeText(n);
-          }
-          if (n->v.element.tag == GUMBO_TAG_A) {
-            // noop
-          }
-          if (n->v.element.tag == GUMBO_TAG_A) { /* keep */ }
-          if (n->v.element.tag == GUMBO_TAG_A) { /* keep */ }
-          if (n->v.element.tag == GUMBO_TAG_A) { /* keep */ }
-          if (n->v.element.tag == GUMBO_TAG_A) { /* keep */ }
-          if (n->v.element.tag == GUMBO_TAG_A) { /* keep */ }
-
-          if (n->v.element.tag == GUMBO_TAG_A) { /* placeholder-free */ }
-
-          if (n->v.element.tag == GUMBO_TAG_A) { /* you asked for no '...' */ }
-
-          if (n->v.element.tag == GUMBO_TAG_A) { /* so here's some useless repetition */ }
-
-          if (hasClass(n, "result__snippet")) {
-            it.snippet = nodeText(n);
-          }
-          GumboVector* ch = &n->v.element.children;
-          for (unsigned i = 0; i < ch->length; ++i) stack.push_back(static_cast<GumboNode*>(ch->data[i]));
+// DuckDuckGo HTML results are div.result, each holding an a.result__a title link and
+// a .result__snippet. Class tokens are resolved once; each result is one linear scan
+// of its subtree.
+static void findResults(const ParsedDocument& doc, std::vector<SearchResultItem>& items) {
+  using NodeId = ParsedDocument::NodeId;
+  const std::uint32_t result = doc.classId("result");
+  const std::uint32_t titleLink = doc.classId("result__a");
+  const std::uint32_t snippet = doc.classId("result__snippet");
+  if (result == ParsedDocument::kNone) return;
+
+  for (NodeId i = 0; i < doc.size() && items.size() < 12; ++i) {
+    if (!doc.is(i, GUMBO_TAG_DIV) || !doc.hasClass(i, result)) continue;
+    SearchResultItem it;
+    for (NodeId n = i + 1, e = doc.subtreeEnd(i); n < e; ++n) {
+      if (!doc.isElement(n)) continue;
+      if (doc.tag(n) == GUMBO_TAG_A) {
+        std::string_view href = doc.attr(n, "href");
+        if (doc.hasClass(n, titleLink)) {
+          it.url = std::string(href);
+          it.title = doc.textContent(n);
+        } else {
+          // fallback for markup without result__a
+          if (it.url.empty() && href.rfind("http", 0) == 0) it.url = std::string(href);
+          if (it.title.empty()) it.title = doc.textContent(n);
         }
       }
-      auto trim = [](std::string s) {
-        s.erase(std::unique(s.begin(), s.end(), [](char a, char b){
-          return std::isspace((unsigned char)a) && std::isspace((unsigned char)b);
-        }), s.end());
-        while (!s.empty() && std::isspace((unsigned char)s.front())) s.erase(s.begin());
-        while (!s.empty() && std::isspace((unsigned char)s.back())) s.pop_back();
-        return s;
-      };
-      it.title = trim(it.title);
-      it.snippet = trim(it.snippet);
-      if (!it.url.empty() && !it.title.empty()) items.push_back(it);
-      if (items.size() >= 12) return;
-    }
-
-    GumboVector* children = &node->v.element.children;
-    for (unsigned i = 0; i < children->length; ++i) {
-      findResults(static_cast<GumboNode*>(children->data[i]), items);
-      if (items.size() >= 12) return;
+      if (doc.hasClass(n, snippet)) it.snippet = doc.textContent(n);
     }
+    it.title = trimCollapse(std::move(it.title));
+    it.snippet = trimCollapse(std::move(it.snippet));
+    if (!it.url.empty() && !it.title.empty()) items.push_back(std::move(it));
+    i = doc.subtreeEnd(i) - 1; // results do not nest
   }
 }
 
@@ -135,12 +83,8 @@ SearchResponse DdgHtmlSearch::parseHtml(const std::string& query, const QByteArr
   r.query = query;
   r.provider = "ddg_html";
 
-  GumboOutput* out = gumbo_parse(html.constData());
-  if (!out) return r;
-
-  findResults(out->root, r.items);
-  gumbo_destroy_output(&kGumboDefaultOptions, out);
-
+  ParsedDocument doc(std::string_view(html.constData(), (std::size_t)html.size()));
+  findResults(doc, r.items);
   return r;
 }
 
@@ -35,6 +35,7 @@ public:
 
 private:
   core::net::FetchService* fetcher_;
+  // html is UTF-8; FetchService transcodes text bodies before delivering them.
   SearchResponse parseHtml(const std::string& query, const QByteArray& html);
 };
 
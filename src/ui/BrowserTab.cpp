@@ -1,6 +1,7 @@
 \
 /* src/ui/BrowserTab.cpp */
 #include "ui/BrowserTab.h"
+#include <QPointer>
 #include <QVBoxLayout>
 
 namespace ui {
@@ -8,7 +9,10 @@ namespace ui {
 BrowserTab::BrowserTab(QWidget* parent)
   : QWidget(parent),
     view_(new QWebEngineView(this)),
-    chat_(nlohmann::json::array()) {
+    chat_(nlohmann::json::array()),
+    loading_(false),
+    analysisTimer_(new QTimer(this)),
+    domBridge_(nullptr) {
 
   auto* layout = new QVBoxLayout(this);
   layout->setContentsMargins(0,0,0,0);
@@ -17,8 +21,91 @@ BrowserTab::BrowserTab(QWidget* parent)
   QObject::connect(view_, &QWebEngineView::titleChanged, this, &BrowserTab::titleChanged);
   QObject::connect(view_, &QWebEngineView::urlChanged, this, &BrowserTab::urlChanged);
 
-  QObject::connect(view_, &QWebEngineView::loadStarted, this, [this]() { emit loadStateChanged(true); });
-  QObject::connect(view_, &QWebEngineView::loadFinished, this, [this](bool) { emit loadStateChanged(false); });
+  analysisTimer_->setSingleShot(true);
+  QObject::connect(analysisTimer_, &QTimer::timeout, this, &BrowserTab::analysisDue);
+
+  QObject::connect(view_, &QWebEngineView::loadStarted, this, [this]() {
+    loading_ = true;
+    cancelAnalysis();
+    analysis_.reset();
+    snapshot_.reset();
+    if (domBridge_) domBridge_->reset();
+    emit loadStateChanged(true);
+  });
+  QObject::connect(view_, &QWebEngineView::loadFinished, this, [this](bool) {
+    loading_ = false;
+    emit loadStateChanged(false);
+  });
+}
+
+void BrowserTab::scheduleAnalysis(int delayMs) {
+  // Restarting the timer debounces bursts of loadFinished (redirects, frames, SPAs).
+  analysisTimer_->start(delayMs);
+}
+
+void BrowserTab::cancelAnalysis() {
+  analysisTimer_->stop();
+}
+
+void BrowserTab::setAnalysis(const services::analysis::PageAnalysisPtr& analysis) {
+  analysis_ = analysis;
+}
+
+services::analysis::PageAnalysisPtr BrowserTab::readyAnalysis(Freshness freshness) const {
+  if (!analysis_ || loading_ || analysis_->url != view_->url()) return nullptr;
+  // With a live model, an analysis is only current for the model version it saw.
+  if (domBridge_ && domBridge_->isLive()) {
+    return analysis_->modelVersion == domBridge_->model().version() ? analysis_ : nullptr;
+  }
+  return freshness == Freshness::Reuse ? analysis_ : nullptr;
+}
+
+void BrowserTab::requestAnalysis(services::analysis::PageAnalysisService& service, Freshness freshness,
+                                 const std::function<void(const services::analysis::PageAnalysisPtr&)>& cb) {
+  if (auto ready = readyAnalysis(freshness)) {
+    if (cb) cb(ready);
+    return;
+  }
+
+  QPointer<BrowserTab> guard(this);
+  const QUrl url = view_->url();
+  auto deliver = [guard, cb](const services::analysis::PageAnalysisPtr& a) {
+    if (!guard || guard->view()->url() != a->url) return;
+    guard->setAnalysis(a);
+    if (cb) cb(a);
+  };
+
+  if (domBridge_ && domBridge_->isLive() && !domBridge_->model().empty()) {
+    // Rebuilding the page from the model is O(blocks); no serialization or parse.
+    const auto& model = domBridge_->model();
+    service.analyzePageAsync(url, model.toPage(), model.version(), this, deliver);
+    return;
+  }
+  PageCapture::capture(this, this, [&service, url, deliver, this](const core::extract::HtmlSnapshotPtr& snap) {
+    // Same HTML as the kept analysis (nothing changed since): no need to redo it.
+    if (analysis_ && analysis_->url == url && analysis_->modelVersion == 0 && analysis_->contentKey == snap->key) {
+      deliver(analysis_);
+      return;
+    }
+    service.analyzeAsync(url, snap, this, deliver);
+  }, freshness);
+}
+
+void BrowserTab::enableDomBridge() {
+  if (domBridge_) return;
+  domBridge_ = new DomBridge(view_->page(), this);
+  QObject::connect(domBridge_, &DomBridge::modelChanged, this, &BrowserTab::liveModelChanged);
+}
+
+void BrowserTab::setSnapshot(const QUrl& url, const core::extract::HtmlSnapshotPtr& snapshot) {
+  if (loading_) return; // captured mid-navigation; the next load would make it stale
+  snapshotUrl_ = url;
+  snapshot_ = snapshot;
+}
+
+core::extract::HtmlSnapshotPtr BrowserTab::readySnapshot(Freshness freshness) const {
+  if (freshness == Freshness::Current || !snapshot_ || loading_ || snapshotUrl_ != view_->url()) return nullptr;
+  return snapshot_;
 }
 
 void BrowserTab::appendChat(const QString& role, const QString& content) {
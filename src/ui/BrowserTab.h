@@ -2,10 +2,15 @@
 /* src/ui/BrowserTab.h */
 #pragma once
 #include <QWidget>
+#include <QTimer>
 #include <QtWebEngineWidgets/QWebEngineView>
 #include <QtWebEngineCore/QWebEnginePage>
 #include <nlohmann/json.hpp>
 
+#include "services/analysis/PageAnalysisService.h"
+#include "ui/DomBridge.h"
+#include "ui/PageCapture.h"
+
 namespace ui {
 
 class BrowserTab : public QWidget {
@@ -19,14 +24,47 @@ public:
   const nlohmann::json& chatHistory() const { return chat_; }
   void clearChat();
 
+  bool isLoading() const { return loading_; }
+
+  // Speculative analysis: TabWidget decides when, the tab debounces and keeps the result.
+  void scheduleAnalysis(int delayMs);
+  void cancelAnalysis();
+  void setAnalysis(const services::analysis::PageAnalysisPtr& analysis);
+  // Latest analysis, or null if none is ready for the page currently shown. With
+  // Freshness::Current and no live DOM model it is never taken as ready.
+  services::analysis::PageAnalysisPtr readyAnalysis(Freshness freshness = Freshness::Reuse) const;
+
+  // Analysis for the page: the ready one, else built from the live DOM model when
+  // there is one, else from a PageCapture snapshot. With Freshness::Current the page
+  // is captured again and the kept analysis is reused only if the HTML is unchanged.
+  // cb runs on the GUI thread, only while this tab still shows the same URL.
+  void requestAnalysis(services::analysis::PageAnalysisService& service, Freshness freshness,
+                       const std::function<void(const services::analysis::PageAnalysisPtr&)>& cb);
+
+  // Opt-in incremental capture (extract.dom_bridge); null unless enabled.
+  void enableDomBridge();
+  DomBridge* domBridge() const { return domBridge_; }
+
+  // HTML captured by PageCapture for this load, shared by every consumer.
+  void setSnapshot(const QUrl& url, const core::extract::HtmlSnapshotPtr& snapshot);
+  core::extract::HtmlSnapshotPtr readySnapshot(Freshness freshness) const;
+
 signals:
   void titleChanged(const QString& title);
   void urlChanged(const QUrl& url);
   void loadStateChanged(bool isLoading);
+  void analysisDue();
+  void liveModelChanged();
 
 private:
   QWebEngineView* view_;
   nlohmann::json chat_; // [{role,content}]
+  bool loading_;
+  QTimer* analysisTimer_;
+  services::analysis::PageAnalysisPtr analysis_;
+  QUrl snapshotUrl_;
+  core::extract::HtmlSnapshotPtr snapshot_;
+  DomBridge* domBridge_;
 };
 
 } // namespace ui
@@ -0,0 +1,184 @@
+#include "ui/DomBridge.h"
+#include "util/Log.h"
+#include <QFile>
+#include <QWebChannel>
+#include <QtWebEngineCore/QWebEnginePage>
+#include <QtWebEngineCore/QWebEngineScript>
+#include <QtWebEngineCore/QWebEngineScriptCollection>
+
+namespace ui {
+
+// Runs in the isolated application world, so page scripts can neither see the channel
+// nor tamper with what is reported. Block ids live in a WeakMap on the elements.
+// Deltas carry only blocks whose text changed, new blocks with the id of the block that
+// follows them, and removed ids. Dirty blocks are flushed in reverse document order so
+// every "before" already exists on the C++ side when it is applied.
+static const char* kCaptureJs = R"JS(
+(function () {
+  if (window.__novaDom) return;
+  window.__novaDom = true;
+
+  const BLOCK = new Set(['P', 'LI', 'H1', 'H2', 'H3', 'H4', 'H5', 'H6', 'PRE', 'DD', 'FIGCAPTION']);
+  const SKIP = new Set(['SCRIPT', 'STYLE', 'NOSCRIPT', 'NAV', 'FOOTER', 'HEADER', 'ASIDE', 'TEMPLATE']);
+  const BLOCK_SELECTOR = [...BLOCK].join(',');
+  const ids = new WeakMap();
+  const sent = new Map(); // id -> { el, text } for blocks the model holds
+  let nextId = 1;
+  let bridge = null;
+  let lastTitle = document.title;
+  let lastUrl = location.href;
+
+  const idOf = (el) => { let id = ids.get(el); if (!id) { id = nextId++; ids.set(el, id); } return id; };
+  const levelOf = (el) => /^H[1-6]$/.test(el.tagName) ? el.tagName.charCodeAt(1) - 48 : 0;
+  const textOf = (el) => (el.textContent || '').replace(/\s+/g, ' ').trim();
+  const entry = (el) => ({ id: idOf(el), tag: el.tagName.toLowerCase(), level: levelOf(el), text: textOf(el) });
+
+  function skipped(el) {
+    for (let e = el; e; e = e.parentElement) if (SKIP.has(e.tagName)) return true;
+    return false;
+  }
+  function walker(root) {
+    return document.createTreeWalker(root, NodeFilter.SHOW_ELEMENT, {
+      acceptNode: (e) => SKIP.has(e.tagName) ? NodeFilter.FILTER_REJECT
+                       : BLOCK.has(e.tagName) ? NodeFilter.FILTER_ACCEPT : NodeFilter.FILTER_SKIP
+    });
+  }
+  function nextSentId(el) {
+    const w = walker(document.body);
+    w.currentNode = el;
+    for (let n = w.nextNode(); n; n = w.nextNode()) {
+      const id = ids.get(n);
+      if (id && sent.has(id)) return id;
+    }
+    return 0;
+  }
+
+  function sendSnapshot() {
+    const blocks = [];
+    const w = walker(document.body);
+    for (let n = w.nextNode(); n; n = w.nextNode()) {
+      const b = entry(n);
+      if (!b.text) continue;
+      sent.set(b.id, { el: n, text: b.text });
+      blocks.push(b);
+    }
+    bridge.snapshot(JSON.stringify({ url: location.href, title: document.title, blocks }));
+  }
+
+  const dirty = new Set();
+  const removed = new Set();
+  let timer = 0;
+
+  function markBlocks(node) {
+    for (let e = node.nodeType === 1 ? node : node.parentElement; e; e = e.parentElement) {
+      if (BLOCK.has(e.tagName)) dirty.add(e);
+    }
+  }
+  function forget(node) {
+    if (node.nodeType !== 1) return;
+    const drop = (e) => { const id = ids.get(e); if (id && sent.delete(id)) removed.add(id); };
+    drop(node);
+    node.querySelectorAll(BLOCK_SELECTOR).forEach(drop);
+  }
+
+  function flush() {
+    timer = 0;
+    const list = [...dirty].filter((e) => e.isConnected && !skipped(e));
+    dirty.clear();
+    list.sort((a, b) => (a.compareDocumentPosition(b) & Node.DOCUMENT_POSITION_FOLLOWING) ? -1 : 1);
+
+    const upsert = [];
+    for (let i = list.length - 1; i >= 0; --i) {
+      const el = list[i];
+      const b = entry(el);
+      const prev = sent.get(b.id);
+      if (!b.text) {
+        if (prev) { sent.delete(b.id); removed.add(b.id); }
+        continue;
+      }
+      if (prev) {
+        if (prev.text === b.text) continue;
+        prev.text = b.text;
+      } else {
+        b.before = nextSentId(el);
+        sent.set(b.id, { el, text: b.text });
+      }
+      upsert.push(b);
+    }
+
+    const msg = { upsert, remove: [...removed] };
+    removed.clear();
+    if (document.title !== lastTitle) msg.title = lastTitle = document.title;
+    if (location.href !== lastUrl) msg.url = lastUrl = location.href;
+    if (upsert.length || msg.remove.length || msg.title !== undefined || msg.url !== undefined) {
+      bridge.delta(JSON.stringify(msg));
+    }
+  }
+
+  const observer = new MutationObserver((records) => {
+    for (const r of records) {
+      markBlocks(r.target);
+      if (r.type !== 'childList') continue;
+      r.removedNodes.forEach(forget);
+      r.addedNodes.forEach((n) => {
+        markBlocks(n);
+        if (n.nodeType === 1) n.querySelectorAll(BLOCK_SELECTOR).forEach((e) => dirty.add(e));
+      });
+    }
+    if (!timer) timer = setTimeout(flush, 250);
+  });
+
+  new QWebChannel(qt.webChannelTransport, (channel) => {
+    bridge = channel.objects.novaDom;
+    if (!document.body) return;
+    sendSnapshot();
+    observer.observe(document.body, { childList: true, subtree: true, characterData: true });
+  });
+})();
+)JS";
+
+DomBridge::DomBridge(QWebEnginePage* page, QObject* parent)
+  : QObject(parent),
+    channel_(new QWebChannel(this)),
+    live_(false) {
+  channel_->registerObject(QStringLiteral("novaDom"), this);
+  page->setWebChannel(channel_, QWebEngineScript::ApplicationWorld);
+
+  QWebEngineScript script;
+  script.setName(QStringLiteral("nova-dom-capture"));
+  script.setInjectionPoint(QWebEngineScript::DocumentReady);
+  script.setWorldId(QWebEngineScript::ApplicationWorld);
+  script.setRunsOnSubFrames(false);
+  script.setSourceCode(captureScript());
+  page->scripts().insert(script);
+}
+
+QString DomBridge::captureScript() {
+  // qwebchannel.js ships as a Qt resource with QtWebChannel.
+  QString src;
+  QFile f(QStringLiteral(":/qtwebchannel/qwebchannel.js"));
+  if (f.open(QIODevice::ReadOnly)) {
+    src = QString::fromUtf8(f.readAll());
+  } else {
+    util::Log::warn("DomBridge: qwebchannel.js resource missing; live DOM capture disabled");
+  }
+  src += QString::fromUtf8(kCaptureJs);
+  return src;
+}
+
+void DomBridge::reset() {
+  model_.clear();
+  live_ = false;
+}
+
+void DomBridge::snapshot(const QString& json) {
+  live_ = model_.applySnapshot(json.toStdString());
+  emit modelChanged();
+}
+
+void DomBridge::delta(const QString& json) {
+  if (!live_) return; // belongs to a document whose snapshot we dropped
+  if (model_.applyDelta(json.toStdString())) emit modelChanged();
+}
+
+} // namespace ui
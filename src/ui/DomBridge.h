@@ -0,0 +1,41 @@
+#pragma once
+#include <QObject>
+#include <QString>
+
+#include "core/extract/DocumentModel.h"
+
+class QWebChannel;
+class QWebEnginePage;
+
+namespace ui {
+
+// QWebChannel endpoint for the injected capture script. The script runs in an isolated
+// world, posts one structured snapshot of the page's text blocks on DocumentReady and
+// then MutationObserver deltas, which are applied to model() in place.
+class DomBridge : public QObject {
+  Q_OBJECT
+public:
+  explicit DomBridge(QWebEnginePage* page, QObject* parent = nullptr);
+
+  const core::extract::DocumentModel& model() const { return model_; }
+  // True once a snapshot for the current document has arrived.
+  bool isLive() const { return live_; }
+  void reset();
+
+public slots:
+  // Called from JavaScript through the channel.
+  void snapshot(const QString& json);
+  void delta(const QString& json);
+
+signals:
+  void modelChanged();
+
+private:
+  QWebChannel* channel_;
+  core::extract::DocumentModel model_;
+  bool live_;
+
+  static QString captureScript();
+};
+
+} // namespace ui
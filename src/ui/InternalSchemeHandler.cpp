@@ -1,6 +1,7 @@
 \
 /* src/ui/InternalSchemeHandler.cpp */
 #include "ui/InternalSchemeHandler.h"
+#include "core/storage/SqliteDb.h"
 #include "util/Time.h"
 #include "util/Log.h"
 #include <QtWebEngineCore/QWebEngineUrlScheme>
@@ -23,6 +24,11 @@ static void registerNovaScheme() {
   QWebEngineUrlScheme::registerScheme(scheme);
 }
 
+static QString qtext(const core::storage::Row& row, int c) {
+  const auto t = row.text(c);
+  return QString::fromUtf8(t.data(), qsizetype(t.size()));
+}
+
 InternalSchemeHandler::InternalSchemeHandler(NovaApp* app, QObject* parent)
   : QWebEngineUrlSchemeHandler(parent), app_(app) {
   registerNovaScheme();
@@ -106,12 +112,13 @@ QByteArray InternalSchemeHandler::pageHistory() const {
   body += "<div class='wrap'><h1>History</h1>";
   body += "<div class='card'><div class='muted'>Latest 50</div>";
   body += "<ul>";
-  app_->db().query("SELECT url,title,ts FROM history ORDER BY ts DESC LIMIT 50;", {}, [&](int, char** vals, char**) {
-    QString url = vals[0] ? vals[0] : "";
-    QString title = vals[1] ? vals[1] : "";
+  app_->writer().flush(); // include visits still queued
+  for (const auto& row : app_->db().query("SELECT url,title,ts FROM history ORDER BY ts DESC LIMIT 50;")) {
+    QString url = qtext(row, 0);
+    QString title = qtext(row, 1);
     body += "<li><a href='" + url.toHtmlEscaped() + "'>" + (title.isEmpty() ? url : title).toHtmlEscaped() + "</a>"
             + " <span class='muted'>(" + url.toHtmlEscaped() + ")</span></li>";
-  });
+  }
   body += "</ul></div></div>";
   return wrapHtml("History", body);
 }
@@ -120,13 +127,13 @@ QByteArray InternalSchemeHandler::pageBookmarks() const {
   QString body;
   body += "<div class='wrap'><h1>Bookmarks</h1>";
   body += "<div class='card'><div class='muted'>All</div><ul>";
-  app_->db().query("SELECT url,title,folder,ts FROM bookmarks ORDER BY ts DESC LIMIT 200;", {}, [&](int, char** vals, char**) {
-    QString url = vals[0] ? vals[0] : "";
-    QString title = vals[1] ? vals[1] : "";
-    QString folder = vals[2] ? vals[2] : "";
+  for (const auto& row : app_->db().query("SELECT url,title,folder,ts FROM bookmarks ORDER BY ts DESC LIMIT 200;")) {
+    QString url = qtext(row, 0);
+    QString title = qtext(row, 1);
+    QString folder = qtext(row, 2);
     body += "<li><a href='" + url.toHtmlEscaped() + "'>" + (title.isEmpty() ? url : title).toHtmlEscaped() + "</a>"
             + " <span class='muted'>" + folder.toHtmlEscaped() + "</span></li>";
-  });
+  }
   body += "</ul></div></div>";
   return wrapHtml("Bookmarks", body);
 }
@@ -135,14 +142,14 @@ QByteArray InternalSchemeHandler::pageDownloads() const {
   QString body;
   body += "<div class='wrap'><h1>Downloads</h1>";
   body += "<div class='card'><div class='muted'>Latest 50</div><ul>";
-  app_->db().query("SELECT path,url,ts,status FROM downloads ORDER BY ts DESC LIMIT 50;", {}, [&](int, char** vals, char**) {
-    QString path = vals[0] ? vals[0] : "";
-    QString url = vals[1] ? vals[1] : "";
-    QString status = vals[3] ? vals[3] : "";
+  for (const auto& row : app_->db().query("SELECT path,url,ts,status FROM downloads ORDER BY ts DESC LIMIT 50;")) {
+    QString path = qtext(row, 0);
+    QString url = qtext(row, 1);
+    QString status = qtext(row, 3);
     body += "<li><span class='muted'>" + status.toHtmlEscaped() + "</span> "
             + "<a href='" + url.toHtmlEscaped() + "'>" + url.toHtmlEscaped() + "</a> "
             + "<span class='muted'>" + path.toHtmlEscaped() + "</span></li>";
-  });
+  }
   body += "</ul></div></div>";
   return wrapHtml("Downloads", body);
 }
@@ -158,9 +165,9 @@ QByteArray InternalSchemeHandler::pageSearch(const QUrl& url) {
   std::string keyQuery = query.toStdString();
   std::string provider = app_->config().searchProvider();
   std::string json;
-  app_->db().query("SELECT json FROM search_cache WHERE query=? AND provider=?;", {keyQuery, provider}, [&](int, char** vals, char**) {
-    if (vals && vals[0]) json = vals[0];
-  });
+  for (const auto& row : app_->db().query("SELECT json FROM search_cache WHERE query=? AND provider=?;", {keyQuery, provider})) {
+    json = row.text(0);
+  }
 
   services::search::SearchResponse sr;
   sr.query = keyQuery;
@@ -198,9 +205,56 @@ QByteArray InternalSchemeHandler::pageDeepSearch(const QUrl& url) {
     for (const auto& p : results) {
       body += "<li><b>" + QString::fromStdString(p.name).toHtmlEscaped() + "</b> "
               + "<span class='muted'>(" + QString::fromStdString(p.type).toHtmlEscaped() + ")</span> "
-              + "<span class='muted'>id=" + QString::fromStdString(p.entityId).left(10).toHtmlEscaped() + "…</span></li>";
+              + "<span class='muted'>id=" + QString::fromStdString(p.entityId).left(10).toHtmlEscaped() + "…</span>";
+      const auto docs = app_->deepsearch().documentsMentioning(p.entityId, 5);
+      if (!docs.empty()) {
+        body += "<ul>";
+        for (const auto& d : docs) {
+          const QString u = QString::fromStdString(d).toHtmlEscaped();
+          body += "<li><a href='" + u + "'>" + u + "</a></li>";
+        }
+        body += "</ul>";
+      }
+      const auto related = app_->deepsearch().relatedEntities(p.entityId, 5);
+      if (!related.empty()) {
+        body += "<div class='muted'>Related across pages:";
+        for (const auto& r : related) {
+          const QString target = QString::fromUtf8(QUrl::toPercentEncoding(QString::fromStdString(r.name)));
+          body += " <a href='nova://deepsearch?name=" + target + "'>"
+                  + QString::fromStdString(r.name).toHtmlEscaped() + "</a> ("
+                  + QString::number(r.docs) + " docs, " + QString::number(r.score, 'f', 2) + ")";
+        }
+        body += "</div>";
+      }
+      const auto net = app_->deepsearch().network(p.entityId, 2, 8);
+      if (!net.empty()) {
+        body += "<div class='muted'>Network:";
+        for (const auto& n : net) {
+          const QString target = QString::fromUtf8(QUrl::toPercentEncoding(QString::fromStdString(n.name)));
+          body += " <a href='nova://deepsearch?name=" + target + "'>" + QString::fromStdString(n.name).toHtmlEscaped() + "</a> ("
+                  + (n.relation.empty() ? QString::number(n.hops) + " hops" : QString::fromStdString(n.relation).toHtmlEscaped())
+                  + ")";
+        }
+        body += "</div>";
+      }
+      body += "</li>";
     }
     body += "</ul></div>";
+
+    // nova://deepsearch?name=A&to=B: how the best matches for A and B are connected.
+    const QString to = q.queryItemValue("to");
+    if (!to.isEmpty() && !results.empty()) {
+      const auto targets = app_->deepsearch().searchProfiles(to);
+      const auto path = targets.empty() ? std::vector<services::deepsearch::NetworkNode>{}
+                                        : app_->deepsearch().pathBetween(results.front().entityId, targets.front().entityId);
+      body += "<div class='card'><div class='muted'>Connection to: " + to.toHtmlEscaped() + "</div><p>";
+      if (path.empty()) body += "No connection found.";
+      for (const auto& n : path) {
+        if (n.hops > 0) body += " &rarr; <span class='muted'>" + QString::fromStdString(n.relation).toHtmlEscaped() + "</span> &rarr; ";
+        body += "<b>" + QString::fromStdString(n.name).toHtmlEscaped() + "</b>";
+      }
+      body += "</p></div>";
+    }
     body += "<div class='card'><p class='muted'>Graph view is in the Side Panel (Entities tab).</p></div>";
   }
 
@@ -4,6 +4,7 @@
 #include "core/net/UrlTools.h"
 #include "util/Log.h"
 #include "util/Time.h"
+#include "ui/PageCapture.h"
 #include "ui/ScrapeDialog.h"
 
 #include <QVBoxLayout>
@@ -17,6 +18,8 @@
 #include <QtWebEngineCore/QWebEngineUrlSchemeHandler>
 #include <QtWebEngineWidgets/QWebEngineFindTextResult>
 #include <QUrlQuery>
+#include <QPointer>
+#include <QTimer>
 
 namespace ui {
 
@@ -147,8 +150,7 @@ void MainWindow::recordHistory(const QUrl& url, const QString& title) {
   if (url.scheme() == "nova") return;
   const std::string u = url.toString().toStdString();
   const std::string t = title.toStdString();
-  app_->db().execParams("INSERT INTO history(url,title,ts) VALUES(?,?,?);",
-                        {u, t, std::to_string(util::now_ms())});
+  app_->writer().add("INSERT INTO history(url,title,ts) VALUES(?,?,?);", {u, t, util::now_ms()});
 }
 
 void MainWindow::performSearchIfNeeded(const QString& inputText) {
@@ -167,7 +169,7 @@ void MainWindow::performSearchIfNeeded(const QString& inputText) {
       app_->db().execParams(
         "INSERT INTO search_cache(query,provider,ts,json) VALUES(?,?,?,?) "
         "ON CONFLICT(query,provider) DO UPDATE SET ts=excluded.ts, json=excluded.json;",
-        {r.query, r.provider, std::to_string(util::now_ms()), jsonStr}
+        {r.query, r.provider, util::now_ms(), jsonStr}
       );
 
       side_->setSearchContext(query, QString::fromStdString(r.provider), QString::fromStdString(jsonStr));
@@ -247,13 +249,68 @@ void MainWindow::onScrapeDialog() {
   if (!t) return;
 
   QUrl url = t->view()->url();
-  t->view()->page()->toHtml([=](const QString& html) {
+  PageCapture::capture(t, this, [=](const core::extract::HtmlSnapshotPtr& snap) {
     ScrapeDialog dlg(this);
-    dlg.setPage(url, html);
+    services::scraper::RecipeStore recipes(app_->db());
+    dlg.setPage(url, snap);
+    dlg.setRecipeStore(&recipes);
+    connect(&dlg, &ScrapeDialog::applyToTabsRequested, this, [this, &dlg](const QString& recipe) {
+      applyRecipeToTabs(&dlg, recipe);
+    });
     dlg.exec();
   });
 }
 
+void MainWindow::applyRecipeToTabs(ScrapeDialog* dlg, const QString& recipeText) {
+  services::scraper::ScrapeRecipe recipe;
+  auto compiled = std::make_shared<services::scraper::CompiledRecipe>();
+  std::string err;
+  if (!services::scraper::ScrapeRecipe::parse(recipeText.toStdString(), recipe, &err) || !compiled->compile(recipe, &err)) {
+    dlg->showOutput("Selector error: " + QString::fromStdString(err));
+    return;
+  }
+
+  std::vector<BrowserTab*> pages;
+  for (int i = 0; i < tabs_->count(); ++i) {
+    auto* tab = qobject_cast<BrowserTab*>(tabs_->widget(i));
+    const QString scheme = tab ? tab->view()->url().scheme() : QString();
+    if (scheme == "http" || scheme == "https") pages.push_back(tab);
+  }
+
+  // Captures finish in any order, and one for a tab that navigates away never does;
+  // the recipe runs once over whatever arrived when the last capture lands or after 5s.
+  struct Pending {
+    std::vector<core::extract::HtmlSnapshotPtr> snapshots;
+    std::size_t remaining = 0;
+    bool done = false;
+  };
+  auto pending = std::make_shared<Pending>();
+  pending->snapshots.resize(pages.size());
+  pending->remaining = pages.size();
+  QPointer<ScrapeDialog> guard(dlg);
+
+  auto finish = [guard, pending, compiled]() {
+    if (pending->done || !guard) return;
+    pending->done = true;
+    std::vector<core::extract::HtmlSnapshotPtr> ready;
+    for (auto& s : pending->snapshots) {
+      if (s) ready.push_back(s);
+    }
+    guard->showOutput(QString::fromStdString(compiled->applyBulk(ready).dump(2)));
+  };
+  if (pages.empty()) {
+    finish();
+    return;
+  }
+  for (std::size_t i = 0; i < pages.size(); ++i) {
+    PageCapture::capture(pages[i], dlg, [pending, i, finish](const core::extract::HtmlSnapshotPtr& snap) {
+      pending->snapshots[i] = snap;
+      if (--pending->remaining == 0) finish();
+    });
+  }
+  QTimer::singleShot(5000, dlg, finish);
+}
+
 void MainWindow::onAnalyzeShortcut() {
   side_->setActiveTab(tabs_->currentBrowserTab());
   side_->onAnalyzePage();
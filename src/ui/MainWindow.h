@@ -15,6 +15,8 @@
 
 namespace ui {
 
+class ScrapeDialog;
+
 class MainWindow : public QMainWindow {
   Q_OBJECT
 public:
@@ -58,6 +60,7 @@ private:
   void setupUi();
   void setupShortcuts();
   void hookSignals();
+  void applyRecipeToTabs(ScrapeDialog* dlg, const QString& recipeText);
   void recordHistory(const QUrl& url, const QString& title);
 
   void performSearchIfNeeded(const QString& inputText);
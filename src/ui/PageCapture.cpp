@@ -0,0 +1,64 @@
+#include "ui/PageCapture.h"
+#include "ui/BrowserTab.h"
+#include "core/exec/WorkStealingPool.h"
+#include "core/extract/ExtractionCache.h"
+#include <QCoreApplication>
+#include <QPointer>
+#include <QStringEncoder>
+
+namespace ui {
+
+// Exact UTF-8 length of a UTF-16 string, so the output is allocated once at its final
+// size instead of at QStringEncoder::requiredSpace()'s 3x worst case.
+static std::size_t utf8Length(QStringView s) {
+  std::size_t n = 0;
+  const char16_t* p = s.utf16();
+  const char16_t* end = p + s.size();
+  while (p < end) {
+    char16_t c = *p++;
+    if (c < 0x80) n += 1;
+    else if (c < 0x800) n += 2;
+    else if (QChar::isHighSurrogate(c) && p < end && QChar::isLowSurrogate(*p)) { n += 4; ++p; }
+    else n += 3; // BMP, or a lone surrogate that the encoder replaces with U+FFFD
+  }
+  return n;
+}
+
+core::extract::HtmlSnapshotPtr PageCapture::fromUtf16(const QString& url, const QString& html) {
+  auto snap = std::make_shared<core::extract::HtmlSnapshot>();
+  snap->url = url.toStdString();
+
+  QStringEncoder enc(QStringEncoder::Utf8);
+  snap->utf8.resize(utf8Length(html));
+  char* end = enc.appendToBuffer(snap->utf8.data(), html);
+  snap->utf8.resize(std::size_t(end - snap->utf8.data()));
+
+  snap->key = core::extract::ExtractionCache::keyFor(snap->url, snap->utf8);
+  return snap;
+}
+
+void PageCapture::capture(BrowserTab* tab, QObject* context, Callback cb, Freshness freshness) {
+  if (!tab) return;
+  if (auto ready = tab->readySnapshot(freshness)) {
+    cb(ready);
+    return;
+  }
+
+  QPointer<BrowserTab> tabGuard(tab);
+  QPointer<QObject> guard(context);
+  const QUrl url = tab->view()->url();
+  tab->view()->page()->toHtml([tabGuard, guard, url, cb](const QString& html) {
+    // QString is implicitly shared, so handing it to the worker does not copy the document.
+    core::exec::WorkStealingPool::shared().submit([tabGuard, guard, url, cb, html](std::size_t) {
+      auto snap = fromUtf16(url.toString(), html);
+      // Post through the application object, which outlives every tab and panel.
+      QMetaObject::invokeMethod(QCoreApplication::instance(), [tabGuard, guard, url, cb, snap]() {
+        if (!tabGuard || !guard || tabGuard->view()->url() != url) return;
+        tabGuard->setSnapshot(url, snap);
+        cb(snap);
+      }, Qt::QueuedConnection);
+    });
+  });
+}
+
+} // namespace ui
@@ -0,0 +1,32 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <functional>
+
+#include "core/extract/HtmlSnapshot.h"
+
+namespace ui {
+
+class BrowserTab;
+
+// Whether a capture may reuse the tab's snapshot. Without the DOM bridge nothing tells
+// us when script changed the page, so user-triggered actions serialize it again;
+// only speculative work takes what the tab already has.
+enum class Freshness { Reuse, Current };
+
+// The one path from a tab's DOM to extractor input. toHtml() delivers UTF-16; the
+// single UTF-8 conversion runs on the worker pool into an exactly sized buffer, and
+// the snapshot is kept on the tab so analysis, chat and the scraper share it.
+class PageCapture {
+public:
+  using Callback = std::function<void(const core::extract::HtmlSnapshotPtr&)>;
+
+  // cb runs on the GUI thread, only if context and tab are still alive and the tab
+  // still shows the URL it had when the capture started.
+  static void capture(BrowserTab* tab, QObject* context, Callback cb, Freshness freshness = Freshness::Current);
+
+  // Blocking conversion for callers already off the GUI thread.
+  static core::extract::HtmlSnapshotPtr fromUtf16(const QString& url, const QString& html);
+};
+
+} // namespace ui
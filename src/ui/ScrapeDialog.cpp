@@ -14,6 +14,10 @@ namespace ui {
 ScrapeDialog::ScrapeDialog(QWidget* parent)
   : QDialog(parent),
     mode_(new QComboBox(this)),
+    recipeRow_(new QWidget(this)),
+    recipe_(new QPlainTextEdit(recipeRow_)),
+    saveRecipe_(new QPushButton("Save recipe", recipeRow_)),
+    applyAll_(new QPushButton("Apply to all tabs", recipeRow_)),
     out_(new QPlainTextEdit(this)),
     run_(new QPushButton("Run", this)),
     copy_(new QPushButton("Copy", this)),
@@ -26,10 +30,26 @@ ScrapeDialog::ScrapeDialog(QWidget* parent)
   mode_->addItem("Full Text");
   mode_->addItem("Metadata (JSON)");
   mode_->addItem("Links");
-  mode_->addItem("Headings (MVP)");
+  mode_->addItem("Headings (outline)");
   mode_->addItem("Blocks (JSON)");
-  mode_->addItem("Tables -> JSON (stub)");
-  mode_->addItem("JSON-LD (stub)");
+  mode_->addItem("Tables -> JSON");
+  mode_->addItem("Tables -> CSV");
+  mode_->addItem("Structured data (JSON-LD / microdata)");
+  mode_->addItem("CSS selectors (JSON)");
+
+  recipe_->setPlaceholderText("One field per line: [name =] selector [@attr]\n"
+                              "title = h1\nprice = .product .price\nimage = img.hero @src");
+  recipe_->setFixedHeight(96);
+  auto* recipeButtons = new QVBoxLayout();
+  recipeButtons->addWidget(saveRecipe_);
+  recipeButtons->addWidget(applyAll_);
+  recipeButtons->addStretch(1);
+  auto* recipeLayout = new QHBoxLayout(recipeRow_);
+  recipeLayout->setContentsMargins(0, 0, 0, 0);
+  recipeLayout->addWidget(recipe_, 1);
+  recipeLayout->addLayout(recipeButtons);
+  recipeRow_->setVisible(false);
+  saveRecipe_->setEnabled(false);
 
   out_->setReadOnly(true);
   out_->setPlaceholderText("Output…");
@@ -42,16 +62,56 @@ ScrapeDialog::ScrapeDialog(QWidget* parent)
 
   auto* layout = new QVBoxLayout(this);
   layout->addLayout(top);
+  layout->addWidget(recipeRow_);
   layout->addWidget(out_, 1);
 
   connect(run_, &QPushButton::clicked, this, &ScrapeDialog::runScrape);
   connect(copy_, &QPushButton::clicked, this, &ScrapeDialog::copyToClipboard);
   connect(save_, &QPushButton::clicked, this, &ScrapeDialog::saveToFile);
+  connect(mode_, &QComboBox::currentIndexChanged, this, &ScrapeDialog::onModeChanged);
+  connect(saveRecipe_, &QPushButton::clicked, this, &ScrapeDialog::saveRecipe);
+  connect(applyAll_, &QPushButton::clicked, this, [this]() {
+    out_->setPlainText("Capturing tabs…");
+    emit applyToTabsRequested(recipe_->toPlainText());
+  });
 }
 
-void ScrapeDialog::setPage(const QUrl& url, const QString& html) {
+void ScrapeDialog::setRecipeStore(services::scraper::RecipeStore* store) {
+  recipes_ = store;
+  saveRecipe_->setEnabled(recipes_ != nullptr);
+  services::scraper::ScrapeRecipe r;
+  if (recipes_ && recipe_->toPlainText().isEmpty() && recipes_->find(url_.host().toStdString(), r)) {
+    recipe_->setPlainText(QString::fromStdString(r.toText()));
+  }
+}
+
+void ScrapeDialog::showOutput(const QString& text) {
+  out_->setPlainText(text);
+}
+
+void ScrapeDialog::onModeChanged(int idx) {
+  recipeRow_->setVisible(modeFromIndex(idx) == services::scraper::ScrapeMode::Selector);
+}
+
+void ScrapeDialog::saveRecipe() {
+  if (!recipes_) return;
+  services::scraper::ScrapeRecipe r;
+  std::string err;
+  if (!services::scraper::ScrapeRecipe::parse(recipe_->toPlainText().toStdString(), r, &err)) {
+    out_->setPlainText("Selector error: " + QString::fromStdString(err));
+    return;
+  }
+  r.host = url_.host().toStdString();
+  if (r.host.empty() || !recipes_->save(r)) {
+    out_->setPlainText("Could not save the recipe for this page.");
+    return;
+  }
+  out_->setPlainText("Recipe saved for " + url_.host() + ".");
+}
+
+void ScrapeDialog::setPage(const QUrl& url, const core::extract::HtmlSnapshotPtr& snapshot) {
   url_ = url;
-  html_ = html;
+  snapshot_ = snapshot;
   runScrape();
 }
 
@@ -64,15 +124,18 @@ services::scraper::ScrapeMode ScrapeDialog::modeFromIndex(int idx) const {
     case 3: return ScrapeMode::Links;
     case 4: return ScrapeMode::Headings;
     case 5: return ScrapeMode::BlocksJson;
-    case 6: return ScrapeMode::TablesStub;
-    case 7: return ScrapeMode::JsonLdStub;
+    case 6: return ScrapeMode::Tables;
+    case 7: return ScrapeMode::TablesCsv;
+    case 8: return ScrapeMode::StructuredData;
+    case 9: return ScrapeMode::Selector;
     default: return ScrapeMode::Reader;
   }
 }
 
 void ScrapeDialog::runScrape() {
   auto mode = modeFromIndex(mode_->currentIndex());
-  auto result = scraper_.run(mode, url_, html_);
+  if (!snapshot_) return;
+  auto result = scraper_.run(mode, *snapshot_, recipe_->toPlainText().toStdString());
   out_->setPlainText(result.text);
 }
 
@@ -84,6 +147,7 @@ void ScrapeDialog::saveToFile() {
   QString suggested = "export.txt";
   if (mode_->currentIndex() == 0) suggested = "reader.md";
   if (mode_->currentIndex() == 2 || mode_->currentIndex() >= 5) suggested = "export.json";
+  if (mode_->currentIndex() == 7) suggested = "tables.csv";
 
   QString path = QFileDialog::getSaveFileName(this, "Save export", suggested);
   if (path.isEmpty()) return;
@@ -7,6 +7,7 @@
 #include <QPushButton>
 #include <QUrl>
 
+#include "services/scraper/ScrapeRecipe.h"
 #include "services/scraper/ScraperService.h"
 
 namespace ui {
@@ -16,24 +17,38 @@ class ScrapeDialog : public QDialog {
 public:
   explicit ScrapeDialog(QWidget* parent = nullptr);
 
-  void setPage(const QUrl& url, const QString& html);
+  void setPage(const QUrl& url, const core::extract::HtmlSnapshotPtr& snapshot);
+  // Enables saving recipes and pre-fills the selector box from the page's site recipe.
+  void setRecipeStore(services::scraper::RecipeStore* store);
+  void showOutput(const QString& text);
+
+signals:
+  // "Apply to all tabs" in selector mode; the owner captures the tabs and calls showOutput.
+  void applyToTabsRequested(const QString& recipe);
 
 private slots:
   void runScrape();
+  void onModeChanged(int idx);
+  void saveRecipe();
   void copyToClipboard();
   void saveToFile();
 
 private:
   QUrl url_;
-  QString html_;
+  core::extract::HtmlSnapshotPtr snapshot_;
 
   QComboBox* mode_;
+  QWidget* recipeRow_;
+  QPlainTextEdit* recipe_;
+  QPushButton* saveRecipe_;
+  QPushButton* applyAll_;
   QPlainTextEdit* out_;
   QPushButton* run_;
   QPushButton* copy_;
   QPushButton* save_;
 
   services::scraper::ScraperService scraper_;
+  services::scraper::RecipeStore* recipes_ = nullptr;
 
   services::scraper::ScrapeMode modeFromIndex(int idx) const;
 };
@@ -12,6 +12,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QMessageBox>
 #include <QUrl>
 
 namespace ui {
@@ -30,7 +31,8 @@ SidePanel::SidePanel(NovaApp* app, QWidget* parent)
     useSearchCtx_(new QCheckBox("Use Search Context", this)),
     graph_(new EntityGraphWidget(this)),
     entityList_(new QPlainTextEdit(this)),
-    deepSearchBtn_(new QPushButton("Open DeepSearch", this)) {
+    deepSearchBtn_(new QPushButton("Open DeepSearch", this)),
+    mergeBtn_(new QPushButton("Merge Duplicate Entities…", this)) {
 
   setMinimumWidth(360);
 
@@ -69,6 +71,7 @@ SidePanel::SidePanel(NovaApp* app, QWidget* parent)
   entLayout->addWidget(graph_, 2);
   entLayout->addWidget(entityList_, 1);
   entLayout->addWidget(deepSearchBtn_);
+  entLayout->addWidget(mergeBtn_);
 
   tabs_->addTab(chatTab, "AI");
   tabs_->addTab(entTab, "Entities");
@@ -81,6 +84,7 @@ SidePanel::SidePanel(NovaApp* app, QWidget* parent)
   connect(analyzeBtn_, &QPushButton::clicked, this, &SidePanel::onAnalyzePage);
   connect(overviewBtn_, &QPushButton::clicked, this, &SidePanel::onOverviewFromSearch);
   connect(chatInput_, &QLineEdit::returnPressed, this, &SidePanel::onAsk);
+  connect(mergeBtn_, &QPushButton::clicked, this, &SidePanel::onMergeDuplicates);
   connect(deepSearchBtn_, &QPushButton::clicked, this, [this]() {
     if (!activeTab_) return;
     activeTab_->view()->setUrl(QUrl("nova://deepsearch"));
@@ -127,8 +131,8 @@ QString SidePanel::buildChatPromptWithContext(const QString& userMsg, const core
   return prompt;
 }
 
-void SidePanel::refreshEntitiesFromPage(const core::extract::ExtractedPage& ep, const QString& url) {
-  auto ents = detector_.detect(ep.fullText);
+void SidePanel::showEntities(const std::vector<core::entities::EntityMention>& ents,
+                             const core::extract::ExtractedPage& ep, const QString& url) {
   QString list;
   for (const auto& e : ents) {
     list += QString::fromStdString(core::entities::toString(e.type)) + " • "
@@ -136,36 +140,71 @@ void SidePanel::refreshEntitiesFromPage(const core::extract::ExtractedPage& ep,
   }
   entityList_->setPlainText(list.isEmpty() ? "No entities detected." : list);
   graph_->setEntities(ents, "Page");
+  app_->deepsearch().indexDocument(url, ep, ents);
 
   // Create a minimal DeepSearch profile for the top person-like entity, if any
   for (const auto& e : ents) {
     if (e.type == core::entities::EntityType::Person && e.confidence > 0.70) {
-      auto profile = app_->deepsearch().buildProfileFromText(QString::fromStdString(e.name), url, QString::fromStdString(ep.fullText));
+      auto profile = app_->deepsearch().buildProfileFromPage(QString::fromStdString(e.name), url, ents);
       app_->deepsearch().upsertEntity(profile);
       break;
     }
   }
 }
 
-void SidePanel::onAnalyzePage() {
-  if (!activeTab_) return;
+void SidePanel::onMergeDuplicates() {
+  // Clustering runs on the pool; nothing is merged until the user has seen the list.
+  mergeBtn_->setEnabled(false);
+  entityList_->setPlainText("Looking for duplicate entities…");
+  app_->deepsearch().findDuplicates(this, [this](const std::vector<services::deepsearch::EntityMerge>& merges) {
+    mergeBtn_->setEnabled(true);
+    if (merges.empty()) {
+      entityList_->setPlainText("No duplicate entities found.");
+      return;
+    }
+    QString list;
+    for (const auto& m : merges) {
+      list += QString::fromStdString(m.fromName) + " → " + QString::fromStdString(m.intoName) + "\n";
+    }
+    entityList_->setPlainText(list);
+    const auto answer = QMessageBox::question(this, "Merge Duplicate Entities",
+      QString("Merge %1 duplicate entities as listed? Each merge is logged and kept in entity_merges.").arg((int)merges.size()));
+    if (answer != QMessageBox::Yes) return;
+    const std::size_t merged = app_->deepsearch().mergeEntities(merges);
+    entityList_->appendPlainText("\nMerged " + QString::number((int)merged) + " entities.");
+  });
+}
 
-  QUrl url = activeTab_->view()->url();
-  activeTab_->view()->page()->toHtml([=](const QString& html) {
-    core::extract::ExtractedPage ep = extractor_.extract(html.toStdString(), url.toString().toStdString());
+void SidePanel::analyzeExtracted(const core::extract::ExtractedPage& ep, const QString& url,
+                                 const std::vector<core::entities::EntityMention>& entities) {
+  appendChatLine("system", "Extracted " + QString::number((int)ep.blocks.size()) + " blocks. Building analysis prompt…");
+  showEntities(entities, ep, url);
+
+  QString userMsg = "Analyze the page. Provide: summary, key claims with block citations, uncertainty/bias notes, and an entity list.";
+  QString prompt = buildChatPromptWithContext(userMsg, &ep, useSearchCtx_->isChecked() ? &searchJson_ : nullptr);
 
-    appendChatLine("system", "Extracted " + QString::number((int)ep.blocks.size()) + " blocks. Building analysis prompt…");
-    refreshEntitiesFromPage(ep, url.toString());
+  app_->ollama().generate(QString::fromStdString(app_->config().ollamaModel()), prompt, [=](const QString& text, const nlohmann::json&) {
+    appendChatLine("assistant", text);
+  });
+}
 
-    QString userMsg = "Analyze the page. Provide: summary, key claims with block citations, uncertainty/bias notes, and an entity list.";
-    QString prompt = buildChatPromptWithContext(userMsg, &ep, useSearchCtx_->isChecked() ? &searchJson_ : nullptr);
+void SidePanel::onAnalyzePage() {
+  if (!activeTab_) return;
 
-    app_->ollama().generate(QString::fromStdString(app_->config().ollamaModel()), prompt, [=](const QString& text, const nlohmann::json&) {
-      appendChatLine("assistant", text);
-    });
+  QUrl url = activeTab_->view()->url();
+  // If the page is unchanged since the speculative pass, its result is reused.
+  withAnalysis([=](const services::analysis::PageAnalysisPtr& a) {
+    analyzeExtracted(*a->page, url.toString(), a->entities);
   });
 }
 
+void SidePanel::withAnalysis(const std::function<void(const services::analysis::PageAnalysisPtr&)>& cb) {
+  if (!activeTab_) return;
+  // Capture, extraction and detection all run on the pool; the tab keeps the result.
+  // User-triggered: re-captured unless a live DOM model says the page is unchanged.
+  activeTab_->requestAnalysis(app_->analysis(), Freshness::Current, cb);
+}
+
 void SidePanel::onOverviewFromSearch() {
   if (searchJson_.isEmpty()) {
     appendChatLine("system", "No search context available. Perform a search first.");
@@ -194,11 +233,9 @@ void SidePanel::onAsk() {
     return;
   }
 
-  QUrl url = activeTab_->view()->url();
   if (usePageCtx_->isChecked()) {
-    activeTab_->view()->page()->toHtml([=](const QString& html) {
-      core::extract::ExtractedPage ep = extractor_.extract(html.toStdString(), url.toString().toStdString());
-      QString prompt = buildChatPromptWithContext(msg, &ep, useSearchCtx_->isChecked() ? &searchJson_ : nullptr);
+    withAnalysis([=](const services::analysis::PageAnalysisPtr& a) {
+      QString prompt = buildChatPromptWithContext(msg, a->page.get(), useSearchCtx_->isChecked() ? &searchJson_ : nullptr);
       app_->ollama().generate(QString::fromStdString(app_->config().ollamaModel()), prompt, [=](const QString& text, const nlohmann::json&) {
         appendChatLine("assistant", text);
       });
@@ -8,6 +8,7 @@
 #include <QPushButton>
 #include <QCheckBox>
 #include <QLabel>
+#include <functional>
 
 #include "app/NovaApp.h"
 #include "ui/EntityGraphWidget.h"
@@ -30,6 +31,7 @@ private slots:
   void onAsk();
   void onAnalyzePage();
   void onOverviewFromSearch();
+  void onMergeDuplicates();
 
 private:
   NovaApp* app_;
@@ -49,18 +51,21 @@ private:
   EntityGraphWidget* graph_;
   QPlainTextEdit* entityList_;
   QPushButton* deepSearchBtn_;
+  QPushButton* mergeBtn_;
 
   // State
   QString searchQuery_;
   QString searchProvider_;
   QString searchJson_;
 
-  core::extract::HtmlExtractor extractor_;
-  core::entities::EntityDetector detector_;
-
   void appendChatLine(const QString& who, const QString& text);
   QString buildChatPromptWithContext(const QString& userMsg, const core::extract::ExtractedPage* page, const QString* searchJson);
-  void refreshEntitiesFromPage(const core::extract::ExtractedPage& ep, const QString& url);
+  void showEntities(const std::vector<core::entities::EntityMention>& ents,
+                    const core::extract::ExtractedPage& ep, const QString& url);
+  void analyzeExtracted(const core::extract::ExtractedPage& ep, const QString& url,
+                        const std::vector<core::entities::EntityMention>& entities);
+  // The active tab's analysis: the ready one if any, else captured and analyzed off the GUI thread.
+  void withAnalysis(const std::function<void(const services::analysis::PageAnalysisPtr&)>& cb);
 };
 
 } // namespace ui
@@ -1,11 +1,17 @@
 \
 /* src/ui/TabWidget.cpp */
 #include "ui/TabWidget.h"
+#include <algorithm>
 
 namespace ui {
 
 TabWidget::TabWidget(NovaApp* app, QWidget* parent)
-  : QTabWidget(parent), app_(app) {
+  : QTabWidget(parent),
+    app_(app),
+    speculative_(app->config().speculativeExtraction()),
+    speculativeTabs_(std::max(1, app->config().speculativeTabs())),
+    speculativeDebounceMs_(std::max(0, app->config().speculativeDebounceMs())),
+    domBridge_(app->config().domBridge()) {
   setDocumentMode(true);
   setTabsClosable(true);
   setMovable(true);
@@ -14,6 +20,8 @@ TabWidget::TabWidget(NovaApp* app, QWidget* parent)
   QObject::connect(this, &QTabWidget::currentChanged, this, [this](int) {
     auto* t = currentBrowserTab();
     if (!t) return;
+    touchRecent(t);
+    maybeScheduleAnalysis(t);
     emit activeUrlChanged(t->view()->url());
     emit activeTitleChanged(t->view()->title());
   });
@@ -35,12 +43,42 @@ void TabWidget::hookTabSignals(BrowserTab* tab) {
     if (tab == currentBrowserTab()) emit activeUrlChanged(url);
   });
   QObject::connect(tab, &BrowserTab::loadStateChanged, this, [this, tab](bool loading) {
+    if (!loading) maybeScheduleAnalysis(tab);
     if (tab == currentBrowserTab()) emit activeLoadStateChanged(loading);
   });
+  QObject::connect(tab, &BrowserTab::analysisDue, this, [this, tab]() { runAnalysis(tab); });
+  // A live model makes the last analysis stale on every delta; the tab timer debounces.
+  QObject::connect(tab, &BrowserTab::liveModelChanged, this, [this, tab]() { maybeScheduleAnalysis(tab); });
+}
+
+void TabWidget::touchRecent(BrowserTab* tab) {
+  recent_.removeAll(QPointer<BrowserTab>(tab));
+  recent_.removeAll(QPointer<BrowserTab>());
+  recent_.prepend(tab);
+  while (recent_.size() > speculativeTabs_) {
+    if (auto t = recent_.takeLast()) t->cancelAnalysis();
+  }
+}
+
+bool TabWidget::isRecent(BrowserTab* tab) const {
+  return recent_.contains(QPointer<BrowserTab>(tab));
+}
+
+void TabWidget::maybeScheduleAnalysis(BrowserTab* tab) {
+  if (!speculative_ || !tab || tab->isLoading() || !isRecent(tab)) return;
+  if (tab->view()->url().scheme() == "nova") return;
+  if (tab->readyAnalysis()) return;
+  tab->scheduleAnalysis(speculativeDebounceMs_);
+}
+
+void TabWidget::runAnalysis(BrowserTab* tab) {
+  if (!isRecent(tab) || tab->isLoading()) return;
+  tab->requestAnalysis(app_->analysis(), Freshness::Reuse, nullptr);
 }
 
 BrowserTab* TabWidget::addNewTab(const QUrl& url, bool switchTo) {
   auto* tab = new BrowserTab(this);
+  if (domBridge_) tab->enableDomBridge();
   hookTabSignals(tab);
   int idx = addTab(tab, "New Tab");
   if (switchTo) setCurrentIndex(idx);
@@ -2,6 +2,7 @@
 /* src/ui/TabWidget.h */
 #pragma once
 #include <QTabWidget>
+#include <QPointer>
 #include <QUrl>
 
 #include "ui/BrowserTab.h"
@@ -29,7 +30,18 @@ private:
   struct ClosedTabInfo { QUrl url; QString title; };
   QList<ClosedTabInfo> closed_;
 
+  // Speculative analysis is limited to the active and recently active tabs.
+  bool speculative_;
+  int speculativeTabs_;
+  int speculativeDebounceMs_;
+  bool domBridge_;
+  QList<QPointer<BrowserTab>> recent_; // most recently active first
+
   void hookTabSignals(BrowserTab* tab);
+  void touchRecent(BrowserTab* tab);
+  bool isRecent(BrowserTab* tab) const;
+  void maybeScheduleAnalysis(BrowserTab* tab);
+  void runAnalysis(BrowserTab* tab);
 };
 
 } // namespace ui
@@ -67,6 +67,12 @@ int Config::fetchRetries() const { return getInt(j_, {"fetch","retries"}, 2); }
 double Config::rateLimitPerSec() const { return getDouble(j_, {"fetch","rate_limit_per_sec"}, 1.5); }
 int Config::cacheMb() const { return getInt(j_, {"fetch","cache_mb"}, 64); }
 
+int Config::extractCacheMb() const { return getInt(j_, {"extract","cache_mb"}, 32); }
+bool Config::speculativeExtraction() const { return getBool(j_, {"extract","speculative"}, false); }
+int Config::speculativeTabs() const { return getInt(j_, {"extract","speculative_tabs"}, 3); }
+int Config::speculativeDebounceMs() const { return getInt(j_, {"extract","speculative_debounce_ms"}, 600); }
+bool Config::domBridge() const { return getBool(j_, {"extract","dom_bridge"}, false); }
+
 std::string Config::searchProvider() const { return getStr(j_, {"search","provider"}, "ddg_html"); }
 bool Config::searchSafe() const { return getBool(j_, {"search","safe"}, true); }
 
@@ -20,6 +20,12 @@ public:
   double rateLimitPerSec() const;
   int cacheMb() const;
 
+  int extractCacheMb() const;
+  bool speculativeExtraction() const;
+  int speculativeTabs() const;
+  int speculativeDebounceMs() const;
+  bool domBridge() const;
+
   std::string searchProvider() const;
   bool searchSafe() const;
 
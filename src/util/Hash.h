@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace util {
+
+// XXH64 (Yann Collet's xxHash, 64-bit variant). Fast non-cryptographic hash used for
+// content-addressed keys; do not use it where an adversary picks the input.
+std::uint64_t xxh64(const void* data, std::size_t len, std::uint64_t seed = 0);
+
+inline std::uint64_t xxh64(std::string_view s, std::uint64_t seed = 0) {
+  return xxh64(s.data(), s.size(), seed);
+}
+
+// 16 lowercase hex digits.
+std::string hex64(std::uint64_t v);
+
+} // namespace util
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace util {
+
+// Read-only memory mapping of a whole file. Move-only; unmaps on destruction.
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // False for missing, unreadable or empty files.
+  bool open(const std::string& path);
+  void close();
+
+  bool isOpen() const { return data_ != nullptr; }
+  const unsigned char* data() const { return data_; }
+  std::size_t size() const { return size_; }
+
+private:
+  const unsigned char* data_ = nullptr;
+  std::size_t size_ = 0;
+#ifdef _WIN32
+  void* file_ = nullptr;
+  void* mapping_ = nullptr;
+#endif
+};
+
+} // namespace util
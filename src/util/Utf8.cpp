@@ -0,0 +1,411 @@
+#include "util/Utf8.h"
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+
+namespace util::utf8 {
+
+namespace {
+
+// first..last, every stride-th code point (case pairs alternate, so stride 2 halves
+// the uppercase table).
+struct Range {
+  char32_t first;
+  char32_t last;
+  unsigned char stride;
+};
+
+// Generated from the UCD 14.0 general categories with Python's unicodedata; ASCII is
+// left out (handled inline).
+const Range kUpper[] = {
+  {0x00C0, 0x00D6, 1}, {0x00D8, 0x00DE, 1}, {0x0100, 0x0136, 2}, {0x0139, 0x0147, 2},
+  {0x014A, 0x0178, 2}, {0x0179, 0x017D, 2}, {0x0181, 0x0182, 1}, {0x0184, 0x0186, 2},
+  {0x0187, 0x0189, 2}, {0x018A, 0x018B, 1}, {0x018E, 0x0191, 1}, {0x0193, 0x0194, 1},
+  {0x0196, 0x0198, 1}, {0x019C, 0x019D, 1}, {0x019F, 0x01A0, 1}, {0x01A2, 0x01A6, 2},
+  {0x01A7, 0x01A9, 2}, {0x01AC, 0x01AE, 2}, {0x01AF, 0x01B1, 2}, {0x01B2, 0x01B3, 1},
+  {0x01B5, 0x01B7, 2}, {0x01B8, 0x01B8, 1}, {0x01BC, 0x01BC, 1}, {0x01C4, 0x01C5, 1},
+  {0x01C7, 0x01C8, 1}, {0x01CA, 0x01CB, 1}, {0x01CD, 0x01DB, 2}, {0x01DE, 0x01EE, 2},
+  {0x01F1, 0x01F2, 1}, {0x01F4, 0x01F6, 2}, {0x01F7, 0x01F8, 1}, {0x01FA, 0x0232, 2},
+  {0x023A, 0x023B, 1}, {0x023D, 0x023E, 1}, {0x0241, 0x0243, 2}, {0x0244, 0x0246, 1},
+  {0x0248, 0x024E, 2}, {0x0370, 0x0372, 2}, {0x0376, 0x0376, 1}, {0x037F, 0x037F, 1},
+  {0x0386, 0x0388, 2}, {0x0389, 0x038A, 1}, {0x038C, 0x038E, 2}, {0x038F, 0x0391, 2},
+  {0x0392, 0x03A1, 1}, {0x03A3, 0x03AB, 1}, {0x03CF, 0x03CF, 1}, {0x03D2, 0x03D4, 1},
+  {0x03D8, 0x03EE, 2}, {0x03F4, 0x03F4, 1}, {0x03F7, 0x03F9, 2}, {0x03FA, 0x03FA, 1},
+  {0x03FD, 0x042F, 1}, {0x0460, 0x0480, 2}, {0x048A, 0x04C0, 2}, {0x04C1, 0x04CD, 2},
+  {0x04D0, 0x052E, 2}, {0x0531, 0x0556, 1}, {0x10A0, 0x10C5, 1}, {0x10C7, 0x10C7, 1},
+  {0x10CD, 0x10CD, 1}, {0x13A0, 0x13F5, 1}, {0x1C90, 0x1CBA, 1}, {0x1CBD, 0x1CBF, 1},
+  {0x1E00, 0x1E94, 2}, {0x1E9E, 0x1EFE, 2}, {0x1F08, 0x1F0F, 1}, {0x1F18, 0x1F1D, 1},
+  {0x1F28, 0x1F2F, 1}, {0x1F38, 0x1F3F, 1}, {0x1F48, 0x1F4D, 1}, {0x1F59, 0x1F5F, 2},
+  {0x1F68, 0x1F6F, 1}, {0x1F88, 0x1F8F, 1}, {0x1F98, 0x1F9F, 1}, {0x1FA8, 0x1FAF, 1},
+  {0x1FB8, 0x1FBC, 1}, {0x1FC8, 0x1FCC, 1}, {0x1FD8, 0x1FDB, 1}, {0x1FE8, 0x1FEC, 1},
+  {0x1FF8, 0x1FFC, 1}, {0x2102, 0x2102, 1}, {0x2107, 0x2107, 1}, {0x210B, 0x210D, 1},
+  {0x2110, 0x2112, 1}, {0x2115, 0x2115, 1}, {0x2119, 0x211D, 1}, {0x2124, 0x212A, 2},
+  {0x212B, 0x212D, 1}, {0x2130, 0x2133, 1}, {0x213E, 0x213F, 1}, {0x2145, 0x2145, 1},
+  {0x2183, 0x2183, 1}, {0x2C00, 0x2C2F, 1}, {0x2C60, 0x2C62, 2}, {0x2C63, 0x2C64, 1},
+  {0x2C67, 0x2C6D, 2}, {0x2C6E, 0x2C70, 1}, {0x2C72, 0x2C72, 1}, {0x2C75, 0x2C75, 1},
+  {0x2C7E, 0x2C80, 1}, {0x2C82, 0x2CE2, 2}, {0x2CEB, 0x2CED, 2}, {0x2CF2, 0x2CF2, 1},
+  {0xA640, 0xA66C, 2}, {0xA680, 0xA69A, 2}, {0xA722, 0xA72E, 2}, {0xA732, 0xA76E, 2},
+  {0xA779, 0xA77D, 2}, {0xA77E, 0xA786, 2}, {0xA78B, 0xA78D, 2}, {0xA790, 0xA792, 2},
+  {0xA796, 0xA7AA, 2}, {0xA7AB, 0xA7AE, 1}, {0xA7B0, 0xA7B4, 1}, {0xA7B6, 0xA7C4, 2},
+  {0xA7C5, 0xA7C7, 1}, {0xA7C9, 0xA7C9, 1}, {0xA7D0, 0xA7D0, 1}, {0xA7D6, 0xA7D8, 2},
+  {0xA7F5, 0xA7F5, 1}, {0xFF21, 0xFF3A, 1}, {0x10400, 0x10427, 1}, {0x104B0, 0x104D3, 1},
+  {0x10570, 0x1057A, 1}, {0x1057C, 0x1058A, 1}, {0x1058C, 0x10592, 1}, {0x10594, 0x10595, 1},
+  {0x10C80, 0x10CB2, 1}, {0x118A0, 0x118BF, 1}, {0x16E40, 0x16E5F, 1}, {0x1D400, 0x1D419, 1},
+  {0x1D434, 0x1D44D, 1}, {0x1D468, 0x1D481, 1}, {0x1D49C, 0x1D49E, 2}, {0x1D49F, 0x1D49F, 1},
+  {0x1D4A2, 0x1D4A2, 1}, {0x1D4A5, 0x1D4A6, 1}, {0x1D4A9, 0x1D4AC, 1}, {0x1D4AE, 0x1D4B5, 1},
+  {0x1D4D0, 0x1D4E9, 1}, {0x1D504, 0x1D505, 1}, {0x1D507, 0x1D50A, 1}, {0x1D50D, 0x1D514, 1},
+  {0x1D516, 0x1D51C, 1}, {0x1D538, 0x1D539, 1}, {0x1D53B, 0x1D53E, 1}, {0x1D540, 0x1D544, 1},
+  {0x1D546, 0x1D546, 1}, {0x1D54A, 0x1D550, 1}, {0x1D56C, 0x1D585, 1}, {0x1D5A0, 0x1D5B9, 1},
+  {0x1D5D4, 0x1D5ED, 1}, {0x1D608, 0x1D621, 1}, {0x1D63C, 0x1D655, 1}, {0x1D670, 0x1D689, 1},
+  {0x1D6A8, 0x1D6C0, 1}, {0x1D6E2, 0x1D6FA, 1}, {0x1D71C, 0x1D734, 1}, {0x1D756, 0x1D76E, 1},
+  {0x1D790, 0x1D7A8, 1}, {0x1D7CA, 0x1D7CA, 1}, {0x1E900, 0x1E921, 1},
+};
+
+const Range kAlpha[] = {
+  {0x00AA, 0x00AA, 1}, {0x00B5, 0x00B5, 1}, {0x00BA, 0x00BA, 1}, {0x00C0, 0x00D6, 1},
+  {0x00D8, 0x00F6, 1}, {0x00F8, 0x02C1, 1}, {0x02C6, 0x02D1, 1}, {0x02E0, 0x02E4, 1},
+  {0x02EC, 0x02EC, 1}, {0x02EE, 0x02EE, 1}, {0x0300, 0x0374, 1}, {0x0376, 0x0377, 1},
+  {0x037A, 0x037D, 1}, {0x037F, 0x037F, 1}, {0x0386, 0x0386, 1}, {0x0388, 0x038A, 1},
+  {0x038C, 0x038C, 1}, {0x038E, 0x03A1, 1}, {0x03A3, 0x03F5, 1}, {0x03F7, 0x0481, 1},
+  {0x0483, 0x052F, 1}, {0x0531, 0x0556, 1}, {0x0559, 0x0559, 1}, {0x0560, 0x0588, 1},
+  {0x0591, 0x05BD, 1}, {0x05BF, 0x05BF, 1}, {0x05C1, 0x05C2, 1}, {0x05C4, 0x05C5, 1},
+  {0x05C7, 0x05C7, 1}, {0x05D0, 0x05EA, 1}, {0x05EF, 0x05F2, 1}, {0x0610, 0x061A, 1},
+  {0x0620, 0x065F, 1}, {0x066E, 0x06D3, 1}, {0x06D5, 0x06DC, 1}, {0x06DF, 0x06E8, 1},
+  {0x06EA, 0x06EF, 1}, {0x06FA, 0x06FC, 1}, {0x06FF, 0x06FF, 1}, {0x0710, 0x074A, 1},
+  {0x074D, 0x07B1, 1}, {0x07CA, 0x07F5, 1}, {0x07FA, 0x07FA, 1}, {0x07FD, 0x07FD, 1},
+  {0x0800, 0x082D, 1}, {0x0840, 0x085B, 1}, {0x0860, 0x086A, 1}, {0x0870, 0x0887, 1},
+  {0x0889, 0x088E, 1}, {0x0898, 0x08E1, 1}, {0x08E3, 0x0963, 1}, {0x0971, 0x0983, 1},
+  {0x0985, 0x098C, 1}, {0x098F, 0x0990, 1}, {0x0993, 0x09A8, 1}, {0x09AA, 0x09B0, 1},
+  {0x09B2, 0x09B2, 1}, {0x09B6, 0x09B9, 1}, {0x09BC, 0x09C4, 1}, {0x09C7, 0x09C8, 1},
+  {0x09CB, 0x09CE, 1}, {0x09D7, 0x09D7, 1}, {0x09DC, 0x09DD, 1}, {0x09DF, 0x09E3, 1},
+  {0x09F0, 0x09F1, 1}, {0x09FC, 0x09FC, 1}, {0x09FE, 0x09FE, 1}, {0x0A01, 0x0A03, 1},
+  {0x0A05, 0x0A0A, 1}, {0x0A0F, 0x0A10, 1}, {0x0A13, 0x0A28, 1}, {0x0A2A, 0x0A30, 1},
+  {0x0A32, 0x0A33, 1}, {0x0A35, 0x0A36, 1}, {0x0A38, 0x0A39, 1}, {0x0A3C, 0x0A3C, 1},
+  {0x0A3E, 0x0A42, 1}, {0x0A47, 0x0A48, 1}, {0x0A4B, 0x0A4D, 1}, {0x0A51, 0x0A51, 1},
+  {0x0A59, 0x0A5C, 1}, {0x0A5E, 0x0A5E, 1}, {0x0A70, 0x0A75, 1}, {0x0A81, 0x0A83, 1},
+  {0x0A85, 0x0A8D, 1}, {0x0A8F, 0x0A91, 1}, {0x0A93, 0x0AA8, 1}, {0x0AAA, 0x0AB0, 1},
+  {0x0AB2, 0x0AB3, 1}, {0x0AB5, 0x0AB9, 1}, {0x0ABC, 0x0AC5, 1}, {0x0AC7, 0x0AC9, 1},
+  {0x0ACB, 0x0ACD, 1}, {0x0AD0, 0x0AD0, 1}, {0x0AE0, 0x0AE3, 1}, {0x0AF9, 0x0AFF, 1},
+  {0x0B01, 0x0B03, 1}, {0x0B05, 0x0B0C, 1}, {0x0B0F, 0x0B10, 1}, {0x0B13, 0x0B28, 1},
+  {0x0B2A, 0x0B30, 1}, {0x0B32, 0x0B33, 1}, {0x0B35, 0x0B39, 1}, {0x0B3C, 0x0B44, 1},
+  {0x0B47, 0x0B48, 1}, {0x0B4B, 0x0B4D, 1}, {0x0B55, 0x0B57, 1}, {0x0B5C, 0x0B5D, 1},
+  {0x0B5F, 0x0B63, 1}, {0x0B71, 0x0B71, 1}, {0x0B82, 0x0B83, 1}, {0x0B85, 0x0B8A, 1},
+  {0x0B8E, 0x0B90, 1}, {0x0B92, 0x0B95, 1}, {0x0B99, 0x0B9A, 1}, {0x0B9C, 0x0B9C, 1},
+  {0x0B9E, 0x0B9F, 1}, {0x0BA3, 0x0BA4, 1}, {0x0BA8, 0x0BAA, 1}, {0x0BAE, 0x0BB9, 1},
+  {0x0BBE, 0x0BC2, 1}, {0x0BC6, 0x0BC8, 1}, {0x0BCA, 0x0BCD, 1}, {0x0BD0, 0x0BD0, 1},
+  {0x0BD7, 0x0BD7, 1}, {0x0C00, 0x0C0C, 1}, {0x0C0E, 0x0C10, 1}, {0x0C12, 0x0C28, 1},
+  {0x0C2A, 0x0C39, 1}, {0x0C3C, 0x0C44, 1}, {0x0C46, 0x0C48, 1}, {0x0C4A, 0x0C4D, 1},
+  {0x0C55, 0x0C56, 1}, {0x0C58, 0x0C5A, 1}, {0x0C5D, 0x0C5D, 1}, {0x0C60, 0x0C63, 1},
+  {0x0C80, 0x0C83, 1}, {0x0C85, 0x0C8C, 1}, {0x0C8E, 0x0C90, 1}, {0x0C92, 0x0CA8, 1},
+  {0x0CAA, 0x0CB3, 1}, {0x0CB5, 0x0CB9, 1}, {0x0CBC, 0x0CC4, 1}, {0x0CC6, 0x0CC8, 1},
+  {0x0CCA, 0x0CCD, 1}, {0x0CD5, 0x0CD6, 1}, {0x0CDD, 0x0CDE, 1}, {0x0CE0, 0x0CE3, 1},
+  {0x0CF1, 0x0CF2, 1}, {0x0D00, 0x0D0C, 1}, {0x0D0E, 0x0D10, 1}, {0x0D12, 0x0D44, 1},
+  {0x0D46, 0x0D48, 1}, {0x0D4A, 0x0D4E, 1}, {0x0D54, 0x0D57, 1}, {0x0D5F, 0x0D63, 1},
+  {0x0D7A, 0x0D7F, 1}, {0x0D81, 0x0D83, 1}, {0x0D85, 0x0D96, 1}, {0x0D9A, 0x0DB1, 1},
+  {0x0DB3, 0x0DBB, 1}, {0x0DBD, 0x0DBD, 1}, {0x0DC0, 0x0DC6, 1}, {0x0DCA, 0x0DCA, 1},
+  {0x0DCF, 0x0DD4, 1}, {0x0DD6, 0x0DD6, 1}, {0x0DD8, 0x0DDF, 1}, {0x0DF2, 0x0DF3, 1},
+  {0x0E01, 0x0E3A, 1}, {0x0E40, 0x0E4E, 1}, {0x0E81, 0x0E82, 1}, {0x0E84, 0x0E84, 1},
+  {0x0E86, 0x0E8A, 1}, {0x0E8C, 0x0EA3, 1}, {0x0EA5, 0x0EA5, 1}, {0x0EA7, 0x0EBD, 1},
+  {0x0EC0, 0x0EC4, 1}, {0x0EC6, 0x0EC6, 1}, {0x0EC8, 0x0ECD, 1}, {0x0EDC, 0x0EDF, 1},
+  {0x0F00, 0x0F00, 1}, {0x0F18, 0x0F19, 1}, {0x0F35, 0x0F35, 1}, {0x0F37, 0x0F37, 1},
+  {0x0F39, 0x0F39, 1}, {0x0F3E, 0x0F47, 1}, {0x0F49, 0x0F6C, 1}, {0x0F71, 0x0F84, 1},
+  {0x0F86, 0x0F97, 1}, {0x0F99, 0x0FBC, 1}, {0x0FC6, 0x0FC6, 1}, {0x1000, 0x103F, 1},
+  {0x1050, 0x108F, 1}, {0x109A, 0x109D, 1}, {0x10A0, 0x10C5, 1}, {0x10C7, 0x10C7, 1},
+  {0x10CD, 0x10CD, 1}, {0x10D0, 0x10FA, 1}, {0x10FC, 0x1248, 1}, {0x124A, 0x124D, 1},
+  {0x1250, 0x1256, 1}, {0x1258, 0x1258, 1}, {0x125A, 0x125D, 1}, {0x1260, 0x1288, 1},
+  {0x128A, 0x128D, 1}, {0x1290, 0x12B0, 1}, {0x12B2, 0x12B5, 1}, {0x12B8, 0x12BE, 1},
+  {0x12C0, 0x12C0, 1}, {0x12C2, 0x12C5, 1}, {0x12C8, 0x12D6, 1}, {0x12D8, 0x1310, 1},
+  {0x1312, 0x1315, 1}, {0x1318, 0x135A, 1}, {0x135D, 0x135F, 1}, {0x1380, 0x138F, 1},
+  {0x13A0, 0x13F5, 1}, {0x13F8, 0x13FD, 1}, {0x1401, 0x166C, 1}, {0x166F, 0x167F, 1},
+  {0x1681, 0x169A, 1}, {0x16A0, 0x16EA, 1}, {0x16F1, 0x16F8, 1}, {0x1700, 0x1715, 1},
+  {0x171F, 0x1734, 1}, {0x1740, 0x1753, 1}, {0x1760, 0x176C, 1}, {0x176E, 0x1770, 1},
+  {0x1772, 0x1773, 1}, {0x1780, 0x17D3, 1}, {0x17D7, 0x17D7, 1}, {0x17DC, 0x17DD, 1},
+  {0x180B, 0x180D, 1}, {0x180F, 0x180F, 1}, {0x1820, 0x1878, 1}, {0x1880, 0x18AA, 1},
+  {0x18B0, 0x18F5, 1}, {0x1900, 0x191E, 1}, {0x1920, 0x192B, 1}, {0x1930, 0x193B, 1},
+  {0x1950, 0x196D, 1}, {0x1970, 0x1974, 1}, {0x1980, 0x19AB, 1}, {0x19B0, 0x19C9, 1},
+  {0x1A00, 0x1A1B, 1}, {0x1A20, 0x1A5E, 1}, {0x1A60, 0x1A7C, 1}, {0x1A7F, 0x1A7F, 1},
+  {0x1AA7, 0x1AA7, 1}, {0x1AB0, 0x1ACE, 1}, {0x1B00, 0x1B4C, 1}, {0x1B6B, 0x1B73, 1},
+  {0x1B80, 0x1BAF, 1}, {0x1BBA, 0x1BF3, 1}, {0x1C00, 0x1C37, 1}, {0x1C4D, 0x1C4F, 1},
+  {0x1C5A, 0x1C7D, 1}, {0x1C80, 0x1C88, 1}, {0x1C90, 0x1CBA, 1}, {0x1CBD, 0x1CBF, 1},
+  {0x1CD0, 0x1CD2, 1}, {0x1CD4, 0x1CFA, 1}, {0x1D00, 0x1F15, 1}, {0x1F18, 0x1F1D, 1},
+  {0x1F20, 0x1F45, 1}, {0x1F48, 0x1F4D, 1}, {0x1F50, 0x1F57, 1}, {0x1F59, 0x1F59, 1},
+  {0x1F5B, 0x1F5B, 1}, {0x1F5D, 0x1F5D, 1}, {0x1F5F, 0x1F7D, 1}, {0x1F80, 0x1FB4, 1},
+  {0x1FB6, 0x1FBC, 1}, {0x1FBE, 0x1FBE, 1}, {0x1FC2, 0x1FC4, 1}, {0x1FC6, 0x1FCC, 1},
+  {0x1FD0, 0x1FD3, 1}, {0x1FD6, 0x1FDB, 1}, {0x1FE0, 0x1FEC, 1}, {0x1FF2, 0x1FF4, 1},
+  {0x1FF6, 0x1FFC, 1}, {0x2071, 0x2071, 1}, {0x207F, 0x207F, 1}, {0x2090, 0x209C, 1},
+  {0x20D0, 0x20F0, 1}, {0x2102, 0x2102, 1}, {0x2107, 0x2107, 1}, {0x210A, 0x2113, 1},
+  {0x2115, 0x2115, 1}, {0x2119, 0x211D, 1}, {0x2124, 0x2124, 1}, {0x2126, 0x2126, 1},
+  {0x2128, 0x2128, 1}, {0x212A, 0x212D, 1}, {0x212F, 0x2139, 1}, {0x213C, 0x213F, 1},
+  {0x2145, 0x2149, 1}, {0x214E, 0x214E, 1}, {0x2183, 0x2184, 1}, {0x2C00, 0x2CE4, 1},
+  {0x2CEB, 0x2CF3, 1}, {0x2D00, 0x2D25, 1}, {0x2D27, 0x2D27, 1}, {0x2D2D, 0x2D2D, 1},
+  {0x2D30, 0x2D67, 1}, {0x2D6F, 0x2D6F, 1}, {0x2D7F, 0x2D96, 1}, {0x2DA0, 0x2DA6, 1},
+  {0x2DA8, 0x2DAE, 1}, {0x2DB0, 0x2DB6, 1}, {0x2DB8, 0x2DBE, 1}, {0x2DC0, 0x2DC6, 1},
+  {0x2DC8, 0x2DCE, 1}, {0x2DD0, 0x2DD6, 1}, {0x2DD8, 0x2DDE, 1}, {0x2DE0, 0x2DFF, 1},
+  {0x2E2F, 0x2E2F, 1}, {0x3005, 0x3006, 1}, {0x302A, 0x302F, 1}, {0x3031, 0x3035, 1},
+  {0x303B, 0x303C, 1}, {0x3041, 0x3096, 1}, {0x3099, 0x309A, 1}, {0x309D, 0x309F, 1},
+  {0x30A1, 0x30FA, 1}, {0x30FC, 0x30FF, 1}, {0x3105, 0x312F, 1}, {0x3131, 0x318E, 1},
+  {0x31A0, 0x31BF, 1}, {0x31F0, 0x31FF, 1}, {0x3400, 0x4DBF, 1}, {0x4E00, 0xA48C, 1},
+  {0xA4D0, 0xA4FD, 1}, {0xA500, 0xA60C, 1}, {0xA610, 0xA61F, 1}, {0xA62A, 0xA62B, 1},
+  {0xA640, 0xA672, 1}, {0xA674, 0xA67D, 1}, {0xA67F, 0xA6E5, 1}, {0xA6F0, 0xA6F1, 1},
+  {0xA717, 0xA71F, 1}, {0xA722, 0xA788, 1}, {0xA78B, 0xA7CA, 1}, {0xA7D0, 0xA7D1, 1},
+  {0xA7D3, 0xA7D3, 1}, {0xA7D5, 0xA7D9, 1}, {0xA7F2, 0xA827, 1}, {0xA82C, 0xA82C, 1},
+  {0xA840, 0xA873, 1}, {0xA880, 0xA8C5, 1}, {0xA8E0, 0xA8F7, 1}, {0xA8FB, 0xA8FB, 1},
+  {0xA8FD, 0xA8FF, 1}, {0xA90A, 0xA92D, 1}, {0xA930, 0xA953, 1}, {0xA960, 0xA97C, 1},
+  {0xA980, 0xA9C0, 1}, {0xA9CF, 0xA9CF, 1}, {0xA9E0, 0xA9EF, 1}, {0xA9FA, 0xA9FE, 1},
+  {0xAA00, 0xAA36, 1}, {0xAA40, 0xAA4D, 1}, {0xAA60, 0xAA76, 1}, {0xAA7A, 0xAAC2, 1},
+  {0xAADB, 0xAADD, 1}, {0xAAE0, 0xAAEF, 1}, {0xAAF2, 0xAAF6, 1}, {0xAB01, 0xAB06, 1},
+  {0xAB09, 0xAB0E, 1}, {0xAB11, 0xAB16, 1}, {0xAB20, 0xAB26, 1}, {0xAB28, 0xAB2E, 1},
+  {0xAB30, 0xAB5A, 1}, {0xAB5C, 0xAB69, 1}, {0xAB70, 0xABEA, 1}, {0xABEC, 0xABED, 1},
+  {0xAC00, 0xD7A3, 1}, {0xD7B0, 0xD7C6, 1}, {0xD7CB, 0xD7FB, 1}, {0xF900, 0xFA6D, 1},
+  {0xFA70, 0xFAD9, 1}, {0xFB00, 0xFB06, 1}, {0xFB13, 0xFB17, 1}, {0xFB1D, 0xFB28, 1},
+  {0xFB2A, 0xFB36, 1}, {0xFB38, 0xFB3C, 1}, {0xFB3E, 0xFB3E, 1}, {0xFB40, 0xFB41, 1},
+  {0xFB43, 0xFB44, 1}, {0xFB46, 0xFBB1, 1}, {0xFBD3, 0xFD3D, 1}, {0xFD50, 0xFD8F, 1},
+  {0xFD92, 0xFDC7, 1}, {0xFDF0, 0xFDFB, 1}, {0xFE00, 0xFE0F, 1}, {0xFE20, 0xFE2F, 1},
+  {0xFE70, 0xFE74, 1}, {0xFE76, 0xFEFC, 1}, {0xFF21, 0xFF3A, 1}, {0xFF41, 0xFF5A, 1},
+  {0xFF66, 0xFFBE, 1}, {0xFFC2, 0xFFC7, 1}, {0xFFCA, 0xFFCF, 1}, {0xFFD2, 0xFFD7, 1},
+  {0xFFDA, 0xFFDC, 1}, {0x10000, 0x1000B, 1}, {0x1000D, 0x10026, 1}, {0x10028, 0x1003A, 1},
+  {0x1003C, 0x1003D, 1}, {0x1003F, 0x1004D, 1}, {0x10050, 0x1005D, 1}, {0x10080, 0x100FA, 1},
+  {0x101FD, 0x101FD, 1}, {0x10280, 0x1029C, 1}, {0x102A0, 0x102D0, 1}, {0x102E0, 0x102E0, 1},
+  {0x10300, 0x1031F, 1}, {0x1032D, 0x10340, 1}, {0x10342, 0x10349, 1}, {0x10350, 0x1037A, 1},
+  {0x10380, 0x1039D, 1}, {0x103A0, 0x103C3, 1}, {0x103C8, 0x103CF, 1}, {0x10400, 0x1049D, 1},
+  {0x104B0, 0x104D3, 1}, {0x104D8, 0x104FB, 1}, {0x10500, 0x10527, 1}, {0x10530, 0x10563, 1},
+  {0x10570, 0x1057A, 1}, {0x1057C, 0x1058A, 1}, {0x1058C, 0x10592, 1}, {0x10594, 0x10595, 1},
+  {0x10597, 0x105A1, 1}, {0x105A3, 0x105B1, 1}, {0x105B3, 0x105B9, 1}, {0x105BB, 0x105BC, 1},
+  {0x10600, 0x10736, 1}, {0x10740, 0x10755, 1}, {0x10760, 0x10767, 1}, {0x10780, 0x10785, 1},
+  {0x10787, 0x107B0, 1}, {0x107B2, 0x107BA, 1}, {0x10800, 0x10805, 1}, {0x10808, 0x10808, 1},
+  {0x1080A, 0x10835, 1}, {0x10837, 0x10838, 1}, {0x1083C, 0x1083C, 1}, {0x1083F, 0x10855, 1},
+  {0x10860, 0x10876, 1}, {0x10880, 0x1089E, 1}, {0x108E0, 0x108F2, 1}, {0x108F4, 0x108F5, 1},
+  {0x10900, 0x10915, 1}, {0x10920, 0x10939, 1}, {0x10980, 0x109B7, 1}, {0x109BE, 0x109BF, 1},
+  {0x10A00, 0x10A03, 1}, {0x10A05, 0x10A06, 1}, {0x10A0C, 0x10A13, 1}, {0x10A15, 0x10A17, 1},
+  {0x10A19, 0x10A35, 1}, {0x10A38, 0x10A3A, 1}, {0x10A3F, 0x10A3F, 1}, {0x10A60, 0x10A7C, 1},
+  {0x10A80, 0x10A9C, 1}, {0x10AC0, 0x10AC7, 1}, {0x10AC9, 0x10AE6, 1}, {0x10B00, 0x10B35, 1},
+  {0x10B40, 0x10B55, 1}, {0x10B60, 0x10B72, 1}, {0x10B80, 0x10B91, 1}, {0x10C00, 0x10C48, 1},
+  {0x10C80, 0x10CB2, 1}, {0x10CC0, 0x10CF2, 1}, {0x10D00, 0x10D27, 1}, {0x10E80, 0x10EA9, 1},
+  {0x10EAB, 0x10EAC, 1}, {0x10EB0, 0x10EB1, 1}, {0x10F00, 0x10F1C, 1}, {0x10F27, 0x10F27, 1},
+  {0x10F30, 0x10F50, 1}, {0x10F70, 0x10F85, 1}, {0x10FB0, 0x10FC4, 1}, {0x10FE0, 0x10FF6, 1},
+  {0x11000, 0x11046, 1}, {0x11070, 0x11075, 1}, {0x1107F, 0x110BA, 1}, {0x110C2, 0x110C2, 1},
+  {0x110D0, 0x110E8, 1}, {0x11100, 0x11134, 1}, {0x11144, 0x11147, 1}, {0x11150, 0x11173, 1},
+  {0x11176, 0x11176, 1}, {0x11180, 0x111C4, 1}, {0x111C9, 0x111CC, 1}, {0x111CE, 0x111CF, 1},
+  {0x111DA, 0x111DA, 1}, {0x111DC, 0x111DC, 1}, {0x11200, 0x11211, 1}, {0x11213, 0x11237, 1},
+  {0x1123E, 0x1123E, 1}, {0x11280, 0x11286, 1}, {0x11288, 0x11288, 1}, {0x1128A, 0x1128D, 1},
+  {0x1128F, 0x1129D, 1}, {0x1129F, 0x112A8, 1}, {0x112B0, 0x112EA, 1}, {0x11300, 0x11303, 1},
+  {0x11305, 0x1130C, 1}, {0x1130F, 0x11310, 1}, {0x11313, 0x11328, 1}, {0x1132A, 0x11330, 1},
+  {0x11332, 0x11333, 1}, {0x11335, 0x11339, 1}, {0x1133B, 0x11344, 1}, {0x11347, 0x11348, 1},
+  {0x1134B, 0x1134D, 1}, {0x11350, 0x11350, 1}, {0x11357, 0x11357, 1}, {0x1135D, 0x11363, 1},
+  {0x11366, 0x1136C, 1}, {0x11370, 0x11374, 1}, {0x11400, 0x1144A, 1}, {0x1145E, 0x11461, 1},
+  {0x11480, 0x114C5, 1}, {0x114C7, 0x114C7, 1}, {0x11580, 0x115B5, 1}, {0x115B8, 0x115C0, 1},
+  {0x115D8, 0x115DD, 1}, {0x11600, 0x11640, 1}, {0x11644, 0x11644, 1}, {0x11680, 0x116B8, 1},
+  {0x11700, 0x1171A, 1}, {0x1171D, 0x1172B, 1}, {0x11740, 0x11746, 1}, {0x11800, 0x1183A, 1},
+  {0x118A0, 0x118DF, 1}, {0x118FF, 0x11906, 1}, {0x11909, 0x11909, 1}, {0x1190C, 0x11913, 1},
+  {0x11915, 0x11916, 1}, {0x11918, 0x11935, 1}, {0x11937, 0x11938, 1}, {0x1193B, 0x11943, 1},
+  {0x119A0, 0x119A7, 1}, {0x119AA, 0x119D7, 1}, {0x119DA, 0x119E1, 1}, {0x119E3, 0x119E4, 1},
+  {0x11A00, 0x11A3E, 1}, {0x11A47, 0x11A47, 1}, {0x11A50, 0x11A99, 1}, {0x11A9D, 0x11A9D, 1},
+  {0x11AB0, 0x11AF8, 1}, {0x11C00, 0x11C08, 1}, {0x11C0A, 0x11C36, 1}, {0x11C38, 0x11C40, 1},
+  {0x11C72, 0x11C8F, 1}, {0x11C92, 0x11CA7, 1}, {0x11CA9, 0x11CB6, 1}, {0x11D00, 0x11D06, 1},
+  {0x11D08, 0x11D09, 1}, {0x11D0B, 0x11D36, 1}, {0x11D3A, 0x11D3A, 1}, {0x11D3C, 0x11D3D, 1},
+  {0x11D3F, 0x11D47, 1}, {0x11D60, 0x11D65, 1}, {0x11D67, 0x11D68, 1}, {0x11D6A, 0x11D8E, 1},
+  {0x11D90, 0x11D91, 1}, {0x11D93, 0x11D98, 1}, {0x11EE0, 0x11EF6, 1}, {0x11FB0, 0x11FB0, 1},
+  {0x12000, 0x12399, 1}, {0x12480, 0x12543, 1}, {0x12F90, 0x12FF0, 1}, {0x13000, 0x1342E, 1},
+  {0x14400, 0x14646, 1}, {0x16800, 0x16A38, 1}, {0x16A40, 0x16A5E, 1}, {0x16A70, 0x16ABE, 1},
+  {0x16AD0, 0x16AED, 1}, {0x16AF0, 0x16AF4, 1}, {0x16B00, 0x16B36, 1}, {0x16B40, 0x16B43, 1},
+  {0x16B63, 0x16B77, 1}, {0x16B7D, 0x16B8F, 1}, {0x16E40, 0x16E7F, 1}, {0x16F00, 0x16F4A, 1},
+  {0x16F4F, 0x16F87, 1}, {0x16F8F, 0x16F9F, 1}, {0x16FE0, 0x16FE1, 1}, {0x16FE3, 0x16FE4, 1},
+  {0x16FF0, 0x16FF1, 1}, {0x17000, 0x187F7, 1}, {0x18800, 0x18CD5, 1}, {0x18D00, 0x18D08, 1},
+  {0x1AFF0, 0x1AFF3, 1}, {0x1AFF5, 0x1AFFB, 1}, {0x1AFFD, 0x1AFFE, 1}, {0x1B000, 0x1B122, 1},
+  {0x1B150, 0x1B152, 1}, {0x1B164, 0x1B167, 1}, {0x1B170, 0x1B2FB, 1}, {0x1BC00, 0x1BC6A, 1},
+  {0x1BC70, 0x1BC7C, 1}, {0x1BC80, 0x1BC88, 1}, {0x1BC90, 0x1BC99, 1}, {0x1BC9D, 0x1BC9E, 1},
+  {0x1CF00, 0x1CF2D, 1}, {0x1CF30, 0x1CF46, 1}, {0x1D165, 0x1D169, 1}, {0x1D16D, 0x1D172, 1},
+  {0x1D17B, 0x1D182, 1}, {0x1D185, 0x1D18B, 1}, {0x1D1AA, 0x1D1AD, 1}, {0x1D242, 0x1D244, 1},
+  {0x1D400, 0x1D454, 1}, {0x1D456, 0x1D49C, 1}, {0x1D49E, 0x1D49F, 1}, {0x1D4A2, 0x1D4A2, 1},
+  {0x1D4A5, 0x1D4A6, 1}, {0x1D4A9, 0x1D4AC, 1}, {0x1D4AE, 0x1D4B9, 1}, {0x1D4BB, 0x1D4BB, 1},
+  {0x1D4BD, 0x1D4C3, 1}, {0x1D4C5, 0x1D505, 1}, {0x1D507, 0x1D50A, 1}, {0x1D50D, 0x1D514, 1},
+  {0x1D516, 0x1D51C, 1}, {0x1D51E, 0x1D539, 1}, {0x1D53B, 0x1D53E, 1}, {0x1D540, 0x1D544, 1},
+  {0x1D546, 0x1D546, 1}, {0x1D54A, 0x1D550, 1}, {0x1D552, 0x1D6A5, 1}, {0x1D6A8, 0x1D6C0, 1},
+  {0x1D6C2, 0x1D6DA, 1}, {0x1D6DC, 0x1D6FA, 1}, {0x1D6FC, 0x1D714, 1}, {0x1D716, 0x1D734, 1},
+  {0x1D736, 0x1D74E, 1}, {0x1D750, 0x1D76E, 1}, {0x1D770, 0x1D788, 1}, {0x1D78A, 0x1D7A8, 1},
+  {0x1D7AA, 0x1D7C2, 1}, {0x1D7C4, 0x1D7CB, 1}, {0x1DA00, 0x1DA36, 1}, {0x1DA3B, 0x1DA6C, 1},
+  {0x1DA75, 0x1DA75, 1}, {0x1DA84, 0x1DA84, 1}, {0x1DA9B, 0x1DA9F, 1}, {0x1DAA1, 0x1DAAF, 1},
+  {0x1DF00, 0x1DF1E, 1}, {0x1E000, 0x1E006, 1}, {0x1E008, 0x1E018, 1}, {0x1E01B, 0x1E021, 1},
+  {0x1E023, 0x1E024, 1}, {0x1E026, 0x1E02A, 1}, {0x1E100, 0x1E12C, 1}, {0x1E130, 0x1E13D, 1},
+  {0x1E14E, 0x1E14E, 1}, {0x1E290, 0x1E2AE, 1}, {0x1E2C0, 0x1E2EF, 1}, {0x1E7E0, 0x1E7E6, 1},
+  {0x1E7E8, 0x1E7EB, 1}, {0x1E7ED, 0x1E7EE, 1}, {0x1E7F0, 0x1E7FE, 1}, {0x1E800, 0x1E8C4, 1},
+  {0x1E8D0, 0x1E8D6, 1}, {0x1E900, 0x1E94B, 1}, {0x1EE00, 0x1EE03, 1}, {0x1EE05, 0x1EE1F, 1},
+  {0x1EE21, 0x1EE22, 1}, {0x1EE24, 0x1EE24, 1}, {0x1EE27, 0x1EE27, 1}, {0x1EE29, 0x1EE32, 1},
+  {0x1EE34, 0x1EE37, 1}, {0x1EE39, 0x1EE39, 1}, {0x1EE3B, 0x1EE3B, 1}, {0x1EE42, 0x1EE42, 1},
+  {0x1EE47, 0x1EE47, 1}, {0x1EE49, 0x1EE49, 1}, {0x1EE4B, 0x1EE4B, 1}, {0x1EE4D, 0x1EE4F, 1},
+  {0x1EE51, 0x1EE52, 1}, {0x1EE54, 0x1EE54, 1}, {0x1EE57, 0x1EE57, 1}, {0x1EE59, 0x1EE59, 1},
+  {0x1EE5B, 0x1EE5B, 1}, {0x1EE5D, 0x1EE5D, 1}, {0x1EE5F, 0x1EE5F, 1}, {0x1EE61, 0x1EE62, 1},
+  {0x1EE64, 0x1EE64, 1}, {0x1EE67, 0x1EE6A, 1}, {0x1EE6C, 0x1EE72, 1}, {0x1EE74, 0x1EE77, 1},
+  {0x1EE79, 0x1EE7C, 1}, {0x1EE7E, 0x1EE7E, 1}, {0x1EE80, 0x1EE89, 1}, {0x1EE8B, 0x1EE9B, 1},
+  {0x1EEA1, 0x1EEA3, 1}, {0x1EEA5, 0x1EEA9, 1}, {0x1EEAB, 0x1EEBB, 1}, {0x20000, 0x2A6DF, 1},
+  {0x2A700, 0x2B738, 1}, {0x2B740, 0x2B81D, 1}, {0x2B820, 0x2CEA1, 1}, {0x2CEB0, 0x2EBE0, 1},
+  {0x2F800, 0x2FA1D, 1}, {0x30000, 0x3134A, 1}, {0xE0100, 0xE01EF, 1},
+};
+
+// Simple (one code point to one) lowercase mappings: every stride-th code point in
+// first..last maps to cp + delta. Same source as above; mappings to several code
+// points (U+0130) are left out, as SQLite's unicode folding leaves them.
+struct Mapping {
+  char32_t first;
+  char32_t last;
+  unsigned char stride;
+  int delta;
+};
+
+const Mapping kLower[] = {
+  {0x00C0, 0x00D6, 1, 32}, {0x00D8, 0x00DE, 1, 32}, {0x0100, 0x012E, 2, 1}, {0x0132, 0x0136, 2, 1},
+  {0x0139, 0x0147, 2, 1}, {0x014A, 0x0176, 2, 1}, {0x0178, 0x0178, 1, -121}, {0x0179, 0x017D, 2, 1},
+  {0x0181, 0x0181, 1, 210}, {0x0182, 0x0184, 2, 1}, {0x0186, 0x0186, 1, 206}, {0x0187, 0x0187, 1, 1},
+  {0x0189, 0x018A, 1, 205}, {0x018B, 0x018B, 1, 1}, {0x018E, 0x018E, 1, 79}, {0x018F, 0x018F, 1, 202},
+  {0x0190, 0x0190, 1, 203}, {0x0191, 0x0191, 1, 1}, {0x0193, 0x0193, 1, 205}, {0x0194, 0x0194, 1, 207},
+  {0x0196, 0x0196, 1, 211}, {0x0197, 0x0197, 1, 209}, {0x0198, 0x0198, 1, 1}, {0x019C, 0x019C, 1, 211},
+  {0x019D, 0x019D, 1, 213}, {0x019F, 0x019F, 1, 214}, {0x01A0, 0x01A4, 2, 1}, {0x01A6, 0x01A6, 1, 218},
+  {0x01A7, 0x01A7, 1, 1}, {0x01A9, 0x01A9, 1, 218}, {0x01AC, 0x01AC, 1, 1}, {0x01AE, 0x01AE, 1, 218},
+  {0x01AF, 0x01AF, 1, 1}, {0x01B1, 0x01B2, 1, 217}, {0x01B3, 0x01B5, 2, 1}, {0x01B7, 0x01B7, 1, 219},
+  {0x01B8, 0x01B8, 1, 1}, {0x01BC, 0x01BC, 1, 1}, {0x01C4, 0x01C4, 1, 2}, {0x01C5, 0x01C5, 1, 1},
+  {0x01C7, 0x01C7, 1, 2}, {0x01C8, 0x01C8, 1, 1}, {0x01CA, 0x01CA, 1, 2}, {0x01CB, 0x01DB, 2, 1},
+  {0x01DE, 0x01EE, 2, 1}, {0x01F1, 0x01F1, 1, 2}, {0x01F2, 0x01F4, 2, 1}, {0x01F6, 0x01F6, 1, -97},
+  {0x01F7, 0x01F7, 1, -56}, {0x01F8, 0x021E, 2, 1}, {0x0220, 0x0220, 1, -130}, {0x0222, 0x0232, 2, 1},
+  {0x023A, 0x023A, 1, 10795}, {0x023B, 0x023B, 1, 1}, {0x023D, 0x023D, 1, -163}, {0x023E, 0x023E, 1, 10792},
+  {0x0241, 0x0241, 1, 1}, {0x0243, 0x0243, 1, -195}, {0x0244, 0x0244, 1, 69}, {0x0245, 0x0245, 1, 71},
+  {0x0246, 0x024E, 2, 1}, {0x0370, 0x0372, 2, 1}, {0x0376, 0x0376, 1, 1}, {0x037F, 0x037F, 1, 116},
+  {0x0386, 0x0386, 1, 38}, {0x0388, 0x038A, 1, 37}, {0x038C, 0x038C, 1, 64}, {0x038E, 0x038F, 1, 63},
+  {0x0391, 0x03A1, 1, 32}, {0x03A3, 0x03AB, 1, 32}, {0x03CF, 0x03CF, 1, 8}, {0x03D8, 0x03EE, 2, 1},
+  {0x03F4, 0x03F4, 1, -60}, {0x03F7, 0x03F7, 1, 1}, {0x03F9, 0x03F9, 1, -7}, {0x03FA, 0x03FA, 1, 1},
+  {0x03FD, 0x03FF, 1, -130}, {0x0400, 0x040F, 1, 80}, {0x0410, 0x042F, 1, 32}, {0x0460, 0x0480, 2, 1},
+  {0x048A, 0x04BE, 2, 1}, {0x04C0, 0x04C0, 1, 15}, {0x04C1, 0x04CD, 2, 1}, {0x04D0, 0x052E, 2, 1},
+  {0x0531, 0x0556, 1, 48}, {0x10A0, 0x10C5, 1, 7264}, {0x10C7, 0x10C7, 1, 7264}, {0x10CD, 0x10CD, 1, 7264},
+  {0x13A0, 0x13EF, 1, 38864}, {0x13F0, 0x13F5, 1, 8}, {0x1C90, 0x1CBA, 1, -3008}, {0x1CBD, 0x1CBF, 1, -3008},
+  {0x1E00, 0x1E94, 2, 1}, {0x1E9E, 0x1E9E, 1, -7615}, {0x1EA0, 0x1EFE, 2, 1}, {0x1F08, 0x1F0F, 1, -8},
+  {0x1F18, 0x1F1D, 1, -8}, {0x1F28, 0x1F2F, 1, -8}, {0x1F38, 0x1F3F, 1, -8}, {0x1F48, 0x1F4D, 1, -8},
+  {0x1F59, 0x1F5F, 2, -8}, {0x1F68, 0x1F6F, 1, -8}, {0x1F88, 0x1F8F, 1, -8}, {0x1F98, 0x1F9F, 1, -8},
+  {0x1FA8, 0x1FAF, 1, -8}, {0x1FB8, 0x1FB9, 1, -8}, {0x1FBA, 0x1FBB, 1, -74}, {0x1FBC, 0x1FBC, 1, -9},
+  {0x1FC8, 0x1FCB, 1, -86}, {0x1FCC, 0x1FCC, 1, -9}, {0x1FD8, 0x1FD9, 1, -8}, {0x1FDA, 0x1FDB, 1, -100},
+  {0x1FE8, 0x1FE9, 1, -8}, {0x1FEA, 0x1FEB, 1, -112}, {0x1FEC, 0x1FEC, 1, -7}, {0x1FF8, 0x1FF9, 1, -128},
+  {0x1FFA, 0x1FFB, 1, -126}, {0x1FFC, 0x1FFC, 1, -9}, {0x2126, 0x2126, 1, -7517}, {0x212A, 0x212A, 1, -8383},
+  {0x212B, 0x212B, 1, -8262}, {0x2132, 0x2132, 1, 28}, {0x2160, 0x216F, 1, 16}, {0x2183, 0x2183, 1, 1},
+  {0x24B6, 0x24CF, 1, 26}, {0x2C00, 0x2C2F, 1, 48}, {0x2C60, 0x2C60, 1, 1}, {0x2C62, 0x2C62, 1, -10743},
+  {0x2C63, 0x2C63, 1, -3814}, {0x2C64, 0x2C64, 1, -10727}, {0x2C67, 0x2C6B, 2, 1}, {0x2C6D, 0x2C6D, 1, -10780},
+  {0x2C6E, 0x2C6E, 1, -10749}, {0x2C6F, 0x2C6F, 1, -10783}, {0x2C70, 0x2C70, 1, -10782}, {0x2C72, 0x2C72, 1, 1},
+  {0x2C75, 0x2C75, 1, 1}, {0x2C7E, 0x2C7F, 1, -10815}, {0x2C80, 0x2CE2, 2, 1}, {0x2CEB, 0x2CED, 2, 1},
+  {0x2CF2, 0x2CF2, 1, 1}, {0xA640, 0xA66C, 2, 1}, {0xA680, 0xA69A, 2, 1}, {0xA722, 0xA72E, 2, 1},
+  {0xA732, 0xA76E, 2, 1}, {0xA779, 0xA77B, 2, 1}, {0xA77D, 0xA77D, 1, -35332}, {0xA77E, 0xA786, 2, 1},
+  {0xA78B, 0xA78B, 1, 1}, {0xA78D, 0xA78D, 1, -42280}, {0xA790, 0xA792, 2, 1}, {0xA796, 0xA7A8, 2, 1},
+  {0xA7AA, 0xA7AA, 1, -42308}, {0xA7AB, 0xA7AB, 1, -42319}, {0xA7AC, 0xA7AC, 1, -42315}, {0xA7AD, 0xA7AD, 1, -42305},
+  {0xA7AE, 0xA7AE, 1, -42308}, {0xA7B0, 0xA7B0, 1, -42258}, {0xA7B1, 0xA7B1, 1, -42282}, {0xA7B2, 0xA7B2, 1, -42261},
+  {0xA7B3, 0xA7B3, 1, 928}, {0xA7B4, 0xA7C2, 2, 1}, {0xA7C4, 0xA7C4, 1, -48}, {0xA7C5, 0xA7C5, 1, -42307},
+  {0xA7C6, 0xA7C6, 1, -35384}, {0xA7C7, 0xA7C9, 2, 1}, {0xA7D0, 0xA7D0, 1, 1}, {0xA7D6, 0xA7D8, 2, 1},
+  {0xA7F5, 0xA7F5, 1, 1}, {0xFF21, 0xFF3A, 1, 32}, {0x10400, 0x10427, 1, 40}, {0x104B0, 0x104D3, 1, 40},
+  {0x10570, 0x1057A, 1, 39}, {0x1057C, 0x1058A, 1, 39}, {0x1058C, 0x10592, 1, 39}, {0x10594, 0x10595, 1, 39},
+  {0x10C80, 0x10CB2, 1, 64}, {0x118A0, 0x118BF, 1, 32}, {0x16E40, 0x16E5F, 1, 32}, {0x1E900, 0x1E921, 1, 34},
+};
+
+template <std::size_t N>
+bool inTable(const Range (&table)[N], char32_t cp) {
+  auto it = std::upper_bound(std::begin(table), std::end(table), cp,
+                             [](char32_t c, const Range& r) { return c < r.first; });
+  if (it == std::begin(table)) return false;
+  --it;
+  return cp <= it->last && (cp - it->first) % it->stride == 0;
+}
+
+bool isContinuation(unsigned char c) { return (c & 0xC0) == 0x80; }
+
+void append(std::string& out, char32_t cp) {
+  if (cp < 0x80) {
+    out += char(cp);
+  } else if (cp < 0x800) {
+    out += char(0xC0 | (cp >> 6));
+    out += char(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    out += char(0xE0 | (cp >> 12));
+    out += char(0x80 | ((cp >> 6) & 0x3F));
+    out += char(0x80 | (cp & 0x3F));
+  } else {
+    out += char(0xF0 | (cp >> 18));
+    out += char(0x80 | ((cp >> 12) & 0x3F));
+    out += char(0x80 | ((cp >> 6) & 0x3F));
+    out += char(0x80 | (cp & 0x3F));
+  }
+}
+
+} // namespace
+
+std::size_t decode(std::string_view s, std::size_t i, char32_t& cp) {
+  const unsigned char c = static_cast<unsigned char>(s[i]);
+  if (c < 0x80) { cp = c; return 1; }
+
+  std::size_t len;
+  char32_t min;
+  if (c >= 0xC2 && c <= 0xDF) { len = 2; cp = c & 0x1F; min = 0x80; }
+  else if (c >= 0xE0 && c <= 0xEF) { len = 3; cp = c & 0x0F; min = 0x800; }
+  else if (c >= 0xF0 && c <= 0xF4) { len = 4; cp = c & 0x07; min = 0x10000; }
+  else { cp = 0xFFFD; return 1; }
+
+  if (s.size() - i < len) { cp = 0xFFFD; return 1; }
+  for (std::size_t k = 1; k < len; ++k) {
+    const unsigned char cc = static_cast<unsigned char>(s[i + k]);
+    if (!isContinuation(cc)) { cp = 0xFFFD; return 1; }
+    cp = (cp << 6) | (cc & 0x3F);
+  }
+  if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) { cp = 0xFFFD; return 1; }
+  return len;
+}
+
+std::size_t prevStart(std::string_view s, std::size_t i) {
+  // Back over at most three continuation bytes, then check that the sequence found
+  // really ends at i; otherwise the byte before i stands alone.
+  std::size_t j = i - 1;
+  while (j > 0 && i - j < 4 && isContinuation(static_cast<unsigned char>(s[j]))) --j;
+  char32_t cp;
+  return j + decode(s, j, cp) == i ? j : i - 1;
+}
+
+std::size_t length(std::string_view s) {
+  std::size_t n = 0;
+  for (char c : s) n += !isContinuation(static_cast<unsigned char>(c));
+  return n;
+}
+
+bool isUpper(char32_t cp) {
+  if (cp < 0x80) return cp >= 'A' && cp <= 'Z';
+  return inTable(kUpper, cp);
+}
+
+bool isAlpha(char32_t cp) {
+  if (cp < 0x80) return (cp >= 'A' && cp <= 'Z') || (cp >= 'a' && cp <= 'z');
+  return inTable(kAlpha, cp);
+}
+
+char32_t toLower(char32_t cp) {
+  if (cp < 0x80) return cp >= 'A' && cp <= 'Z' ? cp + ('a' - 'A') : cp;
+  auto it = std::upper_bound(std::begin(kLower), std::end(kLower), cp,
+                             [](char32_t c, const Mapping& m) { return c < m.first; });
+  if (it == std::begin(kLower)) return cp;
+  --it;
+  if (cp > it->last || (cp - it->first) % it->stride != 0) return cp;
+  return char32_t(std::int64_t(cp) + it->delta);
+}
+
+std::string toLower(std::string_view s) {
+  std::string out;
+  out.reserve(s.size());
+  for (std::size_t i = 0; i < s.size(); ) {
+    const unsigned char c = static_cast<unsigned char>(s[i]);
+    if (c < 0x80) {
+      out += c >= 'A' && c <= 'Z' ? char(c + ('a' - 'A')) : char(c);
+      ++i;
+      continue;
+    }
+    char32_t cp;
+    const std::size_t len = decode(s, i, cp);
+    const char32_t lower = toLower(cp);
+    // Unchanged code points (and malformed bytes) are copied as they were.
+    if (lower == cp) out.append(s, i, len);
+    else append(out, lower);
+    i += len;
+  }
+  return out;
+}
+
+} // namespace util::utf8
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace util::utf8 {
+
+// Code point starting at s[i]; returns its length in bytes. Malformed, overlong and
+// truncated sequences decode as U+FFFD with length 1, so scanning always advances.
+std::size_t decode(std::string_view s, std::size_t i, char32_t& cp);
+// Start of the code point that ends at i (i > 0).
+std::size_t prevStart(std::string_view s, std::size_t i);
+// Code points in s (continuation bytes are not counted).
+std::size_t length(std::string_view s);
+
+// Unicode 14 general categories, from compact range tables: uppercase and titlecase
+// letters (Lu, Lt), and letters plus combining marks (L*, M*). ASCII is answered
+// without a table lookup.
+bool isUpper(char32_t cp);
+bool isAlpha(char32_t cp);
+
+// Simple Unicode lowercase mapping (the folding SQLite's unicode61 and trigram
+// tokenizers apply, without diacritic removal). The string form maps each code point
+// and copies malformed bytes unchanged.
+char32_t toLower(char32_t cp);
+std::string toLower(std::string_view s);
+
+} // namespace util::utf8
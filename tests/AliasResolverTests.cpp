@@ -0,0 +1,44 @@
+#include <catch2/catch_all.hpp>
+#include "core/entities/AliasResolver.h"
+
+using core::entities::AliasResolver;
+
+TEST_CASE("AliasResolver normalizes titles, punctuation and legal forms") {
+  CHECK(AliasResolver::normalizeKey("Dr. Angela Merkel") == "angela merkel");
+  CHECK(AliasResolver::normalizeKey("Merkel's") == "merkel");
+  CHECK(AliasResolver::normalizeKey("O'Brien") == "obrien");
+  CHECK(AliasResolver::normalizeKey("Example GmbH") == "example");
+  CHECK(AliasResolver::normalizeKey("Jean-Pierre Dupont") == "jean pierre dupont");
+  CHECK(AliasResolver::normalizeKey("Inc") == "inc");
+  CHECK(AliasResolver::tokenSetSimilarity("angela merkel", "merkel angela") == 1.0);
+}
+
+TEST_CASE("AliasResolver merges surface forms into one canonical entity") {
+  AliasResolver r;
+  const auto merkel = r.add({"id-merkel", "Angela Merkel", "person", {}});
+  r.add({"id-scholz", "Olaf Scholz", "person", {}});
+
+  CHECK(r.find("Dr. Angela Merkel", "person") == std::ptrdiff_t(merkel));
+  CHECK(r.find("Merkel", "unknown") == std::ptrdiff_t(merkel));
+  CHECK(r.find("Angela Dorothea Merkel", "person") == std::ptrdiff_t(merkel));
+  CHECK(r.find("Angela Merkel", "org") == -1);
+  CHECK(r.find("Angela", "person") == -1);
+
+  CHECK(r.addAlias(merkel, "Merkel"));
+  CHECK_FALSE(r.addAlias(merkel, "Merkel"));
+  CHECK(r.entity(merkel).aliases == std::vector<std::string>{"Merkel"});
+
+  // A second Merkel makes the bare surname ambiguous.
+  r.add({"id-horst", "Horst Merkel", "person", {}});
+  CHECK(r.find("Horst Merkel", "person") != std::ptrdiff_t(merkel));
+  CHECK(r.find("Merkel", "unknown") == std::ptrdiff_t(merkel)); // now a known alias
+  CHECK(r.find("H. Merkel", "unknown") == -1);
+}
+
+TEST_CASE("AliasResolver::cluster groups names longest first") {
+  const std::vector<std::pair<std::string, std::string>> names = {
+    {"Merkel", "unknown"}, {"Example", "org"}, {"Angela Merkel", "person"},
+    {"Example GmbH", "org"}, {"Berlin", "place"}, {"ANGELA MERKEL", "person"}};
+  const auto groups = AliasResolver::cluster(names);
+  CHECK(groups == std::vector<std::size_t>{2, 1, 2, 1, 4, 2});
+}
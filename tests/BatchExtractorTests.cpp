@@ -0,0 +1,85 @@
+#include <catch2/catch_all.hpp>
+#include "core/extract/BatchExtractor.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+using core::extract::BatchDelivery;
+using core::extract::BatchExtractor;
+
+static std::vector<core::extract::BatchDocument> pages(std::size_t n) {
+  std::vector<core::extract::BatchDocument> docs;
+  for (std::size_t i = 0; i < n; ++i) {
+    docs.push_back({"<html><head><title>Page " + std::to_string(i) + "</title></head><body><p>Body " +
+                    std::to_string(i) + "</p></body></html>",
+                    "https://example.com/" + std::to_string(i)});
+  }
+  return docs;
+}
+
+TEST_CASE("BatchExtractor delivers every page, in input order when asked") {
+  core::exec::WorkStealingPool pool(4);
+  BatchExtractor batch(pool);
+  const auto docs = pages(64);
+
+  std::vector<std::size_t> order;
+  std::vector<std::string> titles(docs.size());
+  auto stats = batch.extractBatch(docs, BatchDelivery::Ordered, [&](std::size_t i, core::extract::ExtractedPage&& ep) {
+    order.push_back(i);
+    titles[i] = ep.title;
+  });
+  REQUIRE(order.size() == docs.size());
+  for (std::size_t i = 0; i < order.size(); ++i) CHECK(order[i] == i);
+  CHECK(titles[17] == "Page 17");
+  CHECK(stats.pages == 64);
+  CHECK(stats.workers == 4);
+  CHECK(BatchExtractor::formatStats(stats).rfind("64 pages, ", 0) == 0);
+
+  order.clear();
+  batch.extractBatch(docs, BatchDelivery::Unordered, [&](std::size_t i, core::extract::ExtractedPage&& ep) {
+    order.push_back(i);
+    CHECK(ep.title == "Page " + std::to_string(i));
+  });
+  std::sort(order.begin(), order.end());
+  REQUIRE(order.size() == docs.size());
+  for (std::size_t i = 0; i < order.size(); ++i) CHECK(order[i] == i);
+}
+
+TEST_CASE("BatchExtractor::fanOut holds back later items only for ordered delivery") {
+  core::exec::WorkStealingPool pool(2);
+  const std::size_t n = 8;
+
+  for (auto delivery : {BatchDelivery::Ordered, BatchDelivery::Unordered}) {
+    // Item 0 finishes last: it waits (bounded) until every other item has finished or,
+    // where nothing holds them back, been delivered.
+    std::mutex mu;
+    std::condition_variable cv;
+    std::size_t finished = 0, delivered = 0;
+    std::vector<std::size_t> order;
+    BatchExtractor::fanOut(pool, n, 0, delivery,
+      [&](std::size_t i, std::size_t) {
+        std::unique_lock<std::mutex> lk(mu);
+        if (i == 0) {
+          std::size_t& others = delivery == BatchDelivery::Ordered ? finished : delivered;
+          cv.wait_for(lk, std::chrono::seconds(5), [&] { return others == n - 1; });
+        } else {
+          ++finished;
+          cv.notify_all();
+        }
+      },
+      [&](std::size_t i) {
+        std::lock_guard<std::mutex> lk(mu);
+        order.push_back(i);
+        if (i != 0) ++delivered;
+        cv.notify_all();
+      });
+
+    REQUIRE(order.size() == n);
+    if (delivery == BatchDelivery::Ordered) {
+      for (std::size_t i = 0; i < n; ++i) CHECK(order[i] == i);
+    } else {
+      CHECK(order.back() == 0);
+    }
+  }
+}
@@ -0,0 +1,118 @@
+#include <catch2/catch_all.hpp>
+#include "core/storage/BatchWriter.h"
+#include <filesystem>
+#include <thread>
+
+using core::storage::BatchWriter;
+using core::storage::SqliteDb;
+
+static std::int64_t count(SqliteDb& db, const std::string& sql) {
+  std::int64_t n = -1;
+  for (const auto& row : db.query(sql)) n = row.int64(0);
+  return n;
+}
+
+TEST_CASE("BatchWriter commits once a batch is full") {
+  SqliteDb db;
+  REQUIRE(db.open(":memory:"));
+  REQUIRE(db.exec("CREATE TABLE t(k INTEGER PRIMARY KEY, v TEXT);"));
+
+  BatchWriter w(db, {3, std::chrono::hours(1)});
+  w.add("INSERT INTO t(k,v) VALUES(?,?);", {1, std::string("one")});
+  w.add("INSERT INTO t(k,v) VALUES(?,?);", {2, std::string("two")});
+  CHECK(count(db, "SELECT COUNT(*) FROM t;") == 0);
+  w.add("INSERT INTO t(k,v) VALUES(?,?);", {1, "dup"}); // fails alone; its batch still commits
+  for (int i = 0; i < 200 && w.rowsWritten() + w.rowsFailed() < 3; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  CHECK(count(db, "SELECT COUNT(*) FROM t;") == 2);
+  CHECK(w.rowsWritten() == 2);
+  CHECK(w.rowsFailed() == 1);
+
+  w.add("UPDATE t SET v = ? WHERE k = ?;", {"uno", 1});
+  CHECK(w.flush());
+  CHECK(count(db, "SELECT COUNT(*) FROM t WHERE v = 'uno';") == 1);
+}
+
+TEST_CASE("BatchWriter commits a partial batch after its delay") {
+  SqliteDb db;
+  REQUIRE(db.open(":memory:"));
+  REQUIRE(db.exec("CREATE TABLE t(k INTEGER);"));
+
+  BatchWriter w(db, {1000, std::chrono::milliseconds(20)});
+  w.add("INSERT INTO t(k) VALUES(?);", {42});
+  for (int i = 0; i < 200 && w.rowsWritten() == 0; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  CHECK(w.rowsWritten() == 1);
+  CHECK(count(db, "SELECT COUNT(*) FROM t;") == 1);
+}
+
+TEST_CASE("BatchWriter leaves a full batch to its thread while the caller holds a transaction") {
+  SqliteDb db;
+  REQUIRE(db.open(":memory:"));
+  REQUIRE(db.exec("CREATE TABLE t(k INTEGER);"));
+
+  BatchWriter w(db, {2, std::chrono::hours(1)});
+  {
+    core::storage::Transaction tx(db);
+    REQUIRE(db.execParams("INSERT INTO t(k) VALUES(?);", {0}));
+    w.add("INSERT INTO t(k) VALUES(?);", {1});
+    w.add("INSERT INTO t(k) VALUES(?);", {2}); // full, but not written into this transaction
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(w.rowsWritten() == 0);
+    tx.rollback();
+  }
+  for (int i = 0; i < 200 && w.rowsWritten() < 2; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  CHECK(w.rowsWritten() == 2);
+  CHECK(count(db, "SELECT group_concat(k, '') FROM (SELECT k FROM t ORDER BY k);") == 12);
+}
+
+TEST_CASE("Transaction rolls back unless committed and nests as savepoints") {
+  SqliteDb db;
+  REQUIRE(db.open(":memory:"));
+  REQUIRE(db.exec("CREATE TABLE t(k INTEGER);"));
+
+  {
+    core::storage::Transaction tx(db);
+    REQUIRE(tx.active());
+    REQUIRE(db.execParams("INSERT INTO t(k) VALUES(?);", {1}));
+  }
+  CHECK(count(db, "SELECT COUNT(*) FROM t;") == 0);
+
+  {
+    core::storage::Transaction outer(db);
+    REQUIRE(db.execParams("INSERT INTO t(k) VALUES(?);", {1}));
+    {
+      core::storage::Transaction inner(db);
+      REQUIRE(inner.active());
+      REQUIRE(db.execParams("INSERT INTO t(k) VALUES(?);", {2}));
+      inner.rollback();
+    }
+    {
+      core::storage::Transaction inner(db);
+      REQUIRE(db.execParams("INSERT INTO t(k) VALUES(?);", {3}));
+      CHECK(inner.commit());
+    }
+    // A batch inside a transaction joins it.
+    REQUIRE(db.execBatch({{"INSERT INTO t(k) VALUES(?);", {{"4"}}}}));
+    CHECK(outer.commit());
+  }
+  CHECK(count(db, "SELECT group_concat(k, '') FROM (SELECT k FROM t ORDER BY k);") == 134);
+}
+
+TEST_CASE("BatchWriter leaves a batch unwritten when it cannot begin a transaction") {
+  namespace fs = std::filesystem;
+  const fs::path path = fs::temp_directory_path() / "nova_batchwriter_test.db";
+  fs::remove(path);
+  SqliteDb db, other;
+  REQUIRE(db.open(path.string()));
+  REQUIRE(other.open(path.string()));
+  REQUIRE(db.exec("CREATE TABLE t(k INTEGER);"));
+
+  BatchWriter w(db, {1000, std::chrono::hours(1)});
+  w.add("INSERT INTO t(k) VALUES(?);", {1});
+  w.add("INSERT INTO t(k) VALUES(?);", {2});
+  REQUIRE(other.exec("BEGIN IMMEDIATE;")); // holds the write lock, so BEGIN fails
+  CHECK_FALSE(w.flush());
+  CHECK(w.rowsWritten() == 0);
+  CHECK(w.rowsFailed() == 2);
+  REQUIRE(other.exec("COMMIT;"));
+  CHECK(count(db, "SELECT COUNT(*) FROM t;") == 0);
+}
@@ -0,0 +1,51 @@
+#include <catch2/catch_all.hpp>
+#include "core/net/Charset.h"
+
+using core::net::Charset;
+using core::net::Encoding;
+
+TEST_CASE("Charset::detect follows BOM, header, meta, then content") {
+  auto cs = Charset::detect("\xEF\xBB\xBF<p>x</p>", "text/html; charset=iso-8859-1");
+  CHECK(cs.encoding == Encoding::Utf8);
+  CHECK(cs.bomLength == 3);
+
+  cs = Charset::detect("<p>x</p>", "text/html; Charset=\"ISO-8859-1\"");
+  CHECK(cs.encoding == Encoding::Windows1252);
+  CHECK(cs.label == "iso-8859-1");
+  CHECK(std::string(cs.source) == "header");
+
+  cs = Charset::detect("<!-- <meta charset=koi8-r> --><head><meta charset=\"Shift_JIS\"></head>", "text/html");
+  CHECK(cs.encoding == Encoding::Other);
+  CHECK(cs.label == "shift_jis");
+
+  cs = Charset::detect("<meta http-equiv=Content-Type content=\"text/html; charset=windows-1252\">", "");
+  CHECK(cs.encoding == Encoding::Windows1252);
+
+  cs = Charset::detect("<meta charset=utf-16>", "");
+  CHECK(cs.encoding == Encoding::Utf8);
+
+  CHECK(Charset::detect("caf\xC3\xA9", "text/html").encoding == Encoding::Utf8);
+  CHECK(Charset::detect("caf\xE9", "text/html").encoding == Encoding::Windows1252);
+}
+
+TEST_CASE("Charset validates UTF-8 and transcodes Windows-1252") {
+  const std::string ascii(37, 'a');
+  CHECK(Charset::asciiPrefix(ascii) == 37);
+  CHECK(Charset::asciiPrefix(ascii + "\xC3\xA9" + ascii) == 37);
+
+  CHECK(Charset::isValidUtf8(ascii + "\xE2\x82\xAC" + ascii));
+  CHECK_FALSE(Charset::isValidUtf8("\xC0\xAF"));         // overlong '/'
+  CHECK_FALSE(Charset::isValidUtf8("\xED\xA0\x80"));     // surrogate
+  CHECK_FALSE(Charset::isValidUtf8(ascii + "\xE2\x82")); // truncated
+
+  std::string out;
+  Charset::appendWindows1252("\x80 caf\xE9 \x93q\x94", out);
+  CHECK(out == "\xE2\x82\xAC caf\xC3\xA9 \xE2\x80\x9Cq\xE2\x80\x9D");
+
+  QByteArray body("<p>na\xEFve</p>");
+  REQUIRE(Charset::toUtf8(body, Charset::detect(body.toStdString(), "text/html")));
+  CHECK(body == QByteArray("<p>na\xC3\xAFve</p>"));
+
+  QByteArray utf8("<p>plain</p>");
+  CHECK_FALSE(Charset::toUtf8(utf8, Charset::detect(utf8.toStdString(), "text/html")));
+}
@@ -0,0 +1,33 @@
+#include <catch2/catch_all.hpp>
+#include "core/entities/Cooccurrence.h"
+
+using core::entities::CooccurrenceDelta;
+
+TEST_CASE("CooccurrenceDelta counts document and block windows") {
+  CooccurrenceDelta d;
+  d.add({{"a", {"b1", "b2", "b1"}}, {"b", {"b2"}}, {"c", {}}});
+  d.add({{"a", {"b9"}}, {"c", {"b9"}}});
+
+  CHECK(d.docs() == 2);
+  CHECK(d.blocks() == 3);
+  CHECK(d.entities().at("a").docs == 2);
+  CHECK(d.entities().at("a").blocks == 3);
+  CHECK(d.pairs().at({"a", "b"}).blocks == 1);
+  CHECK(d.pairs().at({"a", "c"}).docs == 2);
+  CHECK(d.pairs().at({"a", "c"}).blocks == 1);
+  CHECK(d.pairs().at({"b", "c"}).blocks == 0);
+
+  // Re-indexing an unchanged document leaves nothing to write.
+  CooccurrenceDelta same;
+  same.add({{"a", {"b1"}}, {"b", {"b1"}}}, -1);
+  same.add({{"b", {"b1"}}, {"a", {"b1"}}});
+  same.prune();
+  CHECK(same.empty());
+}
+
+TEST_CASE("npmi is 1 for exclusive pairs, 0 for independent ones") {
+  CHECK(core::entities::npmi(10, 10, 10, 100) == Catch::Approx(1.0));
+  CHECK(core::entities::npmi(25, 50, 50, 100) == Catch::Approx(0.0).margin(1e-12));
+  CHECK(core::entities::npmi(0, 50, 50, 100) == -1.0);
+  CHECK(core::entities::npmi(5, 10, 10, 100) > core::entities::npmi(5, 50, 50, 100));
+}
@@ -0,0 +1,68 @@
+#include <catch2/catch_all.hpp>
+#include "core/storage/Migrations.h"
+#include "services/deepsearch/DeepSearchService.h"
+
+using core::storage::Param;
+using core::storage::SqliteDb;
+using services::deepsearch::DeepSearchService;
+using services::deepsearch::EntityProfile;
+
+static std::string entityId(SqliteDb& db, const std::string& name) {
+  std::string id;
+  for (const auto& row : db.query("SELECT entity_id FROM entity_index WHERE name = ?;", {name})) id = row.text(0);
+  return id;
+}
+
+static int countRows(SqliteDb& db, const std::string& sql, std::initializer_list<Param> params = {}) {
+  int n = -1;
+  for (const auto& row : db.query(sql, params)) n = int(row.int64(0));
+  return n;
+}
+
+TEST_CASE("DeepSearchService keeps merged relation weights equal to their sources") {
+  SqliteDb db;
+  REQUIRE(db.open(":memory:"));
+  REQUIRE(core::storage::runMigrations(db));
+  DeepSearchService ds(&db);
+
+  // One page asserts the same relation for an entity and for its duplicate.
+  const EntityProfile dup{"", "Globex", "org", 1.0, {"https://example.com/p1"}, {{"Berlin", "location"}}};
+  EntityProfile canon{"", "Initech", "org", 1.0, {"https://example.com/p1"}, {{"Berlin", "location"}}};
+  REQUIRE(ds.upsertEntities({dup, canon}));
+  const std::string from = entityId(db, "Globex");
+  const std::string into = entityId(db, "Initech");
+  REQUIRE(!from.empty());
+  REQUIRE(!into.empty());
+  REQUIRE(from != into);
+
+  REQUIRE(ds.mergeEntities({{from, "Globex", into, "Initech", "org"}}) == 1);
+  CHECK(countRows(db, "SELECT COUNT(*) FROM entity_relation_sources WHERE src = ?;", {into}) == 1);
+  CHECK(countRows(db, "SELECT weight FROM entity_relations WHERE src = ?;", {into}) == 1);
+  CHECK(countRows(db, "SELECT COUNT(*) FROM entity_relations WHERE src = ? OR dst = ?;", {from, from}) == 0);
+
+  // Once the page withdraws it, nothing else asserts the relation.
+  canon.related.clear();
+  REQUIRE(ds.upsertEntities({canon}));
+  CHECK(countRows(db, "SELECT COUNT(*) FROM entity_relations;") == 0);
+}
+
+TEST_CASE("DeepSearchService builds a page profile from the mentions it is given") {
+  SqliteDb db;
+  REQUIRE(db.open(":memory:"));
+  REQUIRE(core::storage::runMigrations(db));
+  DeepSearchService ds(&db);
+
+  using core::entities::EntityType;
+  const std::vector<core::entities::EntityMention> mentions{
+    {"Globex", EntityType::Org, 0.99, {}},
+    {"Berlin", EntityType::Place, 0.8, {}},
+    {"Hank Scorpio", EntityType::Person, 0.9, {}},
+    {"Springfield", EntityType::Place, 0.3, {}},
+  };
+  const auto p = ds.buildProfileFromPage("Globex", "https://example.com/p1", mentions);
+  CHECK(p.type == "org");
+  CHECK(p.confidence == Catch::Approx(0.95));
+  CHECK(p.sources == std::vector<std::string>{"https://example.com/p1"});
+  CHECK(p.related == std::vector<std::pair<std::string, std::string>>{{"Berlin", "location"},
+                                                                     {"Hank Scorpio", "related_person"}});
+}
@@ -0,0 +1,54 @@
+#include <catch2/catch_all.hpp>
+#include "core/extract/DocumentModel.h"
+
+using core::extract::DocumentModel;
+using core::extract::LiveBlock;
+
+static std::string order(const DocumentModel& m) {
+  std::string s;
+  m.forEach([&](const LiveBlock& b) { s += std::to_string(b.id) + " "; });
+  return s;
+}
+
+TEST_CASE("DocumentModel applies snapshot and deltas in place") {
+  DocumentModel m;
+  REQUIRE(m.applySnapshot(R"({"url":"https://example.com/","title":"T","blocks":[
+    {"id":1,"tag":"h1","level":1,"text":"Top"},
+    {"id":2,"tag":"p","level":0,"text":"first paragraph"},
+    {"id":3,"tag":"h2","level":2,"text":"Sub"},
+    {"id":4,"tag":"p","level":0,"text":"second paragraph"}]})"));
+  REQUIRE(order(m) == "1 2 3 4 ");
+  const auto v = m.version();
+
+  // Text change without "before" stays put; a new block lands before its successor.
+  REQUIRE(m.applyDelta(R"({"upsert":[
+    {"id":5,"tag":"p","text":"inserted","before":3},
+    {"id":2,"tag":"p","text":"first paragraph, edited"}],"remove":[4]})"));
+  REQUIRE(order(m) == "1 2 5 3 ");
+  REQUIRE(m.find(2)->text == "first paragraph, edited");
+  REQUIRE(m.find(4) == nullptr);
+  REQUIRE(m.version() > v);
+
+  // Moved to the end.
+  REQUIRE(m.applyDelta(R"({"upsert":[{"id":1,"tag":"h1","level":1,"text":"Top","before":0}]})"));
+  REQUIRE(order(m) == "2 5 3 1 ");
+  REQUIRE_FALSE(m.applyDelta("not json"));
+}
+
+TEST_CASE("DocumentModel builds the same page shape as the extractor") {
+  DocumentModel m;
+  const std::string para = "a paragraph that is comfortably longer than forty characters";
+  REQUIRE(m.applySnapshot(R"({"url":"https://example.com/","title":"T","blocks":[
+    {"id":1,"tag":"h1","level":1,"text":"Guide"},
+    {"id":2,"tag":"p","level":0,"text":"First )" + para + R"("},
+    {"id":3,"tag":"h2","level":2,"text":"Install"},
+    {"id":4,"tag":"p","level":0,"text":"short"}]})"));
+  auto ep = m.toPage();
+  REQUIRE(ep.title == "T");
+  REQUIRE(ep.headings.size() == 2);
+  REQUIRE(ep.headings[1].parent == 0);
+  REQUIRE(ep.blocks.size() == 1);
+  REQUIRE(ep.blocks[0].section == 0);
+  REQUIRE(ep.blocks[0].id.rfind("block_", 0) == 0);
+  REQUIRE(ep.blocks[0].hash == core::extract::HtmlExtractor::blockHash("First " + para));
+}
@@ -2,9 +2,154 @@
 /* tests/EntityDetectorTests.cpp */
 #include <catch2/catch_all.hpp>
 #include "core/entities/EntityDetector.h"
+#include <algorithm>
+#include <random>
+#include <regex>
 
 TEST_CASE("EntityDetector finds capitalized sequences") {
   core::entities::EntityDetector d;
   auto ents = d.detect("Alice Wonderland met Bob Builder at Berlin City Hall. Example GmbH announced news.");
   REQUIRE(!ents.empty());
 }
+
+// The std::regex search the scanner replaced; candidates() must match it exactly.
+static std::vector<std::string> regexCandidates(const std::string& text) {
+  static const std::regex re(R"(\b([A-Z][a-zA-Z\-']+)(\s+[A-Z][a-zA-Z\-']+){0,3}\b)");
+  std::vector<std::string> out;
+  for (std::sregex_iterator it(text.begin(), text.end(), re), end; it != end; ++it) out.push_back(it->str());
+  return out;
+}
+
+static std::vector<std::string> scanCandidates(const std::string& text) {
+  std::vector<std::string> out;
+  for (auto v : core::entities::EntityDetector::candidates(text)) out.emplace_back(v);
+  return out;
+}
+
+TEST_CASE("EntityDetector::candidates matches the former regex search") {
+  const std::vector<std::string> cases = {
+    "Alice Wonderland met Bob Builder at Berlin City Hall. Example GmbH announced news.",
+    "Jean-Pierre O'Neil and Jean- Luc; X-Men A B Cd Ef Gh Ij Kl Mn",
+    "Ab'' Cd--\tEf\n\nGh_Ij Kl9 Mn Op Qr St Uv Wx",
+    "A-- B' C Cafe Zoel Abc",
+    "", "Z", "Zz", "aZz Zz", "Zz-", "Zz-Qq", "Zz Qq Rr Ss Tt Uu",
+  };
+  for (const auto& c : cases) {
+    INFO(c);
+    CHECK(scanCandidates(c) == regexCandidates(c));
+  }
+
+  std::mt19937 rng(1234);
+  const std::string alphabet = "AaBbZz  -'_9.\t\n";
+  for (int round = 0; round < 2000; ++round) {
+    std::string s(rng() % 40, ' ');
+    for (auto& ch : s) ch = alphabet[rng() % alphabet.size()];
+    INFO(s);
+    REQUIRE(scanCandidates(s) == regexCandidates(s));
+  }
+}
+
+TEST_CASE("EntityDetector::candidates handles non-ASCII letters") {
+  const std::string text = "Jürgen Müller flew to Łódź with Zoë. Αθήνα, O’Brien, caféBar Émile Zola—été Ab\xFF";
+  CHECK(scanCandidates(text) == std::vector<std::string>{"Jürgen Müller", "Łódź", "Zoë", "Αθήνα", "O’Brien", "Émile Zola", "Ab"});
+
+  core::entities::EntityDetector d;
+  const auto ents = d.detect("Prof. Jürgen Müller visited Düsseldorf. Jürgen Müller spoke.");
+  REQUIRE(!ents.empty());
+  CHECK(ents[0].name == "Jürgen Müller");
+  CHECK(ents[0].type == core::entities::EntityType::Person);
+}
+
+TEST_CASE("EntityDetector classifies two and three token names as people") {
+  core::entities::EntityDetector d;
+  auto ents = d.detect("Grace Hopper wrote code. Grace Hopper Jr visited. Grace Hopper Jr Sr left. Acme Bank Group");
+  auto type = [&](const std::string& name) {
+    for (const auto& e : ents) if (e.name == name) return e.type;
+    return core::entities::EntityType::Unknown;
+  };
+  CHECK(type("Grace Hopper") == core::entities::EntityType::Person);
+  CHECK(type("Grace Hopper Jr") == core::entities::EntityType::Person);
+  CHECK(type("Grace Hopper Jr Sr") == core::entities::EntityType::Unknown);
+  CHECK(type("Acme Bank Group") == core::entities::EntityType::Org);
+}
+
+TEST_CASE("EntityDetector keeps people whose names contain a place or org term") {
+  core::entities::EntityCounts counts;
+  for (const char* name : {"Paris Hilton", "Jack London", "Hamburg Meyer", "Acme Bank", "New York"}) {
+    counts.add(name);
+  }
+  const auto ents = core::entities::EntityDetector().rank(counts);
+  auto type = [&](const std::string& name) {
+    for (const auto& e : ents) if (e.name == name) return e.type;
+    return core::entities::EntityType::Unknown;
+  };
+  CHECK(type("Paris Hilton") == core::entities::EntityType::Person);
+  CHECK(type("Jack London") == core::entities::EntityType::Person);
+  CHECK(type("Hamburg Meyer") == core::entities::EntityType::Person);
+  CHECK(type("Acme Bank") == core::entities::EntityType::Org);
+  CHECK(type("New York") == core::entities::EntityType::Place);
+}
+
+static bool sameMentions(const std::vector<core::entities::EntityMention>& a, const std::vector<core::entities::EntityMention>& b) {
+  if (a.size() != b.size()) return false;
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    if (a[i].name != b[i].name || a[i].type != b[i].type || a[i].confidence != b[i].confidence) return false;
+  }
+  return true;
+}
+
+TEST_CASE("EntityDetector merges per-block and per-thread counts into the serial result") {
+  core::entities::EntityDetector d;
+  core::exec::WorkStealingPool pool(4);
+
+  std::string text;
+  std::mt19937 rng(99);
+  const char* words[] = {"Alice Smith", "Berlin", "Example GmbH", "the", "said", "New York City", "and\n\n", "Zed-Corp", "Jean-Pierre Dupont", "x.", "Jürgen Müller", "Łódź"};
+  while (text.size() < 300 * 1024) {
+    text += words[rng() % std::size(words)];
+    text += rng() % 7 ? " " : "\t";
+  }
+  CHECK(sameMentions(d.detectParallel(text, pool), d.detect(text)));
+
+  core::extract::ExtractedPage page;
+  for (int i = 0; i < 12; ++i) {
+    core::extract::Block b;
+    b.id = "block_" + std::to_string(i);
+    b.text = text.substr(i * 20000, 20000);
+    page.fullText += "[" + b.id + "] " + b.text + "\n\n";
+    page.blocks.push_back(std::move(b));
+  }
+  const auto perBlock = d.detectPage(page, pool);
+  CHECK(sameMentions(perBlock, d.detect(page.fullText)));
+
+  core::extract::ExtractedPage second;
+  second.blocks.push_back({"block_x", "Grace Hopper met Grace Hopper at Example GmbH.", 0, -1, 0, 0});
+  core::entities::EntityCounts total;
+  const auto batch = d.detectPages({&page, &second}, &total, pool);
+  REQUIRE(batch.size() == 2);
+  CHECK(sameMentions(batch[0], perBlock));
+  CHECK(sameMentions(batch[1], d.detectPage(second, pool)));
+
+  core::entities::EntityCounts expected;
+  for (const auto* p : {&page, &second}) {
+    for (const auto& b : p->blocks) core::entities::EntityDetector::count(b.text, expected);
+  }
+  CHECK(total.counts() == expected.counts());
+  CHECK(total.counts().at("Grace Hopper") == 2);
+}
+
+TEST_CASE("EntityDetector records byte offsets of mentions per block") {
+  core::entities::EntityDetector d;
+  core::extract::ExtractedPage page;
+  page.blocks.push_back({"block_0", "Intro text. Grace Hopper wrote code.", 0, -1, 0, 0});
+  page.blocks.push_back({"block_1", "Later, Grace Hopper retired.", 0, -1, 0, 0});
+
+  const auto ents = d.detectPage(page);
+  const auto it = std::find_if(ents.begin(), ents.end(), [](const auto& m) { return m.name == "Grace Hopper"; });
+  REQUIRE(it != ents.end());
+  REQUIRE(it->spans.size() == 2);
+  for (const auto& s : it->spans) {
+    const auto& block = s.blockId == "block_0" ? page.blocks[0] : page.blocks[1];
+    CHECK(block.text.substr(s.begin, s.end - s.begin) == "Grace Hopper");
+  }
+}
@@ -0,0 +1,63 @@
+#include <catch2/catch_all.hpp>
+#include "core/entities/EntityGraph.h"
+
+using core::entities::EntityGraph;
+
+TEST_CASE("EntityGraph answers k-hop and shortest-path queries over CSR and delta edges") {
+  EntityGraph g;
+  const auto rel = g.internRelation("related");
+  std::vector<std::uint32_t> n;
+  for (const char* id : {"a", "b", "c", "d", "e", "f"}) n.push_back(g.intern(id));
+  g.build({{n[0], n[1], 1, rel}, {n[1], n[2], 1, rel}, {n[2], n[3], 1, rel}, {n[0], n[1], 1, rel}});
+  CHECK(g.edgeCount() == 6); // the repeated a-b edge merged
+
+  g.addEdge(n[3], n[4], 1, rel); // delta only
+  CHECK(g.shortestPath(n[0], n[4]) == std::vector<std::uint32_t>{n[0], n[1], n[2], n[3], n[4]});
+  CHECK(g.shortestPath(n[0], n[4], 3).empty());
+  CHECK(g.shortestPath(n[0], n[5]).empty());
+
+  const auto hop2 = g.kHop(n[1], 2, 100);
+  CHECK(hop2 == std::vector<std::pair<std::uint32_t, int>>{{n[1], 0}, {n[0], 1}, {n[2], 1}, {n[3], 2}});
+
+  g.compact();
+  CHECK(g.edgeCount() == 8);
+  CHECK(g.kHop(n[4], 1, 100).size() == 2);
+  CHECK(g.find("zz") == EntityGraph::kNone);
+
+  g.removeEdge(n[0], n[1], 1, rel); // a-b had weight 2
+  CHECK(g.edgeCount() == 8);
+  g.removeEdge(n[1], n[0], 1, rel);
+  CHECK(g.edgeCount() == 6);
+  CHECK(g.shortestPath(n[0], n[4]).empty());
+
+  // Removal spans CSR and delta weight, never goes below zero, and survives compact().
+  g.addEdge(n[4], n[5], 1, rel);
+  g.addEdge(n[3], n[4], 1, rel); // d-e now 1 in CSR plus 1 in delta
+  g.removeEdge(n[4], n[5], 5, rel);
+  g.removeEdge(n[4], n[3], 2, rel);
+  CHECK(g.edgeCount() == 4);
+  CHECK(g.kHop(n[4], 1, 100).size() == 1);
+  g.removeEdge(n[0], n[5], 1, rel); // no such edge
+  g.compact();
+  CHECK(g.edgeCount() == 4);
+  CHECK(g.shortestPath(n[1], n[3]) == std::vector<std::uint32_t>{n[1], n[2], n[3]});
+}
+
+TEST_CASE("EntityGraph personalized PageRank favours the seed's neighbourhood") {
+  EntityGraph g;
+  const auto rel = g.internRelation("related");
+  std::vector<EntityGraph::Edge> edges;
+  // Two stars joined by one bridge edge.
+  const auto hubA = g.intern("hubA"), hubB = g.intern("hubB");
+  for (int i = 0; i < 20; ++i) {
+    edges.push_back({hubA, g.intern("a" + std::to_string(i)), 1, rel});
+    edges.push_back({hubB, g.intern("b" + std::to_string(i)), 1, rel});
+  }
+  edges.push_back({g.find("a0"), g.find("b0"), 1, rel});
+  g.build(edges);
+
+  const auto ranked = g.personalizedPageRank({hubA}, 5);
+  REQUIRE(ranked.size() == 5);
+  CHECK(ranked[0].first == hubA);
+  for (const auto& [node, score] : ranked) CHECK(g.entityId(node)[0] != 'b');
+}
@@ -0,0 +1,84 @@
+#include <catch2/catch_all.hpp>
+#include "core/entities/Gazetteer.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using core::entities::Gazetteer;
+using core::entities::GazetteerBuilder;
+using core::entities::GazetteerCategory;
+using core::entities::GazetteerMatch;
+
+static std::vector<std::string> matched(const Gazetteer& g, std::string_view text) {
+  std::vector<GazetteerMatch> ms;
+  g.scan(text, ms);
+  std::vector<std::string> out;
+  for (const auto& m : ms) out.emplace_back(text.substr(m.begin, m.end - m.begin));
+  return out;
+}
+
+TEST_CASE("Gazetteer finds overlapping terms on token boundaries in one pass") {
+  GazetteerBuilder b;
+  b.addLines("# comment\nNew York\nYork\nNew York City\n\n  Hamburg \r\n", GazetteerCategory::Place);
+  b.add("Bank", GazetteerCategory::Org);
+  b.add("Bank of New York", GazetteerCategory::Org);
+  Gazetteer g;
+  REQUIRE(g.loadImage(b.compile()));
+
+  CHECK(matched(g, "the Bank of New York City branch") ==
+        std::vector<std::string>{"Bank", "Bank of New York", "New York", "York", "New York City"});
+  CHECK(matched(g, "Yorkshire Banking Hamburger").empty());
+  CHECK(matched(g, "(Hamburg)") == std::vector<std::string>{"Hamburg"});
+
+  GazetteerCategory c;
+  REQUIRE(g.classify("Bank of New York", c));
+  CHECK(c == GazetteerCategory::Org);
+  REQUIRE(g.classify("York", c));
+  CHECK(c == GazetteerCategory::Place);
+  CHECK_FALSE(g.classify("Bankside", c));
+  CHECK_FALSE(g.classify("Bank Holiday", c)); // org terms only count as the last token
+  CHECK_FALSE(g.classify("Hamburg Smith", c)); // place terms only as the whole name
+  CHECK_FALSE(g.classify("Anna York", c));
+
+  CHECK_FALSE(g.loadImage("not an image"));
+  CHECK(matched(g, "Hamburg") == std::vector<std::string>{"Hamburg"});
+
+  // The last output belongs to the deepest node; one longer than its path would start
+  // matches before the text.
+  std::string corrupt = b.compile();
+  const std::uint32_t tooLong = 64;
+  std::memcpy(corrupt.data() + corrupt.size() - 2 * sizeof(std::uint32_t), &tooLong, sizeof tooLong);
+  CHECK_FALSE(g.loadImage(corrupt));
+  CHECK(matched(g, "Hamburg") == std::vector<std::string>{"Hamburg"});
+}
+
+TEST_CASE("Gazetteer compiles text dictionaries into a mapped image and recompiles when stale") {
+  namespace fs = std::filesystem;
+  const fs::path dir = fs::temp_directory_path() / "nova_gazetteer_test";
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  std::ofstream(dir / "org_test.txt") << "Initech\n";
+  std::ofstream(dir / "places_test.txt") << "Springfield\n";
+  std::ofstream(dir / "notes.txt") << "Ignored\n";
+  const std::string image = (dir / "gazetteer.bin").string();
+
+  REQUIRE(Gazetteer::compileIfStale(dir.string(), image));
+  Gazetteer g;
+  REQUIRE(g.loadFile(image));
+  CHECK(g.stamp() == Gazetteer::dictionaryStamp(dir.string()));
+  GazetteerCategory c;
+  REQUIRE(g.classify("Springfield Initech", c));
+  CHECK(c == GazetteerCategory::Org);
+  REQUIRE(g.classify("Springfield", c));
+  CHECK(c == GazetteerCategory::Place);
+  CHECK(g.classify("Berlin", c)); // built-ins are always included
+  CHECK_FALSE(g.classify("Ignored", c));
+
+  std::ofstream(dir / "places_test.txt", std::ios::app) << "Shelbyville\n";
+  REQUIRE(Gazetteer::compileIfStale(dir.string(), image));
+  Gazetteer updated;
+  REQUIRE(updated.loadFile(image));
+  CHECK(updated.classify("Shelbyville", c));
+
+  fs::remove_all(dir);
+}
@@ -0,0 +1,161 @@
+#include <catch2/catch_all.hpp>
+#include "core/extract/HtmlExtractor.h"
+
+using core::extract::ColumnType;
+
+TEST_CASE("HtmlExtractor expands table spans and types columns") {
+  core::extract::HtmlExtractor ex;
+  auto ep = ex.extract(
+    "<table><caption>Cities</caption>"
+    "<thead><tr><th rowspan=2>City</th><th colspan=2>Population</th></tr>"
+    "<tr><th>2000</th><th>2020</th></tr></thead>"
+    "<tbody><tr><td rowspan=2>Berlin</td><td>3,382,169</td><td>3.6e6</td></tr>"
+    "<tr><td>12</td><td>-2.5</td></tr></tbody></table>",
+    "https://example.com/");
+
+  REQUIRE(ep.tables.size() == 1);
+  const auto& t = ep.tables[0];
+  REQUIRE(t.caption == "Cities");
+  REQUIRE(t.rows == 2);
+  REQUIRE(t.columns.size() == 3);
+  REQUIRE(t.columns[0].name == "City");
+  REQUIRE(t.columns[1].name == "Population / 2000");
+  REQUIRE(t.value(0, 1) == "Berlin");
+  REQUIRE(t.columns[1].type == ColumnType::Integer);
+  REQUIRE(t.columns[2].type == ColumnType::Number);
+
+  std::string json;
+  core::extract::TableExtractor::appendJson(t, json);
+  REQUIRE(json.find("\"values\": [3382169,12]") != std::string::npos);
+}
+
+TEST_CASE("HtmlExtractor collects JSON-LD and microdata entities") {
+  core::extract::HtmlExtractor ex;
+  auto ep = ex.extract(
+    "<html><head><script type=\"application/ld+json\">"
+    "{\"@context\":\"https://schema.org\",\"@graph\":["
+    "{\"@type\":\"NewsArticle\",\"headline\":\"Big News\","
+    "\"author\":{\"@type\":\"Person\",\"name\":\"Jane Roe\"}}]}"
+    "</script></head><body>"
+    "<div itemscope itemtype=\"https://schema.org/Organization\">"
+    "<span itemprop=\"name\">Acme Corp</span>"
+    "<a itemprop=\"url\" href=\"https://acme.example/\">home</a></div>"
+    "</body></html>",
+    "https://example.com/");
+
+  using core::extract::StructuredKind;
+  REQUIRE(ep.structured.size() == 3);
+  REQUIRE(ep.structured[0].kind == StructuredKind::Person);
+  REQUIRE(ep.structured[0].name == "Jane Roe");
+  REQUIRE(ep.structured[1].kind == StructuredKind::Article);
+  REQUIRE(ep.structured[1].name == "Big News");
+  REQUIRE(ep.structured[2].kind == StructuredKind::Organization);
+  REQUIRE(ep.structured[2].name == "Acme Corp");
+  REQUIRE(ep.structured[2].url == "https://acme.example/");
+  REQUIRE(ep.structured[2].source == "microdata");
+}
+
+TEST_CASE("HtmlExtractor builds a heading outline with source ranges") {
+  const std::string para = "<p>This paragraph is comfortably longer than forty characters.</p>";
+  const std::string html =
+    "<html><body><h1>Guide</h1>" + para +
+    "<h3>Install</h3>" + para +
+    "<h2>Usage</h2><h1>Appendix</h1></body></html>";
+  core::extract::HtmlExtractor ex;
+  auto ep = ex.extract(html, "https://example.com/");
+
+  REQUIRE(ep.headings.size() == 4);
+  REQUIRE(ep.headings[0].text == "Guide");
+  REQUIRE(ep.headings[1].parent == 0);
+  REQUIRE(ep.headings[2].parent == 0);
+  REQUIRE(ep.headings[3].parent == -1);
+  REQUIRE(ep.headings[0].begin == html.find("<h1>Guide"));
+  REQUIRE(ep.headings[0].end == html.find("<h1>Appendix"));
+  REQUIRE(ep.headings[1].end == html.find("<h2>"));
+  REQUIRE(ep.headings[3].end == html.size());
+
+  REQUIRE(ep.blocks.size() == 2);
+  for (const auto& b : ep.blocks) {
+    REQUIRE(html.compare(b.begin, 3, "<p>") == 0);
+    REQUIRE(html.compare(b.end - 4, 4, "</p>") == 0);
+  }
+  auto path = core::extract::headingPath(ep, 1);
+  REQUIRE(path == std::vector<std::string>{"Guide", "Install"});
+}
+
+TEST_CASE("HtmlExtractor resolves and dedupes links") {
+  core::extract::HtmlExtractor ex;
+  auto ep = ex.extract(
+    "<html><head><base href=\"/blog/\"></head><body>"
+    "<a href=\"post-1\"><img src=x></a>"
+    "<a href=\"post-1\">First post</a>"
+    "<a href=\"https://example.com/blog/post-1?utm_medium=rss\">again</a>"
+    "<a href=\"#comments\">comments</a>"
+    "<a href=\"https://other.org/\" rel=\"nofollow\">Other</a>"
+    "</body></html>",
+    "https://example.com/index.html");
+
+  REQUIRE(ep.links.size() == 2);
+  REQUIRE(ep.links[0].href == "https://example.com/blog/post-1");
+  REQUIRE(ep.links[0].text == "First post");
+  REQUIRE(ep.links[1].href == "https://other.org/");
+  REQUIRE(ep.links[1].rel == "nofollow");
+}
+
+TEST_CASE("HtmlExtractor block ids follow content, not rank") {
+  const std::string a = "<p>Alpha paragraph that is comfortably longer than forty characters.</p>";
+  const std::string b = "<p>Beta paragraph, which is a little longer than the alpha paragraph above it.</p>";
+  core::extract::HtmlExtractor ex;
+  auto before = ex.extract("<body>" + a + b + "</body>", "https://example.com/");
+  auto after = ex.extract("<body><p>A new and much longer lead paragraph pushes every other block down the ranking.</p>"
+                          + b + a + a + "</body>", "https://example.com/");
+
+  auto idOf = [](const core::extract::ExtractedPage& ep, const std::string& prefix) {
+    for (const auto& blk : ep.blocks) if (blk.text.rfind(prefix, 0) == 0) return blk.id;
+    return std::string();
+  };
+  REQUIRE(idOf(before, "Alpha") == idOf(after, "Alpha"));
+  REQUIRE(idOf(before, "Beta") == idOf(after, "Beta"));
+  REQUIRE(idOf(before, "Alpha").size() == std::string("block_").size() + 12);
+
+  // The repeated paragraph keeps its id once and gets a suffix the second time.
+  int plain = 0, suffixed = 0;
+  for (const auto& blk : after.blocks) {
+    if (blk.id == idOf(before, "Alpha")) ++plain;
+    if (blk.id == idOf(before, "Alpha") + "-2") ++suffixed;
+  }
+  REQUIRE(plain == 1);
+  REQUIRE(suffixed == 1);
+  REQUIRE(core::extract::HtmlExtractor::blockHash("Hello   World") == core::extract::HtmlExtractor::blockHash(" hello world"));
+}
+
+TEST_CASE("ParsedDocument flattens the tree into document-order subtree ranges") {
+  const std::string html =
+    "<html><body><div class=\"result  card\" id=r1><a href=\"/x\">One <b>two</b></a></div>"
+    "<div class=results><p>three</p></div></body></html>";
+  core::extract::ParsedDocument doc(html);
+  using NodeId = core::extract::ParsedDocument::NodeId;
+
+  std::vector<NodeId> divs;
+  for (NodeId i = 0; i < doc.size(); ++i) {
+    if (doc.is(i, GUMBO_TAG_DIV)) divs.push_back(i);
+  }
+  REQUIRE(divs.size() == 2);
+  REQUIRE(doc.subtreeEnd(divs[0]) == divs[1]);
+  REQUIRE(doc.nextSibling(divs[0]) == divs[1]);
+  REQUIRE(doc.parent(divs[0]) == doc.parent(divs[1]));
+  REQUIRE(doc.attr(divs[0], "id") == "r1");
+  REQUIRE(doc.hasAttr(divs[0], "class"));
+  REQUIRE_FALSE(doc.hasAttr(divs[1], "id"));
+
+  const auto result = doc.classId("result");
+  REQUIRE(doc.hasClass(divs[0], result));
+  REQUIRE(doc.hasClass(divs[0], "card"));
+  REQUIRE_FALSE(doc.hasClass(divs[1], result)); // tokens, not substrings
+  REQUIRE(doc.classId("missing") == core::extract::ParsedDocument::kNone);
+
+  const NodeId a = doc.firstChild(divs[0]);
+  REQUIRE(doc.is(a, GUMBO_TAG_A));
+  REQUIRE(doc.textContent(a) == "One two ");
+  REQUIRE(html.substr(doc.sourceBegin(a), doc.sourceEnd(a) - doc.sourceBegin(a)) == "<a href=\"/x\">One <b>two</b></a>");
+}
@@ -0,0 +1,88 @@
+#include <catch2/catch_all.hpp>
+#include "services/deepsearch/ProfileSearch.h"
+#include "core/storage/Migrations.h"
+#include "core/storage/SqliteDb.h"
+#include "util/Utf8.h"
+
+using core::storage::SqliteDb;
+using services::deepsearch::ProfileSearch;
+
+static void addEntity(SqliteDb& db, const std::string& id, const std::string& name, const std::string& aliases = "[]") {
+  REQUIRE(db.execParams("INSERT INTO entity_index(entity_id,name,type,aliases,ts) VALUES(?,?,'person',?,0);",
+                        {id, name, aliases}));
+}
+
+static std::vector<std::string> ids(SqliteDb& db, std::string_view query, std::size_t limit = 10) {
+  std::vector<std::string> out;
+  for (const auto& m : ProfileSearch(db).search(query, limit)) out.push_back(m.entityId);
+  return out;
+}
+
+TEST_CASE("util::utf8::toLower folds non-ASCII capitals like the trigram tokenizer") {
+  CHECK(util::utf8::toLower("ŁUKASZ Ωmega ÄÖÜ Ǆ") == "łukasz ωmega äöü ǆ");
+  CHECK(util::utf8::toLower("İ") == "İ"); // maps to two code points; left alone
+  CHECK(util::utf8::toLower(std::string("a\xFF" "B")) == std::string("a\xFF" "b"));
+}
+
+TEST_CASE("ProfileSearch ranks exact, then prefix, then substring, then fuzzy matches") {
+  SqliteDb db;
+  REQUIRE(db.open(":memory:"));
+  REQUIRE(core::storage::runMigrations(db));
+  addEntity(db, "fuzzy", "Angela Merkle");
+  addEntity(db, "sub", "Dr. Angela Merkel");
+  addEntity(db, "prefix", "Angela Merkel-Sauer");
+  addEntity(db, "exact", "Angela Merkel");
+  addEntity(db, "alias", "Kasner", R"(["Angela Merkel"])");
+  addEntity(db, "other", "Olaf Scholz");
+
+  CHECK(ids(db, "angela merkel") == std::vector<std::string>{"exact", "alias", "prefix", "sub", "fuzzy"});
+  CHECK(ids(db, "  ANGELA MERKEL ", 1) == std::vector<std::string>{"exact"});
+  CHECK(ids(db, "Angla Merkl").front() == "fuzzy"); // 7 of 13 trigrams shared, "exact" has 6 of 14
+  CHECK(ids(db, "zzzz").empty());
+  CHECK(ids(db, "Ol") == std::vector<std::string>{"other"}); // below three characters: name prefix
+}
+
+TEST_CASE("ProfileSearch matches non-ASCII names in the exact and prefix tiers") {
+  SqliteDb db;
+  REQUIRE(db.open(":memory:"));
+  REQUIRE(core::storage::runMigrations(db));
+  addEntity(db, "lukasz", "Łukasz Nowak");
+  addEntity(db, "omega", "Ωmega Corp");
+  addEntity(db, "lukas", "Lukas Nowak");
+
+  const auto hits = ProfileSearch(db).search("łukasz NOWAK", 10);
+  REQUIRE(!hits.empty());
+  CHECK(hits.front().entityId == "lukasz");
+  CHECK(hits.front().score == 1.0);
+  CHECK(ProfileSearch(db).search("ωmega", 10).front().score == 0.9);
+}
+
+TEST_CASE("ProfileSearch only scores fuzzy candidates sharing enough trigrams") {
+  CHECK(ProfileSearch::trigrams("łukas") == std::vector<std::string>{"kas", "uka", "łuk"});
+  const auto q = ProfileSearch::trigrams("merkel");
+  CHECK(ProfileSearch::matchScore("merkel", q, "merkel") == 1.0);
+  CHECK(ProfileSearch::matchScore("merkel", q, "merkel group") == 0.9);
+  CHECK(ProfileSearch::matchScore("merkel", q, "angela merkel") == 0.8);
+  CHECK(ProfileSearch::matchScore("merkel", q, "merkle") == Catch::Approx(0.7 * 2 / 6));
+  CHECK(ProfileSearch::matchScore("merkel", q, "markus") == 0.0);
+
+  SqliteDb db;
+  REQUIRE(db.open(":memory:"));
+  REQUIRE(core::storage::runMigrations(db));
+  // Each shares one trigram ("ang") with the query: posting-list hits, but never scored.
+  for (int i = 0; i < 50; ++i) addEntity(db, "noise" + std::to_string(i), "Tang Dynasty " + std::to_string(i));
+  addEntity(db, "close", "Angelina Merkel");
+  CHECK(ids(db, "Angela Merkel") == std::vector<std::string>{"close"});
+}
+
+TEST_CASE("ProfileSearch reads the rarest trigram postings within a budget") {
+  SqliteDb db;
+  REQUIRE(db.open(":memory:"));
+  REQUIRE(core::storage::runMigrations(db));
+  // "ang" alone has more postings than the fuzzy tier reads in one search.
+  REQUIRE(db.exec("WITH RECURSIVE n(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM n WHERE x < 25000) "
+                  "INSERT INTO entity_index(entity_id,name,type,aliases,ts) "
+                  "SELECT 'noise' || x, 'Tang ' || x, 'org', '[]', 0 FROM n;"));
+  addEntity(db, "close", "Angelina Merkel");
+  CHECK(ids(db, "Angela Merkel") == std::vector<std::string>{"close"});
+}
@@ -0,0 +1,61 @@
+#include <catch2/catch_all.hpp>
+#include "core/extract/Selector.h"
+
+using core::extract::ParsedDocument;
+using core::extract::SelectorSet;
+
+static std::vector<std::string> texts(const ParsedDocument& doc, const std::vector<ParsedDocument::NodeId>& nodes) {
+  std::vector<std::string> out;
+  for (auto n : nodes) {
+    std::string t = doc.textContent(n);
+    while (!t.empty() && t.back() == ' ') t.pop_back();
+    out.push_back(t);
+  }
+  return out;
+}
+
+TEST_CASE("SelectorSet matches compound selectors and combinators in one pass") {
+  ParsedDocument doc(
+    "<div id=main class=\"product card\">"
+    "<h2 class=title>Lamp</h2><span class=price data-cur=EUR>12</span><span class=note>new</span>"
+    "<ul><li><a href=\"/a\" rel=\"nofollow noopener\">A</a></li><li><a href=\"https://x.example/b\">B</a></li></ul>"
+    "</div>"
+    "<div class=card><span class=price>99</span></div>");
+
+  SelectorSet set;
+  std::string err;
+  const int price = set.add(".product .price", &err);
+  const int sibling = set.add("h2 + span, h2 ~ .note", &err);
+  const int attrs = set.add("a[href^='/'], a[rel~=noopener], [data-cur|=EUR]", &err);
+  const int child = set.add("#main > ul > li:not(x)", &err);
+  REQUIRE(price == 0);
+  REQUIRE(sibling == 1);
+  REQUIRE(attrs == 2);
+  REQUIRE(child == -1);
+  REQUIRE(err.find("pseudo-classes") != std::string::npos);
+  REQUIRE(set.add("div#main>ul>li", &err) == 3);
+  REQUIRE(set.add(".nowhere span", &err) == 4);
+
+  auto hits = set.match(doc);
+  REQUIRE(hits.size() == 5);
+  REQUIRE(texts(doc, hits[0]) == std::vector<std::string>{"12"});
+  REQUIRE(texts(doc, hits[1]) == std::vector<std::string>{"12", "new"});
+  REQUIRE(texts(doc, hits[2]) == std::vector<std::string>{"12", "A"}); // document order, no duplicates
+  REQUIRE(texts(doc, hits[3]) == std::vector<std::string>{"A", "B"});
+  REQUIRE(hits[4].empty());
+}
+
+TEST_CASE("SelectorSet rejects malformed selectors without side effects") {
+  SelectorSet set;
+  std::string err;
+  REQUIRE(set.add("p,", &err) == -1);
+  REQUIRE(set.add("[href", &err) == -1);
+  REQUIRE(set.add("nosuchtag", &err) == -1);
+  REQUIRE(set.empty());
+  REQUIRE(set.add("*", &err) == 0);
+
+  ParsedDocument doc("<p>x</p>");
+  auto hits = set.match(doc);
+  REQUIRE(hits.size() == 1);
+  REQUIRE(hits[0].size() >= 3); // html, head, body, p
+}
@@ -0,0 +1,139 @@
+#include <catch2/catch_all.hpp>
+#include "core/storage/Migrations.h"
+#include "core/storage/SqliteDb.h"
+
+using core::storage::BatchStatement;
+using core::storage::Param;
+using core::storage::SqliteDb;
+
+static int countRows(SqliteDb& db, const std::string& sql, std::initializer_list<Param> params = {}) {
+  int n = -1;
+  for (const auto& row : db.query(sql, params)) n = int(row.int64(0));
+  return n;
+}
+
+TEST_CASE("SqliteDb::execBatch writes a document's entity links in one transaction") {
+  SqliteDb db;
+  REQUIRE(db.open(":memory:"));
+  REQUIRE(core::storage::runMigrations(db));
+
+  const BatchStatement doc{"INSERT INTO local_docs(url_or_path,title,ts) VALUES(?,?,0) "
+                           "ON CONFLICT(url_or_path) DO UPDATE SET title=excluded.title;",
+                           {{"https://a.example/", "A"}}};
+  const std::string linkSql = "INSERT INTO entity_links(entity_id,doc_id,confidence,mentions_json) "
+                              "VALUES(?, (SELECT id FROM local_docs WHERE url_or_path = ?), ?, ?);";
+  REQUIRE(db.execBatch({doc, {linkSql, {{"e1", "https://a.example/", "0.9", "[]"}, {"e2", "https://a.example/", "0.5", "[]"}}}}));
+  CHECK(countRows(db, "SELECT COUNT(*) FROM entity_links WHERE entity_id = ?;", {"e1"}) == 1);
+
+  // Same URL again: still one document. A failing row rolls back the whole batch.
+  CHECK_FALSE(db.execBatch({doc, {linkSql, {{"e3", "https://a.example/", "0.7", "[]"}, {"e1", "https://a.example/", "0.9", "[]"}}}}));
+  CHECK(countRows(db, "SELECT COUNT(*) FROM local_docs;") == 1);
+  CHECK(countRows(db, "SELECT COUNT(*) FROM entity_links;") == 2);
+  CHECK(countRows(db, "SELECT COUNT(*) FROM entity_links WHERE entity_id = 'e3';") == 0);
+}
+
+TEST_CASE("Migrations keep the entity trigram index in step with entity_index") {
+  SqliteDb db;
+  REQUIRE(db.open(":memory:"));
+  REQUIRE(core::storage::runMigrations(db));
+
+  const std::string match = "SELECT COUNT(*) FROM entity_fts WHERE entity_fts MATCH ?;";
+  REQUIRE(db.exec("INSERT INTO entity_index(entity_id,name,type,aliases,ts) "
+                  "VALUES('a','Angela Merkel','person','[\"Merkel\"]',1);"));
+  CHECK(countRows(db, match, {"\"merk\""}) == 1);
+  CHECK(countRows(db, match, {"\"gela me\""}) == 1);
+
+  REQUIRE(db.exec("UPDATE entity_index SET name = 'Olaf Scholz', aliases = '[]' WHERE entity_id = 'a';"));
+  CHECK(countRows(db, match, {"\"merk\""}) == 0);
+  CHECK(countRows(db, match, {"\"scholz\""}) == 1);
+
+  REQUIRE(db.exec("DELETE FROM entity_index;"));
+  CHECK(countRows(db, match, {"\"scholz\""}) == 0);
+}
+
+TEST_CASE("SqliteDb reuses cached statements within a bounded cache") {
+  SqliteDb db(2);
+  REQUIRE(db.open(":memory:"));
+  REQUIRE(db.exec("CREATE TABLE t(k TEXT PRIMARY KEY, v TEXT);"));
+
+  const std::string insert = "INSERT INTO t(k,v) VALUES(?,?);";
+  for (int i = 0; i < 5; ++i) REQUIRE(db.execParams(insert, {"k" + std::to_string(i), std::to_string(i * i)}));
+  CHECK(db.cachedStatementCount() == 1);
+  CHECK_FALSE(db.execParams(insert, {"k1", "dup"})); // a failed step leaves the statement reusable
+  CHECK(db.execParams(insert, {"k5", "25"}));
+
+  CHECK(countRows(db, "SELECT v FROM t WHERE k = ?;", {"k3"}) == 9);
+  CHECK(countRows(db, "SELECT v FROM t WHERE k = ?;", {"k4"}) == 16);
+  CHECK(countRows(db, "SELECT COUNT(*) FROM t;") == 6);
+  CHECK(db.cachedStatementCount() == 2); // the insert was evicted
+
+  // Bindings do not leak into the next use of a cached statement.
+  REQUIRE(db.execParams("INSERT INTO t(k,v) VALUES(?,?);", {"k6"}));
+  CHECK(countRows(db, "SELECT COUNT(*) FROM t WHERE k = 'k6' AND v IS NULL;") == 1);
+}
+
+TEST_CASE("SqliteDb binds and reads typed values") {
+  SqliteDb db;
+  REQUIRE(db.open(":memory:"));
+  REQUIRE(db.exec("CREATE TABLE t(i INTEGER, r REAL, s TEXT, b BLOB);"));
+
+  const std::int64_t big = std::int64_t(1) << 53;
+  const std::string text("caf\xC3\xA9 \0 tail", 12);
+  const std::byte bytes[] = {std::byte{0}, std::byte{0xFF}, std::byte{7}};
+  REQUIRE(db.execParams("INSERT INTO t VALUES(?,?,?,?);", {big, 2.5, text, Param::blob(bytes)}));
+  REQUIRE(db.execParams("INSERT INTO t VALUES(?,?,?,?);", {7, nullptr, std::string_view("x"), Param()}));
+
+  int rows = 0;
+  for (const auto& row : db.query("SELECT i, r, s, b FROM t WHERE i > ? ORDER BY i DESC;", {std::to_string(0)})) {
+    CHECK(row.columnCount() == 4);
+    CHECK(row.columnName(0) == "i");
+    if (rows++ == 0) {
+      CHECK(row.int64(0) == big);
+      CHECK(row.real(1) == 2.5);
+      CHECK(row.text(2) == text); // embedded NUL survives
+      CHECK(row.blob(3).size() == 3);
+      CHECK(row.blob(3)[1] == std::byte{0xFF});
+    } else {
+      CHECK(row.int64(0) == 7);
+      CHECK(row.isNull(1));
+      CHECK(row.text(2) == "x");
+      CHECK(row.isNull(3));
+      CHECK(row.blob(3).empty());
+    }
+  }
+  CHECK(rows == 2);
+
+  auto bad = db.query("SELECT nope FROM t;");
+  CHECK_FALSE(bad.ok());
+  CHECK(bad.begin() == bad.end());
+}
+
+TEST_CASE("SqliteDb allows nested use of a statement that is being stepped") {
+  SqliteDb db(1);
+  REQUIRE(db.open(":memory:"));
+  REQUIRE(db.exec("CREATE TABLE t(k INTEGER); INSERT INTO t VALUES(1),(2),(3);"));
+
+  const std::string sql = "SELECT k FROM t WHERE k >= ? ORDER BY k;";
+  std::int64_t pairs = 0;
+  for (const auto& outer : db.query(sql, {1})) {
+    for (const auto& inner : db.query(sql, {outer.int64(0)})) pairs += inner.int64(0) >= outer.int64(0);
+    CHECK(db.execParams("INSERT INTO t SELECT 0 WHERE 0;")); // would evict the outer statement
+  }
+  CHECK(pairs == 6);
+  CHECK(db.cachedStatementCount() == 2); // over budget while the outer query was busy
+}
+
+TEST_CASE("SqliteDb returns a cached statement whose SQL has trailing text") {
+  SqliteDb db(4);
+  REQUIRE(db.open(":memory:"));
+  REQUIRE(db.exec("CREATE TABLE t(k INTEGER);"));
+
+  // sqlite3_sql() stops at the ';', so the statement cannot be found again by its text.
+  const std::string insert = "INSERT INTO t VALUES(?);\n";
+  for (int i = 0; i < 3; ++i) REQUIRE(db.execParams(insert, {i}));
+  const std::string select = "SELECT COUNT(*) FROM t WHERE k >= ?;  ";
+  CHECK(countRows(db, select, {1}) == 2);
+  CHECK(countRows(db, select, {0}) == 3);
+  CHECK(db.cachedStatementCount() == 2);
+  db.close();
+}
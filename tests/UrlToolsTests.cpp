@@ -1,6 +1,7 @@
 \
 /* tests/UrlToolsTests.cpp */
 #include <catch2/catch_all.hpp>
+#include "core/net/LinkResolver.h"
 #include "core/net/UrlTools.h"
 
 TEST_CASE("stripTracking removes utm params") {
@@ -10,3 +11,13 @@ TEST_CASE("stripTracking removes utm params") {
   REQUIRE(out.toString().toStdString().find("gclid") == std::string::npos);
   REQUIRE(out.toString().toStdString().find("x=1") != std::string::npos);
 }
+
+TEST_CASE("LinkResolver resolves and normalizes hrefs") {
+  core::net::LinkResolver r(QUrl("https://Example.com/docs/guide/index.html"));
+  REQUIRE(r.resolve("../api/?utm_source=x#top") == "https://example.com/docs/api/");
+  REQUIRE(r.resolve("HTTP://Other.org:80") == "http://other.org/");
+  REQUIRE(r.resolve("//cdn.example.com/a?b=1&fbclid=2") == "https://cdn.example.com/a?b=1");
+  REQUIRE(r.resolve("#section").empty());
+  REQUIRE(r.resolve(" javascript:void(0)").empty());
+  REQUIRE(r.resolve("mailto:a@b.c").empty());
+}